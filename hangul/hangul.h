@@ -57,8 +57,14 @@ const ucschar* hangul_syllable_iterator_prev(const ucschar* str,
 					     const ucschar* begin);
 const ucschar* hangul_syllable_iterator_next(const ucschar* str,
 					     const ucschar* end);
+const char* hangul_syllable_iterator_prev_utf8(const char* str,
+					       const char* begin);
+const char* hangul_syllable_iterator_next_utf8(const char* str,
+					       const char* end);
 
 int     hangul_syllable_len(const ucschar* str, int max_len);
+int     hangul_syllable_boundaries(int* dest, int destlen,
+				   const ucschar* src, int srclen);
 
 ucschar hangul_jamo_to_syllable(ucschar choseong,
 				ucschar jungseong,
@@ -69,6 +75,43 @@ void    hangul_syllable_to_jamo(ucschar syllable,
 				ucschar* jongseong);
 int     hangul_jamos_to_syllables(ucschar* dest, int destlen,
 				  const ucschar* src, int srclen);
+int     hangul_jamos_to_syllables_utf8(char* dest, int destlen,
+				       const char* src, int srclen);
+int     hangul_syllables_to_jamos(ucschar* dest, int destlen,
+				  const ucschar* src, int srclen);
+int     hangul_syllables_to_cjamos(ucschar* dest, int destlen,
+				   const ucschar* src, int srclen);
+int     hangul_syllables_to_choseongs(ucschar* dest, int destlen,
+				      const ucschar* src, int srclen);
+int     hangul_syllables_to_choseongs_utf8(char* dest, int destlen,
+					   const char* src, int srclen);
+int     hangul_sort_key(char* dest, int destlen,
+			const ucschar* src, int srclen);
+
+typedef struct _HangulComposer HangulComposer;
+
+HangulComposer* hangul_composer_new(void);
+void    hangul_composer_delete(HangulComposer* composer);
+void    hangul_composer_reset(HangulComposer* composer);
+int     hangul_composer_compose(HangulComposer* composer,
+				ucschar* dest, int destlen,
+				const ucschar* src, int srclen, int* nread);
+int     hangul_composer_flush(HangulComposer* composer,
+			      ucschar* dest, int destlen);
+
+typedef struct _HangulFuzzyMatcher HangulFuzzyMatcher;
+
+HangulFuzzyMatcher* hangul_fuzzy_matcher_new(const ucschar* pattern, int len,
+					     int max_distance);
+HangulFuzzyMatcher* hangul_fuzzy_matcher_new_utf8(const char* pattern, int len,
+						  int max_distance);
+void    hangul_fuzzy_matcher_delete(HangulFuzzyMatcher* matcher);
+int     hangul_fuzzy_matcher_match(HangulFuzzyMatcher* matcher,
+				   const ucschar* str, int len);
+int     hangul_fuzzy_matcher_match_utf8(HangulFuzzyMatcher* matcher,
+					const char* str, int len);
+int     hangul_jamo_distance(const ucschar* a, int alen,
+			     const ucschar* b, int blen);
 
 /* hangulinputcontext.c */
 typedef struct _HangulKeyboard        HangulKeyboard;
@@ -98,7 +141,11 @@ enum {
 /* library */
 #if ENABLE_EXTERNAL_KEYBOARDS
 int hangul_init(const char* user_defined_keyboard_path);
+int hangul_init_with_threads(const char* user_defined_keyboard_path,
+			     unsigned int n_threads);
 int hangul_fini();
+int hangul_keyboard_bundle_compile(const char* keyboard_dir,
+				   const char* bundle_path);
 #endif // ENABLE_EXTERNAL_KEYBOARDS
 
 /* keyboard */
@@ -106,6 +153,9 @@ HangulKeyboard* hangul_keyboard_new(void);
 HangulKeyboard* hangul_keyboard_new_from_file(const char* path);
 void    hangul_keyboard_delete(HangulKeyboard *keyboard);
 void    hangul_keyboard_set_type(HangulKeyboard *keyboard, int type);
+int     hangul_keyboard_map_keys(const HangulKeyboard* keyboard, int tableid,
+				 ucschar* dest, int destlen,
+				 const char* src, int srclen);
 
 unsigned int hangul_keyboard_list_get_count();
 const char* hangul_keyboard_list_get_keyboard_id(unsigned index_);
@@ -122,7 +172,11 @@ bool hangul_combination_set_data(HangulCombination* combination,
 
 /* input context */
 HangulInputContext* hangul_ic_new(const char* keyboard);
+HangulInputContext* hangul_ic_new_with_keyboard(const HangulKeyboard* keyboard);
 void hangul_ic_delete(HangulInputContext *hic);
+HangulInputContext* hangul_ic_pool_acquire(const HangulKeyboard* keyboard);
+void hangul_ic_pool_release(HangulInputContext *hic);
+void hangul_ic_pool_clear(void);
 bool hangul_ic_process(HangulInputContext *hic, int ascii);
 void hangul_ic_reset(HangulInputContext *hic);
 bool hangul_ic_backspace(HangulInputContext *hic);
@@ -143,6 +197,9 @@ void hangul_ic_select_keyboard(HangulInputContext *hic,
 			       const char* id);
 void hangul_ic_connect_callback(HangulInputContext* hic, const char* event,
 				void* callback, void* user_data);
+bool hangul_ic_compile(HangulInputContext *hic);
+int  hangul_romaja_to_syllables(ucschar* dest, int destlen,
+				const char* src, int srclen);
 
 const ucschar* hangul_ic_get_preedit_string(HangulInputContext *hic);
 const ucschar* hangul_ic_get_commit_string(HangulInputContext *hic);
@@ -157,6 +214,9 @@ HanjaTable*  hanja_table_load(const char *filename);
 HanjaList*   hanja_table_match_exact(const HanjaTable* table, const char *key);
 HanjaList*   hanja_table_match_prefix(const HanjaTable* table, const char *key);
 HanjaList*   hanja_table_match_suffix(const HanjaTable* table, const char *key);
+HanjaList*   hanja_table_match_choseong(const HanjaTable* table, const char *key);
+HanjaList*   hanja_table_match_fuzzy(const HanjaTable* table, const char *key,
+				     int max_distance);
 void         hanja_table_delete(HanjaTable *table);
 
 int          hanja_list_get_size(const HanjaList *list);
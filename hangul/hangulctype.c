@@ -21,8 +21,17 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HANGUL_CTYPE_USE_SSE2 1
+#endif
 
 #include "hangul.h"
+#include "hangulinternals.h"
 
 /**
  * @defgroup hangulctype 한글 글자 조작
@@ -56,6 +65,332 @@ static const ucschar jongseong_base = 0x11a7;
 static const int njungseong = 21;
 static const int njongseong = 28;
 
+/* 글자 분류표. BMP를 256 글자씩 나누어 hangul_ctype_index[]에서 페이지
+ * 번호를 찾고, hangul_ctype_pages[]에서 HANGUL_CTYPE_* bit를 읽는다.
+ * 한글과 관계없는 페이지는 모두 0번 페이지를 같이 쓴다.
+ * 음절 페이지는 256 = 28 * 9 + 4 이므로 LV 음절의 위치에 따라 7가지만
+ * 있으면 된다. hangul_ctype()을 참고한다. */
+const unsigned char hangul_ctype_index[256] = {
+     0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  2,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  3,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     4,  5,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  6,  0,  0,  7,  8,  9, 10,
+    11, 12, 13,  7,  8,  9, 10, 11, 12, 13,  7,  8,  9, 10, 11, 12,
+    13,  7,  8,  9, 10, 11, 12, 13,  7,  8,  9, 10, 11, 12, 13,  7,
+     8,  9, 10, 11, 12, 13,  7, 14,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 15,  0
+};
+
+const unsigned char hangul_ctype_pages[][256] = {
+    { /* 0: U+0000 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    { /* 1: U+0300 */
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    { /* 2: U+1100 */
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x21,
+	0x22, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+	0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+	0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+	0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+	0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04
+    },
+    { /* 3: U+1D00 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80
+    },
+    { /* 4: U+3000 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    { /* 5: U+3100 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    { /* 6: U+A900 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    { /* 7: U+AC00 */
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10
+    },
+    { /* 8: U+AD00 */
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+    },
+    { /* 9: U+AE00 */
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+    },
+    { /* 10: U+AF00 */
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+    },
+    { /* 11: U+B000 */
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+    },
+    { /* 12: U+B100 */
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+    },
+    { /* 13: U+B200 */
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+    },
+    { /* 14: U+D700 */
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+	0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00
+    },
+    { /* 15: U+FE00 */
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    }
+};
+
+/* 앞 글자의 분류에 따라 같은 음절로 이어질 수 있는 뒷 글자의 분류.
+ * L, V, T, LV, LVT bit로 찾는다. */
+static const unsigned char hangul_ctype_follow[32] = {
+    [HANGUL_CTYPE_L]   = HANGUL_CTYPE_L | HANGUL_CTYPE_V |
+			 HANGUL_CTYPE_LV | HANGUL_CTYPE_LVT | HANGUL_CTYPE_MARK,
+    [HANGUL_CTYPE_V]   = HANGUL_CTYPE_V | HANGUL_CTYPE_T | HANGUL_CTYPE_MARK,
+    [HANGUL_CTYPE_T]   = HANGUL_CTYPE_T | HANGUL_CTYPE_MARK,
+    [HANGUL_CTYPE_LV]  = HANGUL_CTYPE_V | HANGUL_CTYPE_T | HANGUL_CTYPE_MARK,
+    [HANGUL_CTYPE_LVT] = HANGUL_CTYPE_T | HANGUL_CTYPE_MARK,
+};
+
 /**
  * @ingroup hangulctype
  * @brief 초성인지 확인하는 함수
@@ -68,9 +403,7 @@ static const int njongseong = 28;
 bool
 hangul_is_choseong(ucschar c)
 {
-    return (c >= 0x1100 && c <= 0x115f) ||
-	   (c >= 0xa960 && c <= 0xa97c);
-;
+    return (hangul_ctype(c) & HANGUL_CTYPE_L) != 0;
 }
 
 /**
@@ -85,8 +418,7 @@ hangul_is_choseong(ucschar c)
 bool
 hangul_is_jungseong(ucschar c)
 {
-    return (c >= 0x1160 && c <= 0x11a7) ||
-	   (c >= 0xd7b0 && c <= 0xd7c6);
+    return (hangul_ctype(c) & HANGUL_CTYPE_V) != 0;
 }
 
 /**
@@ -101,17 +433,13 @@ hangul_is_jungseong(ucschar c)
 bool
 hangul_is_jongseong(ucschar c)
 {
-    return (c >= 0x11a8 && c <= 0x11ff) ||
-	   (c >= 0xd7cb && c <= 0xd7fb);
+    return (hangul_ctype(c) & HANGUL_CTYPE_T) != 0;
 }
 
 bool
 hangul_is_combining_mark(ucschar c)
 {
-    return  c == 0x302e || c == 0x302f  ||
-	   (c >= 0x0300 && c <= 0x036F) ||
-	   (c >= 0x1dc0 && c <= 0x1dff) ||
-	   (c >= 0xfe20 && c <= 0xfe2f);
+    return (hangul_ctype(c) & HANGUL_CTYPE_MARK) != 0;
 }
 
 /**
@@ -168,7 +496,7 @@ hangul_is_jamo_conjoinable(ucschar c)
 bool
 hangul_is_syllable(ucschar c)
 {
-    return c >= 0xac00 && c <= 0xd7a3;
+    return (hangul_ctype(c) & (HANGUL_CTYPE_LV | HANGUL_CTYPE_LVT)) != 0;
 }
 
 /**
@@ -183,9 +511,8 @@ hangul_is_syllable(ucschar c)
 bool
 hangul_is_jamo(ucschar c)
 {
-    return hangul_is_choseong(c) ||
-	   hangul_is_jungseong(c) ||
-	   hangul_is_jongseong(c);
+    return (hangul_ctype(c) &
+	    (HANGUL_CTYPE_L | HANGUL_CTYPE_V | HANGUL_CTYPE_T)) != 0;
 }
 
 /**
@@ -199,7 +526,7 @@ hangul_is_jamo(ucschar c)
 bool
 hangul_is_cjamo(ucschar c)
 {
-    return c >= 0x3131 && c <= 0x318e;
+    return (hangul_ctype(c) & HANGUL_CTYPE_CJAMO) != 0;
 }
 
 /**
@@ -601,337 +928,229 @@ hangul_jamo_to_cjamo(ucschar c)
     return ret;
 }
 
+/* 종성에 관한 정보를 모두 모은 목록. 아래의 표는 모두 이 목록에서 만든다.
+ *   P(jong, cho, n, diff1, diff2, djong): 같은 모양의 초성 cho가 있는 종성
+ *   J(jong, cho, n, diff1, diff2, djong): 같은 모양의 초성이 없는 종성
+ * n은 종성을 이루는 자음의 수, diff1, diff2는 종성의 마지막 자음 하나,
+ * 둘에 해당하는 초성이다. (hangul_jongseong_get_diff() 참고)
+ * djong은 겹받침에서 마지막 자음을 떼고 남는 종성으로 현대 한글 종성에만
+ * 있다. (hangul_jongseong_decompose() 참고) */
+#define HANGUL_JONGSEONG_LIST(P, J) \
+    P(0x11a8, 0x1100, 1, 0x1100, 0x1100, 0     ) /* kiyeok                  */ \
+    P(0x11a9, 0x1101, 2, 0x1100, 0x1101, 0x11a8) /* ssangkiyeok             */ \
+    J(0x11aa, 0,      2, 0x1109, 0,      0x11a8) /* kiyeok-sios             */ \
+    P(0x11ab, 0x1102, 1, 0x1102, 0x1102, 0     ) /* nieun                   */ \
+    P(0x11ac, 0x115c, 2, 0x110c, 0x115c, 0x11ab) /* nieun-cieuc             */ \
+    P(0x11ad, 0x115d, 2, 0x1112, 0x115d, 0x11ab) /* nieun-hieuh             */ \
+    P(0x11ae, 0x1103, 1, 0x1103, 0x1103, 0     ) /* tikeut                  */ \
+    P(0x11af, 0x1105, 1, 0x1105, 0x1105, 0     ) /* rieul                   */ \
+    P(0x11b0, 0xa964, 2, 0x1100, 0xa964, 0x11af) /* rieul-kiyeok            */ \
+    P(0x11b1, 0xa968, 2, 0x1106, 0xa968, 0x11af) /* rieul-mieum             */ \
+    P(0x11b2, 0xa969, 2, 0x1107, 0xa969, 0x11af) /* rieul-pieup             */ \
+    P(0x11b3, 0xa96c, 2, 0x1109, 0xa96c, 0x11af) /* rieul-sios              */ \
+    J(0x11b4, 0,      2, 0x1110, 0,      0x11af) /* rieul-thieuth           */ \
+    J(0x11b5, 0,      2, 0x1111, 0,      0x11af) /* rieul-phieuph           */ \
+    P(0x11b6, 0x111a, 2, 0x1112, 0x111a, 0x11af) /* rieul-hieuh             */ \
+    P(0x11b7, 0x1106, 1, 0x1106, 0x1106, 0     ) /* mieum                   */ \
+    P(0x11b8, 0x1107, 1, 0x1107, 0x1107, 0     ) /* pieup                   */ \
+    P(0x11b9, 0x1121, 2, 0x1109, 0x1121, 0x11b8) /* pieup-sios              */ \
+    P(0x11ba, 0x1109, 1, 0x1109, 0x1109, 0     ) /* sios                    */ \
+    P(0x11bb, 0x110a, 2, 0x1109, 0x110a, 0x11ba) /* ssangsios               */ \
+    P(0x11bc, 0x110b, 1, 0x110b, 0x110b, 0     ) /* ieung                   */ \
+    P(0x11bd, 0x110c, 1, 0x110c, 0x110c, 0     ) /* cieuc                   */ \
+    P(0x11be, 0x110e, 1, 0x110e, 0x110e, 0     ) /* chieuch                 */ \
+    P(0x11bf, 0x110f, 1, 0x110f, 0x110f, 0     ) /* khieukh                 */ \
+    P(0x11c0, 0x1110, 1, 0x1110, 0x1110, 0     ) /* thieuth                 */ \
+    P(0x11c1, 0x1111, 1, 0x1111, 0x1111, 0     ) /* phieuph                 */ \
+    P(0x11c2, 0x1112, 1, 0x1112, 0x1112, 0     ) /* hieuh                   */ \
+    J(0x11c3, 0,      2, 0x1105, 0,      0     ) /* kiyeok-rieul            */ \
+    J(0x11c4, 0,      3, 0x1100, 0x112d, 0     ) /* kiyeok-sios-kiyeok      */ \
+    P(0x11c5, 0x1113, 2, 0x1100, 0x1113, 0     ) /* nieun-kiyeok            */ \
+    P(0x11c6, 0x1115, 2, 0x1103, 0x1115, 0     ) /* nieun-tikeut            */ \
+    P(0x11c7, 0x115b, 2, 0x1109, 0x115b, 0     ) /* nieun-sios              */ \
+    J(0x11c8, 0,      2, 0x1140, 0,      0     ) /* nieun-pansios           */ \
+    J(0x11c9, 0,      2, 0x1110, 0,      0     ) /* nieun-thieuth           */ \
+    P(0x11ca, 0x1117, 2, 0x1100, 0x1117, 0     ) /* tikeut-kiyeok           */ \
+    P(0x11cb, 0x115e, 2, 0x1105, 0x115e, 0     ) /* tikeut-rieul            */ \
+    J(0x11cc, 0,      3, 0x1109, 0,      0     ) /* rieul-kiyeok-sios       */ \
+    P(0x11cd, 0x1118, 2, 0x1102, 0x1118, 0     ) /* rieul-nieun             */ \
+    P(0x11ce, 0xa966, 2, 0x1103, 0xa966, 0     ) /* rieul-tikeut            */ \
+    J(0x11cf, 0,      3, 0x1112, 0,      0     ) /* rieul-tikeut-hieuh      */ \
+    P(0x11d0, 0x1119, 2, 0x1105, 0x1119, 0     ) /* ssangrieul              */ \
+    J(0x11d1, 0,      3, 0x1100, 0xa96f, 0     ) /* rieul-mieum-kiyeok      */ \
+    J(0x11d2, 0,      3, 0x1109, 0xa971, 0     ) /* rieul-mieum-sios        */ \
+    J(0x11d3, 0,      3, 0x1109, 0x1121, 0     ) /* rieul-pieup-sios        */ \
+    J(0x11d4, 0,      3, 0x1112, 0xa974, 0     ) /* rieul-pieup-hieuh       */ \
+    P(0x11d5, 0xa96b, 3, 0x110b, 0x112b, 0     ) /* rieul-kapyeounpieup     */ \
+    J(0x11d6, 0,      3, 0x1109, 0x110a, 0     ) /* rieul-ssangsios         */ \
+    J(0x11d7, 0,      2, 0x1140, 0,      0     ) /* rieul-pansios           */ \
+    P(0x11d8, 0xa96e, 2, 0x110f, 0xa96e, 0     ) /* rieul-khieukh           */ \
+    J(0x11d9, 0,      2, 0x1159, 0,      0     ) /* rieul-yeorinhieuh       */ \
+    P(0x11da, 0xa96f, 2, 0x1100, 0xa96f, 0     ) /* mieum-kiyeok            */ \
+    J(0x11db, 0,      2, 0x1105, 0,      0     ) /* mieum-rieul             */ \
+    P(0x11dc, 0x111c, 2, 0x1107, 0x111c, 0     ) /* mieum-pieup             */ \
+    P(0x11dd, 0xa971, 2, 0x1109, 0xa971, 0     ) /* mieum-sios              */ \
+    J(0x11de, 0,      3, 0x1109, 0x110a, 0     ) /* mieum-ssangsios         */ \
+    J(0x11df, 0,      2, 0x1140, 0,      0     ) /* mieum-pansios           */ \
+    J(0x11e0, 0,      2, 0x110e, 0,      0     ) /* mieum-chieuch           */ \
+    J(0x11e1, 0,      2, 0x1112, 0,      0     ) /* mieum-hieuh             */ \
+    P(0x11e2, 0x111d, 2, 0x110b, 0x111d, 0     ) /* kapyeounmieum           */ \
+    J(0x11e3, 0,      2, 0x1105, 0,      0     ) /* pieup-rieul             */ \
+    P(0x11e4, 0x112a, 2, 0x1111, 0x112a, 0     ) /* pieup-phieuph           */ \
+    P(0x11e5, 0xa974, 2, 0x1112, 0xa974, 0     ) /* pieup-hieuh             */ \
+    P(0x11e6, 0x112b, 2, 0x110b, 0x112b, 0     ) /* kapyeounpieup           */ \
+    P(0x11e7, 0x112d, 2, 0x1100, 0x112d, 0     ) /* sios-kiyeok             */ \
+    P(0x11e8, 0x112f, 2, 0x1103, 0x112f, 0     ) /* sios-tikeut             */ \
+    P(0x11e9, 0x1130, 2, 0x1105, 0x1130, 0     ) /* sios-rieul              */ \
+    P(0x11ea, 0x1132, 2, 0x1107, 0x1132, 0     ) /* sios-pieup              */ \
+    P(0x11eb, 0x1140, 1, 0x1140, 0x1140, 0     ) /* pansios                 */ \
+    P(0x11ec, 0x1141, 2, 0x1100, 0,      0     ) /* ieung-kiyeok            */ \
+    J(0x11ed, 0,      3, 0x1100, 0x1101, 0     ) /* ieung-ssangkiyeok       */ \
+    P(0x11ee, 0x1147, 2, 0x114c, 0,      0     ) /* ssangieung              */ \
+    J(0x11ef, 0,      2, 0x110f, 0,      0     ) /* ieung-khieukh           */ \
+    P(0x11f0, 0x114c, 1, 0x114c, 0x114c, 0     ) /* yesieung                */ \
+    J(0x11f1, 0,      2, 0x1109, 0,      0     ) /* yesieung-sios           */ \
+    J(0x11f2, 0,      2, 0x1140, 0,      0     ) /* yesieung-pansios        */ \
+    P(0x11f3, 0x1156, 2, 0x1107, 0x1156, 0     ) /* phieuph-pieup           */ \
+    P(0x11f4, 0x1157, 2, 0x110b, 0x1157, 0     ) /* kapyeounphieuph         */ \
+    J(0x11f5, 0,      2, 0x1102, 0,      0     ) /* hieuh-nieun             */ \
+    J(0x11f6, 0,      2, 0x1105, 0,      0     ) /* hieuh-rieul             */ \
+    J(0x11f7, 0,      2, 0x1106, 0,      0     ) /* hieuh-mieum             */ \
+    J(0x11f8, 0,      2, 0x1107, 0,      0     ) /* hieuh-pieup             */ \
+    P(0x11f9, 0x1159, 1, 0x1159, 0x1159, 0     ) /* yeorinhieuh             */ \
+    J(0x11fa, 0,      2, 0x1102, 0,      0     ) /* kiyeok-nieun            */ \
+    J(0x11fb, 0,      2, 0x1107, 0,      0     ) /* kiyeok-pieup            */ \
+    J(0x11fc, 0,      2, 0x110e, 0,      0     ) /* kiyeok-chieuch          */ \
+    J(0x11fd, 0,      2, 0x110f, 0,      0     ) /* kiyeok-khieukh          */ \
+    J(0x11fe, 0,      2, 0x1112, 0,      0     ) /* kiyeok-hieuh            */ \
+    P(0x11ff, 0x1114, 2, 0x1102, 0x1114, 0     ) /* ssangnieun              */ \
+    J(0xd7cb, 0,      2, 0x1105, 0,      0     ) /* nieun-rieul             */ \
+    J(0xd7cc, 0,      2, 0x110e, 0,      0     ) /* nieun-chieuch           */ \
+    P(0xd7cd, 0x1104, 2, 0x1103, 0x1104, 0     ) /* ssangtikeut             */ \
+    J(0xd7ce, 0,      3, 0x1107, 0xa961, 0     ) /* ssangtikeut-pieup       */ \
+    P(0xd7cf, 0xa961, 2, 0x1107, 0xa961, 0     ) /* tikeut-pieup            */ \
+    P(0xd7d0, 0xa962, 2, 0x1109, 0xa962, 0     ) /* tikeut-sios             */ \
+    J(0xd7d1, 0,      3, 0x1100, 0x112d, 0     ) /* tikeut-sios-kiyeok      */ \
+    P(0xd7d2, 0xa963, 2, 0x110c, 0xa963, 0     ) /* tikeut-cieuc            */ \
+    J(0xd7d3, 0,      2, 0x110e, 0,      0     ) /* tikeut-chieuch          */ \
+    J(0xd7d4, 0,      2, 0x1110, 0,      0     ) /* tikeut-thieuth          */ \
+    P(0xd7d5, 0xa965, 3, 0x1100, 0x1101, 0     ) /* rieul-ssangkiyeok       */ \
+    J(0xd7d6, 0,      3, 0x1112, 0,      0     ) /* rieul-kiyeok-hieuh      */ \
+    J(0xd7d7, 0,      3, 0x110f, 0xa96e, 0     ) /* ssangrieul-khieukh      */ \
+    J(0xd7d8, 0,      3, 0x1112, 0,      0     ) /* rieul-mieum-hieuh       */ \
+    J(0xd7d9, 0,      3, 0x1103, 0x1120, 0     ) /* rieul-pieup-tikeut      */ \
+    J(0xd7da, 0,      3, 0x1111, 0x112a, 0     ) /* rieul-pieup-phieuph     */ \
+    J(0xd7db, 0,      2, 0x114c, 0,      0     ) /* rieul-yesieung          */ \
+    J(0xd7dc, 0,      3, 0x1112, 0,      0     ) /* rieul-yeorinhieuh-hieuh */ \
+    P(0xd7dd, 0x111b, 2, 0x110b, 0x111b, 0     ) /* kapyeounrieul           */ \
+    J(0xd7de, 0,      2, 0x1102, 0,      0     ) /* mieum-nieun             */ \
+    J(0xd7df, 0,      3, 0x1102, 0x1114, 0     ) /* mieum-ssangnieun        */ \
+    J(0xd7e0, 0,      2, 0x1106, 0,      0     ) /* ssangmieum              */ \
+    J(0xd7e1, 0,      3, 0x1109, 0x1121, 0     ) /* mieum-pieup-sios        */ \
+    J(0xd7e2, 0,      2, 0x110c, 0,      0     ) /* mieum-cieuc             */ \
+    P(0xd7e3, 0x1120, 2, 0x1103, 0x1120, 0     ) /* pieup-tikeut            */ \
+    J(0xd7e4, 0,      3, 0x1111, 0,      0     ) /* pieup-rieul-phieuph     */ \
+    J(0xd7e5, 0,      2, 0x1106, 0,      0     ) /* pieup-mieum             */ \
+    P(0xd7e6, 0x1108, 2, 0x1107, 0x1108, 0     ) /* ssangpieup              */ \
+    P(0xd7e7, 0x1123, 3, 0x1103, 0x112f, 0     ) /* pieup-sios-tikeut       */ \
+    P(0xd7e8, 0x1127, 2, 0x110c, 0x1127, 0     ) /* pieup-cieuc             */ \
+    P(0xd7e9, 0x1128, 2, 0x110e, 0x1128, 0     ) /* pieup-chieuch           */ \
+    P(0xd7ea, 0x1131, 2, 0x1106, 0x1131, 0     ) /* sios-mieum              */ \
+    J(0xd7eb, 0,      3, 0x110b, 0x112b, 0     ) /* sios-kapyeounpieup      */ \
+    J(0xd7ec, 0,      3, 0x1100, 0x112d, 0     ) /* ssangsios-kiyeok        */ \
+    J(0xd7ed, 0,      3, 0x1103, 0x112f, 0     ) /* ssangsios-tikeut        */ \
+    J(0xd7ee, 0,      2, 0x1140, 0,      0     ) /* sios-pansios            */ \
+    P(0xd7ef, 0x1136, 2, 0x110c, 0x1136, 0     ) /* sios-cieuc              */ \
+    P(0xd7f0, 0x1137, 2, 0x110e, 0x1137, 0     ) /* sios-chieuch            */ \
+    P(0xd7f1, 0x1139, 2, 0x1110, 0x1139, 0     ) /* sios-thieuth            */ \
+    P(0xd7f2, 0x113b, 2, 0x1112, 0x113b, 0     ) /* sios-hieuh              */ \
+    J(0xd7f3, 0,      2, 0x1107, 0,      0     ) /* pansios-pieup           */ \
+    J(0xd7f4, 0,      3, 0x110b, 0x112b, 0     ) /* pansios-kapyeounpieup   */ \
+    J(0xd7f5, 0,      2, 0x1106, 0,      0     ) /* yesieung-mieum          */ \
+    J(0xd7f6, 0,      2, 0x1112, 0,      0     ) /* yesieung-hieuh          */ \
+    J(0xd7f7, 0,      2, 0x1107, 0,      0     ) /* cieuc-pieup             */ \
+    J(0xd7f8, 0,      3, 0x1107, 0x1108, 0     ) /* cieuc-ssangpieup        */ \
+    P(0xd7f9, 0x110d, 2, 0x110c, 0x110d, 0     ) /* ssangcieuc              */ \
+    J(0xd7fa, 0,      2, 0x1109, 0,      0     ) /* phieuph-sios            */ \
+    J(0xd7fb, 0,      2, 0x1110, 0,      0     ) /* phieuph-thieuth         */
+
+/* U+11A8-U+11FF, U+D7CB-U+D7FB 종성을 이어붙인 순서값 */
+#define HANGUL_JONGSEONG_INDEX(c) \
+    ((c) >= 0xd7cb ? (c) - 0xd7cb + 0x58 : (c) - 0x11a8)
+#define HANGUL_N_JONGSEONG (0x58 + 0x31)
+
+/* U+1100-U+115E, U+A960-U+A97C 초성을 이어붙인 순서값 */
+#define HANGUL_CHOSEONG_INDEX(c) \
+    ((c) >= 0xa960 ? (c) - 0xa960 + 0x5f : (c) - 0x1100)
+#define HANGUL_N_CHOSEONG (0x5f + 0x1d)
+
+typedef struct _HangulJongseongInfo {
+    unsigned short choseong;
+    unsigned short diff[2];
+    unsigned short djong;
+    unsigned char  ncomponent;
+} HangulJongseongInfo;
+
+#define HANGUL_JONGSEONG_INFO(jong, cho, n, diff1, diff2, djong) \
+    [HANGUL_JONGSEONG_INDEX(jong)] = { cho, { diff1, diff2 }, djong, n },
+#define HANGUL_JONGSEONG_NONE(jong, cho, n, diff1, diff2, djong)
+#define HANGUL_CHOSEONG_JONGSEONG(jong, cho, n, diff1, diff2, djong) \
+    [HANGUL_CHOSEONG_INDEX(cho)] = jong,
+
+static const HangulJongseongInfo hangul_jongseong_info[HANGUL_N_JONGSEONG] = {
+    HANGUL_JONGSEONG_LIST(HANGUL_JONGSEONG_INFO, HANGUL_JONGSEONG_INFO)
+};
+
+static const unsigned short hangul_choseong_jongseong[HANGUL_N_CHOSEONG] = {
+    HANGUL_JONGSEONG_LIST(HANGUL_CHOSEONG_JONGSEONG, HANGUL_JONGSEONG_NONE)
+};
+
+#undef HANGUL_JONGSEONG_INFO
+#undef HANGUL_JONGSEONG_NONE
+#undef HANGUL_CHOSEONG_JONGSEONG
+
+/* 종성이 아니면 NULL을 리턴한다 */
+static inline const HangulJongseongInfo*
+hangul_jongseong_get_info(ucschar c)
+{
+    if (c - 0x11a8 <= 0x11ff - 0x11a8 || c - 0xd7cb <= 0xd7fb - 0xd7cb)
+	return &hangul_jongseong_info[HANGUL_JONGSEONG_INDEX(c)];
+    return NULL;
+}
+
 ucschar
 hangul_choseong_to_jongseong(ucschar c)
 {
-    static const ucschar table[] = {
-	0x11a8,  /* cho kiyeok               -> jong kiyeok               */
-	0x11a9,  /* cho ssangkiyeok          -> jong ssangkiyeok          */
-	0x11ab,  /* cho nieun                -> jong nieun                */
-	0x11ae,  /* cho tikeut               -> jong tikeut               */
-	0xd7cd,  /* cho ssangtikeut          -> jong ssangtikeut          */
-	0x11af,  /* cho rieul                -> jong rieul                */
-	0x11b7,  /* cho mieum                -> jong mieum                */
-	0x11b8,  /* cho pieup                -> jong pieup                */
-	0xd7e6,  /* cho ssangpieup           -> jong ssangpieup           */
-	0x11ba,  /* cho sios                 -> jong sios                 */
-	0x11bb,  /* cho ssangsios            -> jong ssangsios            */
-	0x11bc,  /* cho ieung                -> jong ieung                */
-	0x11bd,  /* cho cieuc                -> jong cieuc                */
-	0xd7f9,  /* cho ssangcieuc           -> jong ssangcieuc           */
-	0x11be,  /* cho chieuch              -> jong chieuch              */
-	0x11bf,  /* cho khieukh              -> jong khieukh              */
-	0x11c0,  /* cho thieuth              -> jong thieuth              */
-	0x11c1,  /* cho phieuph              -> jong phieuph              */
-	0x11c2,  /* cho hieuh                -> jong hieuh                */
-	0x11c5,  /* cho nieun-kiyeok         -> jong nieun-kiyeok         */
-	0x11ff,  /* cho ssangnieun           -> jong ssangnieun           */
-	0x11c6,  /* cho nieun-tikeut         -> jong nieun-tikeut         */
-	0,       /* cho nieun-pieup                                      */
-	0x11ca,  /* cho tikeut-kiyeok        -> jong tikeut-kiyeok        */
-	0x11cd,  /* cho rieul-nieun          -> jong rieul-nieun          */
-	0x11d0,  /* cho ssangrieul           -> jong ssangrieul           */
-	0x11b6,  /* cho rieul-hieuh          -> jong rieul-hieuh          */
-	0xd7dd,  /* cho kapyeounrieul        -> jong kapyeounrieul        */
-	0x11dc,  /* cho mieum-pieup          -> jong mieum-pieup          */
-	0x11e2,  /* cho kapyeounmieum        -> jong kapyeounmieum        */
-	0,       /* cho pieup-kiyeok                                     */
-	0,       /* cho pieup-nieun                                      */
-	0xd7e3,  /* cho pieup-tikeut         -> jong pieup-tikeut         */
-	0x11b9,  /* cho pieup-sios           -> jong pieup-sios           */
-	0,       /* cho pieup-sios-kiyeok                                */
-	0xd7e7,  /* cho pieup-sios-tikeut    -> jong pieup-sios-tikeut    */
-	0,       /* cho pieup-sios-pieup                                 */
-	0,       /* cho pieup-ssangsios                                  */
-	0,       /* cho pieup-sios-cieuc                                 */
-	0xd7e8,  /* cho pieup-cieuc          -> jong pieup-cieuc          */
-	0xd7e9,  /* cho pieup-chieuch        -> jong pieup-chieuch        */
-	0,       /* cho pieup-thieuth                                    */
-	0x11e4,  /* cho pieup-phieuph        -> jong pieup-phieuph        */
-	0x11e6,  /* cho kapyeounpieup        -> jong kapyeounpieup        */
-	0,       /* cho kapyeounssangpieup                               */
-	0x11e7,  /* cho sios-kiyeok          -> jong sios-kiyeok          */
-	0,       /* cho sios-nieun                                       */
-	0x11e8,  /* cho sios-tikeut          -> jong sios-tikeut          */
-	0x11e9,  /* cho sios-rieul           -> jong sios-rieul           */
-	0xd7ea,  /* cho sios-mieum           -> jong sios-mieum           */
-	0x11ea,  /* cho sios-pieup           -> jong sios-pieup           */
-	0,       /* cho sios-pieup-kiyeok                                */
-	0,       /* cho sios-ssangsios                                   */
-	0,       /* cho sios-ieung                                       */
-	0xd7ef,  /* cho sios-cieuc           -> jong sios-cieuc           */
-	0xd7f0,  /* cho sios-chieuch         -> jong sios-chieuch         */
-	0,       /* cho sios-khieukh                                     */
-	0xd7f1,  /* cho sios-thieuth         -> jong sios-thieuth         */
-	0,       /* cho sios-phieuph                                     */
-	0xd7f2,  /* cho sios-hieuh           -> jong sios-hieuh           */
-	0,       /* cho chitueumsios                                     */
-	0,       /* cho chitueumssangsios                                */
-	0,       /* cho ceongchieumsios                                  */
-	0,       /* cho ceongchieumssangsios                             */
-	0x11eb,  /* cho pansios              -> jong pansios              */
-	0x11ec,  /* cho ieung-kiyeok         -> jong ieung-kiyeok         */
-	0,       /* cho ieung-tikeut                                     */
-	0,       /* cho ieung-mieum                                      */
-	0,       /* cho ieung-pieup                                      */
-	0,       /* cho ieung-sios                                       */
-	0,       /* cho ieung-pansios                                    */
-	0x11ee,  /* cho ssangieung           -> jong ssangieung           */
-	0,       /* cho ieung-cieuc                                      */
-	0,       /* cho ieung-chieuch                                    */
-	0,       /* cho ieung-thieuth                                    */
-	0,       /* cho ieung-phieuph                                    */
-	0x11f0,  /* cho yesieung             -> jong yesieung             */
-	0,       /* cho cieuc-ieung                                      */
-	0,       /* cho chitueumcieuc                                    */
-	0,       /* cho chitueumssangcieuc                               */
-	0,       /* cho ceongchieumcieuc                                 */
-	0,       /* cho ceongchieumssangcieuc                            */
-	0,       /* cho chieuch-khieukh                                  */
-	0,       /* cho chieuch-hieuh                                    */
-	0,       /* cho chitueumchieuch                                  */
-	0,       /* cho ceongchieumchieuch                               */
-	0x11f3,  /* cho phieuph-pieup        -> jong phieuph-pieup        */
-	0x11f4,  /* cho kapyeounphieuph      -> jong kapyeounphieuph      */
-	0,       /* cho ssanghieuh                                       */
-	0x11f9,  /* cho yeorinhieuh          -> jong yeorinhieuh          */
-	0,       /* cho kiyeok-tikeut                                    */
-	0x11c7,  /* cho nieun-sios           -> jong nieun-sios           */
-	0x11ac,  /* cho nieun-cieuc          -> jong nieun-cieuc          */
-	0x11ad,  /* cho nieun-hieuh          -> jong nieun-hieuh          */
-	0x11cb,  /* cho tikeut-rieul         -> jong tikeut-rieul         */
-	0,       /* cho filler                                           */
-    };
-
-    static const ucschar table_ext_a[] = {
-	0,       /* cho tikeut-mieum                                     */
-	0xd7cf,  /* cho tikeut-pieup         -> jong tikeut-pieup         */
-	0xd7d0,  /* cho tikeut-sios          -> jong tikeut-sios          */
-	0xd7d2,  /* cho tikeut-cieuc         -> jong tikeut-cieuc         */
-	0x11b0,  /* cho rieul-kiyeok         -> jong rieul-kiyeok         */
-	0xd7d5,  /* cho rieul-ssangkiyeok    -> jong rieul-ssangkiyeok    */
-	0x11ce,  /* cho rieul-tikeut         -> jong rieul-tikeut         */
-	0,       /* cho rieul-ssangtikeut                                */
-	0x11b1,  /* cho rieul-mieum          -> jong rieul-mieum          */
-	0x11b2,  /* cho rieul-pieup          -> jong rieul-pieup          */
-	0,       /* cho rieul-ssangpieup                                 */
-	0x11d5,  /* cho rieul-kapyeounpieup  -> jong rieul-kapyeounpieup  */
-	0x11b3,  /* cho rieul-sios           -> jong rieul-sios           */
-	0,       /* cho rieul-cieuc                                      */
-	0x11d8,  /* cho rieul-khieukh        -> jong rieul-khieukh        */
-	0x11da,  /* cho mieum-kiyeok         -> jong mieum-kiyeok         */
-	0,       /* cho mieum-tikeut                                     */
-	0x11dd,  /* cho mieum-sios           -> jong mieum-sios           */
-	0,       /* cho pieup-sios-thieuth                               */
-	0,       /* cho pieup-khieukh                                    */
-	0x11e5,  /* cho pieup-hieuh          -> jong pieup-hieuh          */
-	0,       /* cho ssangsios-pieup                                  */
-	0,       /* cho ieung-rieul                                      */
-	0,       /* cho ieung-hieuh                                      */
-	0,       /* cho ssangcieuc-hieuh                                 */
-	0,       /* cho ssangthieuth                                     */
-	0,       /* cho phieuph-hieuh                                    */
-	0,       /* cho hieuh-sios                                       */
-	0,       /* cho ssangyeorinhieuh                                 */
-    };
-
-    if (c >= 0x1100 && c <= 0x115e)
-	return table[c - 0x1100];
-    else if (c >= 0xa960 && c <= 0xa97c)
-	return table_ext_a[c - 0xa960];
-
+    if (c - 0x1100 <= 0x115e - 0x1100 || c - 0xa960 <= 0xa97c - 0xa960)
+	return hangul_choseong_jongseong[HANGUL_CHOSEONG_INDEX(c)];
     return 0;
 }
 
 ucschar
 hangul_jongseong_to_choseong(ucschar c)
 {
-    static const ucschar table[] = {
-	0x1100,  /* jong kiyeok               -> cho kiyeok               */
-	0x1101,  /* jong ssangkiyeok          -> cho ssangkiyeok          */
-	0,       /* jong kiyeok-sios                                      */
-	0x1102,  /* jong nieun                -> cho nieun                */
-	0x115c,  /* jong nieun-cieuc          -> cho nieun-cieuc          */
-	0x115d,  /* jong nieun-hieuh          -> cho nieun-hieuh          */
-	0x1103,  /* jong tikeut               -> cho tikeut               */
-	0x1105,  /* jong rieul                -> cho rieul                */
-	0xa964,  /* jong rieul-kiyeok         -> cho rieul-kiyeok         */
-	0xa968,  /* jong rieul-mieum          -> cho rieul-mieum          */
-	0xa969,  /* jong rieul-pieup          -> cho rieul-pieup          */
-	0xa96c,  /* jong rieul-sios           -> cho rieul-sios           */
-	0,       /* jong rieul-thieuth                                    */
-	0,       /* jong rieul-phieuph                                    */
-	0x111a,  /* jong rieul-hieuh          -> cho rieul-hieuh          */
-	0x1106,  /* jong mieum                -> cho mieum                */
-	0x1107,  /* jong pieup                -> cho pieup                */
-	0x1121,  /* jong pieup-sios           -> cho pieup-sios           */
-	0x1109,  /* jong sios                 -> cho sios                 */
-	0x110a,  /* jong ssangsios            -> cho ssangsios            */
-	0x110b,  /* jong ieung                -> cho ieung                */
-	0x110c,  /* jong cieuc                -> cho cieuc                */
-	0x110e,  /* jong chieuch              -> cho chieuch              */
-	0x110f,  /* jong khieukh              -> cho khieukh              */
-	0x1110,  /* jong thieuth              -> cho thieuth              */
-	0x1111,  /* jong phieuph              -> cho phieuph              */
-	0x1112,  /* jong hieuh                -> cho hieuh                */
-	0,       /* jong kiyeok-rieul                                     */
-	0,       /* jong kiyeok-sios-kiyeok                               */
-	0x1113,  /* jong nieun-kiyeok         -> cho nieun-kiyeok         */
-	0x1115,  /* jong nieun-tikeut         -> cho nieun-tikeut         */
-	0x115b,  /* jong nieun-sios           -> cho nieun-sios           */
-	0,       /* jong nieun-pansios                                    */
-	0,       /* jong nieun-thieuth                                    */
-	0x1117,  /* jong tikeut-kiyeok        -> cho tikeut-kiyeok        */
-	0x115e,  /* jong tikeut-rieul         -> cho tikeut-rieul         */
-	0,       /* jong rieul-kiyeok-sios                                */
-	0x1118,  /* jong rieul-nieun          -> cho rieul-nieun          */
-	0xa966,  /* jong rieul-tikeut         -> cho rieul-tikeut         */
-	0,       /* jong rieul-tikeut-hieuh                               */
-	0x1119,  /* jong ssangrieul           -> cho ssangrieul           */
-	0,       /* jong rieul-mieum-kiyeok                               */
-	0,       /* jong rieul-mieum-sios                                 */
-	0,       /* jong rieul-pieup-sios                                 */
-	0,       /* jong rieul-pieup-hieuh                                */
-	0xa96b,  /* jong rieul-kapyeounpieup  -> cho rieul-kapyeounpieup  */
-	0,       /* jong rieul-ssangsios                                  */
-	0,       /* jong rieul-pansios                                    */
-	0xa96e,  /* jong rieul-khieukh        -> cho rieul-khieukh        */
-	0,       /* jong rieul-yeorinhieuh                                */
-	0xa96f,  /* jong mieum-kiyeok         -> cho mieum-kiyeok         */
-	0,       /* jong mieum-rieul                                      */
-	0x111c,  /* jong mieum-pieup          -> cho mieum-pieup          */
-	0xa971,  /* jong mieum-sios           -> cho mieum-sios           */
-	0,       /* jong mieum-ssangsios                                  */
-	0,       /* jong mieum-pansios                                    */
-	0,       /* jong mieum-chieuch                                    */
-	0,       /* jong mieum-hieuh                                      */
-	0x111d,  /* jong kapyeounmieum        -> cho kapyeounmieum        */
-	0,       /* jong pieup-rieul                                      */
-	0x112a,  /* jong pieup-phieuph        -> cho pieup-phieuph        */
-	0xa974,  /* jong pieup-hieuh          -> cho pieup-hieuh          */
-	0x112b,  /* jong kapyeounpieup        -> cho kapyeounpieup        */
-	0x112d,  /* jong sios-kiyeok          -> cho sios-kiyeok          */
-	0x112f,  /* jong sios-tikeut          -> cho sios-tikeut          */
-	0x1130,  /* jong sios-rieul           -> cho sios-rieul           */
-	0x1132,  /* jong sios-pieup           -> cho sios-pieup           */
-	0x1140,  /* jong pansios              -> cho pansios              */
-	0x1141,  /* jong ieung-kiyeok         -> cho ieung-kiyeok         */
-	0,       /* jong ieung-ssangkiyeok                                */
-	0x1147,  /* jong ssangieung           -> cho ssangieung           */
-	0,       /* jong ieung-khieukh                                    */
-	0x114c,  /* jong yesieung             -> cho yesieung             */
-	0,       /* jong yesieung-sios                                    */
-	0,       /* jong yesieung-pansios                                 */
-	0x1156,  /* jong phieuph-pieup        -> cho phieuph-pieup        */
-	0x1157,  /* jong kapyeounphieuph      -> cho kapyeounphieuph      */
-	0,       /* jong hieuh-nieun                                      */
-	0,       /* jong hieuh-rieul                                      */
-	0,       /* jong hieuh-mieum                                      */
-	0,       /* jong hieuh-pieup                                      */
-	0x1159,  /* jong yeorinhieuh          -> cho yeorinhieuh          */
-	0,       /* jong kiyeok-nieun                                     */
-	0,       /* jong kiyeok-pieup                                     */
-	0,       /* jong kiyeok-chieuch                                   */
-	0,       /* jong kiyeok-khieukh                                   */
-	0,       /* jong kiyeok-hieuh                                     */
-	0x1114,  /* jong ssangnieun           -> cho ssangnieun           */
-    };
-
-    static const ucschar table_ext_b[] = {
-	0,       /* jong nieun-rieul                                      */
-	0,       /* jong nieun-chieuch                                    */
-	0x1104,  /* jong ssangtikeut          -> cho ssangtikeut          */
-	0,       /* jong ssangtikeut-pieup                                */
-	0xa961,  /* jong tikeut-pieup         -> cho tikeut-pieup         */
-	0xa962,  /* jong tikeut-sios          -> cho tikeut-sios          */
-	0,       /* jong tikeut-sios-kiyeok                               */
-	0xa963,  /* jong tikeut-cieuc         -> cho tikeut-cieuc         */
-	0,       /* jong tikeut-chieuch                                   */
-	0,       /* jong tikeut-thieuth                                   */
-	0xa965,  /* jong rieul-ssangkiyeok    -> cho rieul-ssangkiyeok    */
-	0,       /* jong rieul-kiyeok-hieuh                               */
-	0,       /* jong ssangrieul-khieukh                               */
-	0,       /* jong rieul-mieum-hieuh                                */
-	0,       /* jong rieul-pieup-tikeut                               */
-	0,       /* jong rieul-pieup-phieuph                              */
-	0,       /* jong rieul-yesieung                                   */
-	0,       /* jong rieul-yeorinhieuh-hieuh                          */
-	0x111b,  /* jong kapyeounrieul        -> cho kapyeounrieul        */
-	0,       /* jong mieum-nieun                                      */
-	0,       /* jong mieum-ssangnieun                                 */
-	0,       /* jong ssangmieum                                       */
-	0,       /* jong mieum-pieup-sios                                 */
-	0,       /* jong mieum-cieuc                                      */
-	0x1120,  /* jong pieup-tikeut         -> cho pieup-tikeut         */
-	0,       /* jong pieup-rieul-phieuph                              */
-	0,       /* jong pieup-mieum                                      */
-	0x1108,  /* jong ssangpieup           -> cho ssangpieup           */
-	0x1123,  /* jong pieup-sios-tikeut    -> cho pieup-sios-tikeut    */
-	0x1127,  /* jong pieup-cieuc          -> cho pieup-cieuc          */
-	0x1128,  /* jong pieup-chieuch        -> cho pieup-chieuch        */
-	0x1131,  /* jong sios-mieum           -> cho sios-mieum           */
-	0,       /* jong sios-kapyeounpieup                               */
-	0,       /* jong ssangsios-kiyeok                                 */
-	0,       /* jong ssangsios-tikeut                                 */
-	0,       /* jong sios-pansios                                     */
-	0x1136,  /* jong sios-cieuc           -> cho sios-cieuc           */
-	0x1137,  /* jong sios-chieuch         -> cho sios-chieuch         */
-	0x1139,  /* jong sios-thieuth         -> cho sios-thieuth         */
-	0x113b,  /* jong sios-hieuh           -> cho sios-hieuh           */
-	0,       /* jong pansios-pieup                                    */
-	0,       /* jong pansios-kapyeounpieup                            */
-	0,       /* jong yesieung-mieum                                   */
-	0,       /* jong yesieung-hieuh                                   */
-	0,       /* jong cieuc-pieup                                      */
-	0,       /* jong cieuc-ssangpieup                                 */
-	0x110d,  /* jong ssangcieuc           -> cho ssangcieuc           */
-	0,       /* jong phieuph-sios                                     */
-	0,       /* jong phieuph-thieuth                                  */
-    };
-
-    if (c >= 0x11a8 && c <= 0x11ff)
-	return table[c - 0x11a8];
-    else if (c >= 0xd7cb && c <= 0xd7fb)
-	return table_ext_b[c - 0xd7cb];
-
-    return 0;
+    const HangulJongseongInfo* info = hangul_jongseong_get_info(c);
+    return info != NULL ? info->choseong : 0;
 }
 
+/* 겹받침 c를 앞쪽 종성 jong과 마지막 자음의 초성 cho로 나눈다.
+ * 홑받침과 옛한글 종성은 나누지 않고 jong은 0, cho는 같은 모양의 초성이
+ * 된다. */
 void
 hangul_jongseong_decompose(ucschar c, ucschar* jong, ucschar* cho)
 {
-    static ucschar table[][2] = {
-    { 0,      0x1100 }, /* jong kiyeok	      = cho  kiyeok               */
-    { 0x11a8, 0x1100 }, /* jong ssangkiyeok   = jong kiyeok + cho kiyeok  */
-    { 0x11a8, 0x1109 }, /* jong kiyeok-sios   = jong kiyeok + cho sios    */
-    { 0,      0x1102 }, /* jong nieun	      = cho  nieun                */
-    { 0x11ab, 0x110c }, /* jong nieun-cieuc   = jong nieun  + cho cieuc   */
-    { 0x11ab, 0x1112 }, /* jong nieun-hieuh   = jong nieun  + cho hieuh   */
-    { 0,      0x1103 }, /* jong tikeut	      = cho  tikeut               */
-    { 0,      0x1105 }, /* jong rieul         = cho  rieul                */
-    { 0x11af, 0x1100 }, /* jong rieul-kiyeok  = jong rieul  + cho kiyeok  */
-    { 0x11af, 0x1106 }, /* jong rieul-mieum   = jong rieul  + cho mieum   */
-    { 0x11af, 0x1107 }, /* jong rieul-pieup   = jong rieul  + cho pieup   */
-    { 0x11af, 0x1109 }, /* jong rieul-sios    = jong rieul  + cho sios    */
-    { 0x11af, 0x1110 }, /* jong rieul-thieuth = jong rieul  + cho thieuth */
-    { 0x11af, 0x1111 }, /* jong rieul-phieuph = jong rieul  + cho phieuph */
-    { 0x11af, 0x1112 }, /* jong rieul-hieuh   = jong rieul  + cho hieuh   */
-    { 0,      0x1106 }, /* jong mieum         = cho  mieum                */
-    { 0,      0x1107 }, /* jong pieup         = cho  pieup                */
-    { 0x11b8, 0x1109 }, /* jong pieup-sios    = jong pieup  + cho sios    */
-    { 0,      0x1109 }, /* jong sios          = cho  sios                 */
-    { 0x11ba, 0x1109 }, /* jong ssangsios     = jong sios   + cho sios    */
-    { 0,      0x110b }, /* jong ieung         = cho  ieung                */
-    { 0,      0x110c }, /* jong cieuc         = cho  cieuc                */
-    { 0,      0x110e }, /* jong chieuch       = cho  chieuch              */
-    { 0,      0x110f }, /* jong khieukh       = cho  khieukh              */
-    { 0,      0x1110 }, /* jong thieuth       = cho  thieuth              */
-    { 0,      0x1111 }, /* jong phieuph       = cho  phieuph              */
-    { 0,      0x1112 }  /* jong hieuh         = cho  hieuh                */
-    };
-
-    *jong = table[c - 0x11a8][0];
-    *cho  = table[c - 0x11a8][1];
+    const HangulJongseongInfo* info = hangul_jongseong_get_info(c);
+
+    if (info == NULL) {
+	*jong = 0;
+	*cho  = 0;
+    } else if (info->djong != 0) {
+	*jong = info->djong;
+	*cho  = info->diff[0];
+    } else {
+	*jong = 0;
+	*cho  = info->choseong;
+    }
 }
 
 void
@@ -940,332 +1159,28 @@ hangul_jongseong_dicompose(ucschar c, ucschar* jong, ucschar* cho)
     hangul_jongseong_decompose(c, jong, cho);
 }
 
-static int
-hangul_jongseong_get_ncomponent(ucschar jong)
-{
-    static const char table[] = {
-	1, /* kiyeok                            */
-	2, /* ssangkiyeok                       */
-	2, /* kiyeok-sios                       */
-	1, /* nieun                             */
-	2, /* nieun-cieuc                       */
-	2, /* nieun-hieuh                       */
-	1, /* tikeut                            */
-	1, /* rieul                             */
-	2, /* rieul-kiyeok                      */
-	2, /* rieul-mieum                       */
-	2, /* rieul-pieup                       */
-	2, /* rieul-sios                        */
-	2, /* rieul-thieuth                     */
-	2, /* rieul-phieuph                     */
-	2, /* rieul-hieuh                       */
-	1, /* mieum                             */
-	1, /* pieup                             */
-	2, /* pieup-sios                        */
-	1, /* sios                              */
-	2, /* ssangsios                         */
-	1, /* ieung                             */
-	1, /* cieuc                             */
-	1, /* chieuch                           */
-	1, /* khieukh                           */
-	1, /* thieuth                           */
-	1, /* phieuph                           */
-	1, /* hieuh                             */
-	2, /* kiyeok-rieul                      */
-	3, /* kiyeok-sios-kiyeok                */
-	2, /* nieun-kiyeok                      */
-	2, /* nieun-tikeut                      */
-	2, /* nieun-sios                        */
-	2, /* nieun-pansios                     */
-	2, /* nieun-thieuth                     */
-	2, /* tikeut-kiyeok                     */
-	2, /* tikeut-rieul                      */
-	3, /* rieul-kiyeok-sios                 */
-	2, /* rieul-nieun                       */
-	2, /* rieul-tikeut                      */
-	3, /* rieul-tikeut-hieuh                */
-	2, /* ssangrieul                        */
-	3, /* rieul-mieum-kiyeok                */
-	3, /* rieul-mieum-sios                  */
-	3, /* rieul-pieup-sios                  */
-	3, /* rieul-pieup-hieuh                 */
-	3, /* rieul-kapyeounpieup               */
-	3, /* rieul-ssangsios                   */
-	2, /* rieul-pansios                     */
-	2, /* rieul-khieukh                     */
-	2, /* rieul-yeorinhieuh                 */
-	2, /* mieum-kiyeok                      */
-	2, /* mieum-rieul                       */
-	2, /* mieum-pieup                       */
-	2, /* mieum-sios                        */
-	3, /* mieum-ssangsios                   */
-	2, /* mieum-pansios                     */
-	2, /* mieum-chieuch                     */
-	2, /* mieum-hieuh                       */
-	2, /* kapyeounmieum                     */
-	2, /* pieup-rieul                       */
-	2, /* pieup-phieuph                     */
-	2, /* pieup-hieuh                       */
-	2, /* kapyeounpieup                     */
-	2, /* sios-kiyeok                       */
-	2, /* sios-tikeut                       */
-	2, /* sios-rieul                        */
-	2, /* sios-pieup                        */
-	1, /* pansios                           */
-	2, /* ieung-kiyeok                      */
-	3, /* ieung-ssangkiyeok                 */
-	2, /* ssangieung                        */
-	2, /* ieung-khieukh                     */
-	1, /* yesieung                          */
-	2, /* yesieung-sios                     */
-	2, /* yesieung-pansios                  */
-	2, /* phieuph-pieup                     */
-	2, /* kapyeounphieuph                   */
-	2, /* hieuh-nieun                       */
-	2, /* hieuh-rieul                       */
-	2, /* hieuh-mieum                       */
-	2, /* hieuh-pieup                       */
-	1, /* yeorinhieuh                       */
-	2, /* kiyeok-nieun                      */
-	2, /* kiyeok-pieup                      */
-	2, /* kiyeok-chieuch                    */
-	2, /* kiyeok-khieukh                    */
-	2, /* kiyeok-hieuh                      */
-	2, /* ssangnieun                        */
-    };
-
-    static const char table_ext_b[] = {
-	2, /* nieun-rieul                       */
-	2, /* nieun-chieuch                     */
-	2, /* ssangtikeut                       */
-	3, /* ssangtikeut-pieup                 */
-	2, /* tikeut-pieup                      */
-	2, /* tikeut-sios                       */
-	3, /* tikeut-sios-kiyeok                */
-	2, /* tikeut-cieuc                      */
-	2, /* tikeut-chieuch                    */
-	2, /* tikeut-thieuth                    */
-	3, /* rieul-ssangkiyeok                 */
-	3, /* rieul-kiyeok-hieuh                */
-	3, /* ssangrieul-khieukh                */
-	3, /* rieul-mieum-hieuh                 */
-	3, /* rieul-pieup-tikeut                */
-	3, /* rieul-pieup-phieuph               */
-	2, /* rieul-yesieung                    */
-	3, /* rieul-yeorinhieuh-hieuh           */
-	2, /* kapyeounrieul                     */
-	2, /* mieum-nieun                       */
-	3, /* mieum-ssangnieun                  */
-	2, /* ssangmieum                        */
-	3, /* mieum-pieup-sios                  */
-	2, /* mieum-cieuc                       */
-	2, /* pieup-tikeut                      */
-	3, /* pieup-rieul-phieuph               */
-	2, /* pieup-mieum                       */
-	2, /* ssangpieup                        */
-	3, /* pieup-sios-tikeut                 */
-	2, /* pieup-cieuc                       */
-	2, /* pieup-chieuch                     */
-	2, /* sios-mieum                        */
-	3, /* sios-kapyeounpieup                */
-	3, /* ssangsios-kiyeok                  */
-	3, /* ssangsios-tikeut                  */
-	2, /* sios-pansios                      */
-	2, /* sios-cieuc                        */
-	2, /* sios-chieuch                      */
-	2, /* sios-thieuth                      */
-	2, /* sios-hieuh                        */
-	2, /* pansios-pieup                     */
-	3, /* pansios-kapyeounpieup             */
-	2, /* yesieung-mieum                    */
-	2, /* yesieung-hieuh                    */
-	2, /* cieuc-pieup                       */
-	3, /* cieuc-ssangpieup                  */
-	2, /* ssangcieuc                        */
-	2, /* phieuph-sios                      */
-	2, /* phieuph-thieuth                   */
-    };
-
-    if (jong >= 0x11a8 && jong <= 0x11ff) {
-	return table[jong - 0x11a8];
-    } else if (jong >= 0xd7cb && jong <= 0xd7fb) {
-	return table_ext_b[jong - 0xd7cb];
-    }
-
-    return 0;
-}
-
 ucschar
 hangul_jongseong_get_diff(ucschar prevjong, ucschar jong)
 {
-    static const ucschar table[][2] = {
-	{ 0x1100, 0x1100 }, /* kiyeok: kiyeok, kiyeok                      */
-	{ 0x1100, 0x1101 }, /* ssangkiyeok: kiyeok, ssangkiyeok            */
-	{ 0x1109, 0      }, /* kiyeok-sios: sios                           */
-	{ 0x1102, 0x1102 }, /* nieun: nieun, nieun                         */
-	{ 0x110c, 0x115c }, /* nieun-cieuc: cieuc, nieun-cieuc             */
-	{ 0x1112, 0x115d }, /* nieun-hieuh: hieuh, nieun-hieuh             */
-	{ 0x1103, 0x1103 }, /* tikeut: tikeut, tikeut                      */
-	{ 0x1105, 0x1105 }, /* rieul: rieul, rieul                         */
-	{ 0x1100, 0xa964 }, /* rieul-kiyeok: kiyeok, rieul-kiyeok          */
-	{ 0x1106, 0xa968 }, /* rieul-mieum: mieum, rieul-mieum             */
-	{ 0x1107, 0xa969 }, /* rieul-pieup: pieup, rieul-pieup             */
-	{ 0x1109, 0xa96c }, /* rieul-sios: sios, rieul-sios                */
-	{ 0x1110, 0      }, /* rieul-thieuth: thieuth                      */
-	{ 0x1111, 0      }, /* rieul-phieuph: phieuph                      */
-	{ 0x1112, 0x111a }, /* rieul-hieuh: hieuh, rieul-hieuh             */
-	{ 0x1106, 0x1106 }, /* mieum: mieum, mieum                         */
-	{ 0x1107, 0x1107 }, /* pieup: pieup, pieup                         */
-	{ 0x1109, 0x1121 }, /* pieup-sios: sios, pieup-sios                */
-	{ 0x1109, 0x1109 }, /* sios: sios, sios                            */
-	{ 0x1109, 0x110a }, /* ssangsios: sios, ssangsios                  */
-	{ 0x110b, 0x110b }, /* ieung: ieung, ieung                         */
-	{ 0x110c, 0x110c }, /* cieuc: cieuc, cieuc                         */
-	{ 0x110e, 0x110e }, /* chieuch: chieuch, chieuch                   */
-	{ 0x110f, 0x110f }, /* khieukh: khieukh, khieukh                   */
-	{ 0x1110, 0x1110 }, /* thieuth: thieuth, thieuth                   */
-	{ 0x1111, 0x1111 }, /* phieuph: phieuph, phieuph                   */
-	{ 0x1112, 0x1112 }, /* hieuh: hieuh, hieuh                         */
-	{ 0x1105, 0      }, /* kiyeok-rieul: rieul                         */
-	{ 0x1100, 0x112d }, /* kiyeok-sios-kiyeok: kiyeok, sios-kiyeok     */
-	{ 0x1100, 0x1113 }, /* nieun-kiyeok: kiyeok, nieun-kiyeok          */
-	{ 0x1103, 0x1115 }, /* nieun-tikeut: tikeut, nieun-tikeut          */
-	{ 0x1109, 0x115b }, /* nieun-sios: sios, nieun-sios                */
-	{ 0x1140, 0      }, /* nieun-pansios: pansios                      */
-	{ 0x1110, 0      }, /* nieun-thieuth: thieuth                      */
-	{ 0x1100, 0x1117 }, /* tikeut-kiyeok: kiyeok, tikeut-kiyeok        */
-	{ 0x1105, 0x115e }, /* tikeut-rieul: rieul, tikeut-rieul           */
-	{ 0x1109, 0      }, /* rieul-kiyeok-sios: sios                     */
-	{ 0x1102, 0x1118 }, /* rieul-nieun: nieun, rieul-nieun             */
-	{ 0x1103, 0xa966 }, /* rieul-tikeut: tikeut, rieul-tikeut          */
-	{ 0x1112, 0      }, /* rieul-tikeut-hieuh: hieuh                   */
-	{ 0x1105, 0x1119 }, /* ssangrieul: rieul, ssangrieul               */
-	{ 0x1100, 0xa96f }, /* rieul-mieum-kiyeok: kiyeok, mieum-kiyeok    */
-	{ 0x1109, 0xa971 }, /* rieul-mieum-sios: sios, mieum-sios          */
-	{ 0x1109, 0x1121 }, /* rieul-pieup-sios: sios, pieup-sios          */
-	{ 0x1112, 0xa974 }, /* rieul-pieup-hieuh: hieuh, pieup-hieuh       */
-	{ 0x110b, 0x112b }, /* rieul-kapyeounpieup: ieung, kapyeounpieup   */
-	{ 0x1109, 0x110a }, /* rieul-ssangsios: sios, ssangsios            */
-	{ 0x1140, 0      }, /* rieul-pansios: pansios                      */
-	{ 0x110f, 0xa96e }, /* rieul-khieukh: khieukh, rieul-khieukh       */
-	{ 0x1159, 0      }, /* rieul-yeorinhieuh: yeorinhieuh              */
-	{ 0x1100, 0xa96f }, /* mieum-kiyeok: kiyeok, mieum-kiyeok          */
-	{ 0x1105, 0      }, /* mieum-rieul: rieul                          */
-	{ 0x1107, 0x111c }, /* mieum-pieup: pieup, mieum-pieup             */
-	{ 0x1109, 0xa971 }, /* mieum-sios: sios, mieum-sios                */
-	{ 0x1109, 0x110a }, /* mieum-ssangsios: sios, ssangsios            */
-	{ 0x1140, 0      }, /* mieum-pansios: pansios                      */
-	{ 0x110e, 0      }, /* mieum-chieuch: chieuch                      */
-	{ 0x1112, 0      }, /* mieum-hieuh: hieuh                          */
-	{ 0x110b, 0x111d }, /* kapyeounmieum: ieung, kapyeounmieum         */
-	{ 0x1105, 0      }, /* pieup-rieul: rieul                          */
-	{ 0x1111, 0x112a }, /* pieup-phieuph: phieuph, pieup-phieuph       */
-	{ 0x1112, 0xa974 }, /* pieup-hieuh: hieuh, pieup-hieuh             */
-	{ 0x110b, 0x112b }, /* kapyeounpieup: ieung, kapyeounpieup         */
-	{ 0x1100, 0x112d }, /* sios-kiyeok: kiyeok, sios-kiyeok            */
-	{ 0x1103, 0x112f }, /* sios-tikeut: tikeut, sios-tikeut            */
-	{ 0x1105, 0x1130 }, /* sios-rieul: rieul, sios-rieul               */
-	{ 0x1107, 0x1132 }, /* sios-pieup: pieup, sios-pieup               */
-	{ 0x1140, 0x1140 }, /* pansios: pansios, pansios                   */
-	{ 0x1100, 0      }, /* yesieung-kiyeok: kiyeok                     */
-	{ 0x1100, 0x1101 }, /* yesieung-ssangkiyeok: kiyeok, ssangkiyeok   */
-	{ 0x114c, 0      }, /* ssangyesieung: yesieung                     */
-	{ 0x110f, 0      }, /* yesieung-khieukh: khieukh                   */
-	{ 0x114c, 0x114c }, /* yesieung: yesieung, yesieung                */
-	{ 0x1109, 0      }, /* yesieung-sios: sios                         */
-	{ 0x1140, 0      }, /* yesieung-pansios: pansios                   */
-	{ 0x1107, 0x1156 }, /* phieuph-pieup: pieup, phieuph-pieup         */
-	{ 0x110b, 0x1157 }, /* kapyeounphieuph: ieung, kapyeounphieuph     */
-	{ 0x1102, 0      }, /* hieuh-nieun: nieun                          */
-	{ 0x1105, 0      }, /* hieuh-rieul: rieul                          */
-	{ 0x1106, 0      }, /* hieuh-mieum: mieum                          */
-	{ 0x1107, 0      }, /* hieuh-pieup: pieup                          */
-	{ 0x1159, 0x1159 }, /* yeorinhieuh: yeorinhieuh, yeorinhieuh       */
-	{ 0x1102, 0      }, /* kiyeok-nieun: nieun                         */
-	{ 0x1107, 0      }, /* kiyeok-pieup: pieup                         */
-	{ 0x110e, 0      }, /* kiyeok-chieuch: chieuch                     */
-	{ 0x110f, 0      }, /* kiyeok-khieukh: khieukh                     */
-	{ 0x1112, 0      }, /* kiyeok-hieuh: hieuh                         */
-	{ 0x1102, 0x1114 }, /* ssangnieun: nieun, ssangnieun               */
-    };
+    const HangulJongseongInfo* info = hangul_jongseong_get_info(jong);
+    const HangulJongseongInfo* prev;
+    int diff;
 
-    static const ucschar table_ext_b[][2] = {
-	{ 0x1105, 0      }, /* nieun-rieul: rieul                          */
-	{ 0x110e, 0      }, /* nieun-chieuch: chieuch                      */
-	{ 0x1103, 0x1104 }, /* ssangtikeut: tikeut, ssangtikeut            */
-	{ 0x1107, 0xa961 }, /* ssangtikeut-pieup: pieup, tikeut-pieup      */
-	{ 0x1107, 0xa961 }, /* tikeut-pieup: pieup, tikeut-pieup           */
-	{ 0x1109, 0xa962 }, /* tikeut-sios: sios, tikeut-sios              */
-	{ 0x1100, 0x112d }, /* tikeut-sios-kiyeok: kiyeok, sios-kiyeok     */
-	{ 0x110c, 0xa963 }, /* tikeut-cieuc: cieuc, tikeut-cieuc           */
-	{ 0x110e, 0      }, /* tikeut-chieuch: chieuch                     */
-	{ 0x1110, 0      }, /* tikeut-thieuth: thieuth                     */
-	{ 0x1100, 0x1101 }, /* rieul-ssangkiyeok: kiyeok, ssangkiyeok      */
-	{ 0x1112, 0      }, /* rieul-kiyeok-hieuh: hieuh                   */
-	{ 0x110f, 0xa96e }, /* ssangrieul-khieukh: khieukh, rieul-khieukh  */
-	{ 0x1112, 0      }, /* rieul-mieum-hieuh: hieuh                    */
-	{ 0x1103, 0x1120 }, /* rieul-pieup-tikeut: tikeut, pieup-tikeut    */
-	{ 0x1111, 0x112a }, /* rieul-pieup-phieuph: phieuph, pieup-phieuph */
-	{ 0x114c, 0      }, /* rieul-yesieung: yesieung                    */
-	{ 0x1112, 0      }, /* rieul-yeorinhieuh-hieuh: hieuh              */
-	{ 0x110b, 0x111b }, /* kapyeounrieul: ieung, kapyeounrieul         */
-	{ 0x1102, 0      }, /* mieum-nieun: nieun                          */
-	{ 0x1102, 0x1114 }, /* mieum-ssangnieun: nieun, ssangnieun         */
-	{ 0x1106, 0      }, /* ssangmieum: mieum                           */
-	{ 0x1109, 0x1121 }, /* mieum-pieup-sios: sios, pieup-sios          */
-	{ 0x110c, 0      }, /* mieum-cieuc: cieuc                          */
-	{ 0x1103, 0x1120 }, /* pieup-tikeut: tikeut, pieup-tikeut          */
-	{ 0x1111, 0      }, /* pieup-rieul-phieuph: phieuph                */
-	{ 0x1106, 0      }, /* pieup-mieum: mieum                          */
-	{ 0x1107, 0x1108 }, /* ssangpieup: pieup, ssangpieup               */
-	{ 0x1103, 0x112f }, /* pieup-sios-tikeut: tikeut, sios-tikeut      */
-	{ 0x110c, 0x1127 }, /* pieup-cieuc: cieuc, pieup-cieuc             */
-	{ 0x110e, 0x1128 }, /* pieup-chieuch: chieuch, pieup-chieuch       */
-	{ 0x1106, 0x1131 }, /* sios-mieum: mieum, sios-mieum               */
-	{ 0x110b, 0x112b }, /* sios-kapyeounpieup: ieung, kapyeounpieup    */
-	{ 0x1100, 0x112d }, /* ssangsios-kiyeok: kiyeok, sios-kiyeok       */
-	{ 0x1103, 0x112f }, /* ssangsios-tikeut: tikeut, sios-tikeut       */
-	{ 0x1140, 0      }, /* sios-pansios: pansios                       */
-	{ 0x110c, 0x1136 }, /* sios-cieuc: cieuc, sios-cieuc               */
-	{ 0x110e, 0x1137 }, /* sios-chieuch: chieuch, sios-chieuch         */
-	{ 0x1110, 0x1139 }, /* sios-thieuth: thieuth, sios-thieuth         */
-	{ 0x1112, 0x113b }, /* sios-hieuh: hieuh, sios-hieuh               */
-	{ 0x1107, 0      }, /* pansios-pieup: pieup                        */
-	{ 0x110b, 0x112b }, /* pansios-kapyeounpieup: ieung, kapyeounpieup */
-	{ 0x1106, 0      }, /* yesieung-mieum: mieum                       */
-	{ 0x1112, 0      }, /* yesieung-hieuh: hieuh                       */
-	{ 0x1107, 0      }, /* cieuc-pieup: pieup                          */
-	{ 0x1107, 0x1108 }, /* cieuc-ssangpieup: pieup, ssangpieup         */
-	{ 0x110c, 0x110d }, /* ssangcieuc: cieuc, ssangcieuc               */
-	{ 0x1109, 0      }, /* phieuph-sios: sios                          */
-	{ 0x1110, 0      }, /* phieuph-thieuth: thieuth                    */
-    };
+    if (info == NULL)
+	return 0;
 
-    ucschar cho = 0;
+    if (prevjong == 0)
+	return info->choseong;
 
-    if (prevjong == 0) {
-	cho = hangul_jongseong_to_choseong(jong);
-    } else {
-	int diff;
-	int n1;
-	int n2;
-
-	n1 = hangul_jongseong_get_ncomponent(prevjong);
-	n2 = hangul_jongseong_get_ncomponent(jong);
-
-	diff = n2 - n1 - 1;
-	if (diff >= 0 && diff < 2) {
-	    if (jong >= 0x11a8 && jong <= 0x11ff) {
-		cho = table[jong - 0x11a8][diff];
-	    } else if (jong >= 0xd7cb && jong <= 0xd7fb) {
-		cho = table_ext_b[jong - 0xd7cb][diff];
-	    }
-	} else if (diff == 2) {
-	    cho = hangul_jongseong_to_choseong(jong);
-	}
+    prev = hangul_jongseong_get_info(prevjong);
+    diff = info->ncomponent - (prev != NULL ? prev->ncomponent : 0) - 1;
+    if (diff >= 0 && diff < 2) {
+	return info->diff[diff];
+    } else if (diff == 2) {
+	return info->choseong;
     }
 
-    return cho;
+    return 0;
 }
 
 /**
@@ -1366,54 +1281,10 @@ hangul_syllable_to_jaso(ucschar syllable,
 static inline bool 
 is_syllable_boundary(ucschar prev, ucschar next)
 {
-    if (hangul_is_choseong(prev)) {
-	if (hangul_is_choseong(next))
-	    return false;
-	if (hangul_is_jungseong(next))
-	    return false;
-	if (hangul_is_syllable(next))
-	    return false;
-	if (hangul_is_combining_mark(next))
-	    return false;
-	if (next == HANGUL_JUNGSEONG_FILLER)
-	    return false;
-    } else if (prev == HANGUL_CHOSEONG_FILLER) {
-	if (hangul_is_jungseong(next))
-	    return false;
-	if (next == HANGUL_JUNGSEONG_FILLER)
-	    return false;
-    } else if (hangul_is_jungseong(prev)) {
-	if (hangul_is_jungseong(next))
-	    return false;
-	if (hangul_is_jongseong(next))
-	    return false;
-	if (hangul_is_combining_mark(next))
-	    return false;
-    } else if (prev == HANGUL_JUNGSEONG_FILLER) {
-	if (hangul_is_jongseong(next))
-	    return false;
-    } else if (hangul_is_jongseong(prev)) {
-	if (hangul_is_jongseong(next))
-	    return false;
-	if (hangul_is_combining_mark(next))
-	    return false;
-    } else if (hangul_is_syllable(prev)) {
-	if ((prev - syllable_base) % njongseong == 0) {
-	    // 종성이 없는 음절: LV
-	    if (hangul_is_jungseong(next))
-		return false;
-	    if (hangul_is_jongseong(next))
-		return false;
-	} else {
-	    // 종성이 있는 음절: LVT
-	    if (hangul_is_jongseong(next))
-		return false;
-	}
-	if (hangul_is_combining_mark(next))
-	    return false;
-    }
-    
-    return true;
+    /* 초성 채움 문자는 초성으로, 중성 채움 문자는 중성으로 분류되므로
+     * 따로 확인하지 않아도 된다. */
+    unsigned follow = hangul_ctype_follow[hangul_ctype(prev) & 0x1f];
+    return (hangul_ctype(next) & follow) == 0;
 }
 
 static inline ucschar
@@ -1515,38 +1386,64 @@ jongseong_compress(ucschar a, ucschar b)
     return 0;
 }
 
-static inline ucschar
-build_syllable(const ucschar* str, size_t len)
+/* 한 음절의 자모를 차례로 받아서 조합한다. 초성, 중성, 종성의 순서로
+ * 조합 가능한 자모만 받을 수 있고, 그렇지 않으면 조합할 수 없는 음절이
+ * 된다. */
+typedef struct _HangulSyllableBuilder {
+    ucschar cho;
+    ucschar jung;
+    ucschar jong;
+    int state;	    /* 0: 초성, 1: 중성, 2: 종성, -1: 조합할 수 없음 */
+} HangulSyllableBuilder;
+
+static inline void
+syllable_builder_init(HangulSyllableBuilder* builder)
 {
-    int i;
-    ucschar cho = 0, jung = 0, jong = 0;
+    builder->cho = 0;
+    builder->jung = 0;
+    builder->jong = 0;
+    builder->state = 0;
+}
 
-    i = 0;
-    while (i < len && hangul_is_choseong_conjoinable(str[i])) {
-	cho = choseong_compress(cho, str[i]);
-	if (cho == 0)
-	    return 0;
-	i++;
+static inline void
+syllable_builder_push(HangulSyllableBuilder* builder, ucschar c)
+{
+    if (builder->state == 0 && hangul_is_choseong_conjoinable(c)) {
+	builder->cho = choseong_compress(builder->cho, c);
+	if (builder->cho == 0)
+	    builder->state = -1;
+    } else if (builder->state >= 0 && builder->state <= 1 &&
+	       hangul_is_jungseong_conjoinable(c)) {
+	builder->jung = jungseong_compress(builder->jung, c);
+	builder->state = builder->jung != 0 ? 1 : -1;
+    } else if (builder->state >= 0 && hangul_is_jongseong_conjoinable(c)) {
+	builder->jong = jongseong_compress(builder->jong, c);
+	builder->state = builder->jong != 0 ? 2 : -1;
+    } else {
+	builder->state = -1;
     }
+}
 
-    while (i < len && hangul_is_jungseong_conjoinable(str[i])) {
-	jung = jungseong_compress(jung, str[i]);
-	if (jung == 0)
-	    return 0;
-	i++;
-    }
+static inline ucschar
+syllable_builder_get(const HangulSyllableBuilder* builder)
+{
+    if (builder->state < 0)
+	return 0;
 
-    while (i < len && hangul_is_jongseong_conjoinable(str[i])) {
-	jong = jongseong_compress(jong, str[i]);
-	if (jong == 0)
-	    return 0;
-	i++;
-    }
+    return hangul_jamo_to_syllable(builder->cho, builder->jung, builder->jong);
+}
 
-    if (i < len)
-	return 0;
+static inline ucschar
+build_syllable(const ucschar* str, size_t len)
+{
+    HangulSyllableBuilder builder;
+    size_t i;
 
-    return hangul_jamo_to_syllable(cho, jung, jong);
+    syllable_builder_init(&builder);
+    for (i = 0; i < len; i++)
+	syllable_builder_push(&builder, str[i]);
+
+    return syllable_builder_get(&builder);
 }
 
 /**
@@ -1656,6 +1553,148 @@ hangul_syllable_iterator_next(const ucschar* iter, const ucschar* end)
     return iter;
 }
 
+/* 현대 한글 자모를 빠르게 조합하기 위해 한번에 분류하는 코드의 수.
+ * 음절은 앞쪽 절반에서만 시작하고, 뒤쪽 절반은 음절의 끝을 확인하는 데에만
+ * 쓴다. */
+#define HANGUL_JAMO_BLOCK 32
+
+/* 블럭 안의 코드마다 분류 결과를 bit로 모아 둔 것 */
+typedef struct _HangulJamoMasks {
+    uint32_t l;	    /* 현대 한글 초성 U+1100-U+1112 */
+    uint32_t v;	    /* 현대 한글 중성 U+1161-U+1175 */
+    uint32_t t;	    /* 현대 한글 종성 U+11A8-U+11C2 */
+    uint32_t p;	    /* 앞뒤 글자와 관계없이 그대로 복사되는 글자 */
+    uint32_t z;	    /* 0 */
+} HangulJamoMasks;
+
+/* 자모나 결합 문자가 아니어서 음절 경계를 바꾸지 않는 글자인지 확인한다.
+ * 이런 글자는 hangul_syllable_len()에서 항상 길이 1이 된다.
+ * 범위는 is_syllable_boundary()와 hangul_is_combining_mark()를 따르고,
+ * 확인을 줄이기 위해 U+A960-U+D7FF는 한 범위로 본다. */
+static inline bool
+is_plain_char(ucschar c)
+{
+    return c != 0 &&
+	!(c >= 0x0300 && c <= 0x036f) &&
+	!(c >= 0x1100 && c <= 0x11ff) &&
+	!(c >= 0x1dc0 && c <= 0x1dff) &&
+	!(c >= 0x302e && c <= 0x302f) &&
+	!(c >= 0xa960 && c <= 0xd7ff) &&
+	!(c >= 0xfe20 && c <= 0xfe2f);
+}
+
+#ifdef HANGUL_CTYPE_USE_SSE2
+/* lo <= c <= hi 인 lane을 모두 1로 채운다. SSE2에는 unsigned 비교가
+ * 없으므로 부호 bit를 뒤집어서 signed로 비교한다. */
+static inline __m128i
+hangul_sse2_in_range(__m128i c, ucschar lo, ucschar hi)
+{
+    const __m128i bias = _mm_set1_epi32((int)0x80000000u);
+    __m128i x = _mm_xor_si128(_mm_sub_epi32(c, _mm_set1_epi32((int)lo)), bias);
+    return _mm_cmplt_epi32(x, _mm_set1_epi32((int)((hi - lo + 1) ^ 0x80000000u)));
+}
+
+static inline uint32_t
+hangul_sse2_mask(__m128i m)
+{
+    return (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(m));
+}
+#endif /* HANGUL_CTYPE_USE_SSE2 */
+
+static void
+hangul_jamo_classify(const ucschar* str, HangulJamoMasks* masks)
+{
+    int i;
+
+    masks->l = masks->v = masks->t = masks->p = masks->z = 0;
+
+#ifdef HANGUL_CTYPE_USE_SSE2
+    for (i = 0; i < HANGUL_JAMO_BLOCK; i += 4) {
+	__m128i c = _mm_loadu_si128((const __m128i*)(str + i));
+	__m128i other;
+
+	other = _mm_cmpeq_epi32(c, _mm_setzero_si128());
+	masks->z |= hangul_sse2_mask(other) << i;
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0x0300, 0x036f));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0x1100, 0x11ff));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0x1dc0, 0x1dff));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0x302e, 0x302f));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0xa960, 0xd7ff));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0xfe20, 0xfe2f));
+
+	masks->p |= (hangul_sse2_mask(other) ^ 0xf) << i;
+	masks->l |= hangul_sse2_mask(hangul_sse2_in_range(c, 0x1100, 0x1112)) << i;
+	masks->v |= hangul_sse2_mask(hangul_sse2_in_range(c, 0x1161, 0x1175)) << i;
+	masks->t |= hangul_sse2_mask(hangul_sse2_in_range(c, 0x11a8, 0x11c2)) << i;
+    }
+#else
+    for (i = 0; i < HANGUL_JAMO_BLOCK; i++) {
+	ucschar c = str[i];
+	uint32_t bit = (uint32_t)1 << i;
+
+	if (c == 0)
+	    masks->z |= bit;
+	else if (is_plain_char(c))
+	    masks->p |= bit;
+	else if (c >= 0x1100 && c <= 0x1112)
+	    masks->l |= bit;
+	else if (c >= 0x1161 && c <= 0x1175)
+	    masks->v |= bit;
+	else if (c >= 0x11a8 && c <= 0x11c2)
+	    masks->t |= bit;
+    }
+#endif /* HANGUL_CTYPE_USE_SSE2 */
+}
+
+/* str의 앞쪽 절반에서 시작하는 현대 한글 L V T? 음절과 그대로 복사되는
+ * 글자를 처리한다. 이 음절들은 압축할 자모가 없으므로 build_syllable()을
+ * 거치지 않고 바로 계산한다. 다음 글자가 음절을 이어갈 수 있는 경우처럼
+ * 이 방법으로 처리할 수 없는 곳을 만나면 멈춘다.
+ * dest에 쓴 코드의 수를 리턴하고, 읽은 코드의 수는 nread에 저장한다. */
+static int
+hangul_jamos_compose_block(ucschar* dest, int destlen,
+			   const ucschar* str, int* nread)
+{
+    HangulJamoMasks masks;
+    uint32_t next_ok;
+    int i = 0;
+    int n = 0;
+
+    hangul_jamo_classify(str, &masks);
+
+    /* 음절 뒤에 오더라도 음절 경계가 되는 글자 */
+    next_ok = masks.l | masks.p | masks.z;
+
+    while (i < HANGUL_JAMO_BLOCK / 2 && n < destlen) {
+	uint32_t bit = (uint32_t)1 << i;
+	ucschar c;
+
+	if (masks.p & bit) {
+	    dest[n++] = str[i];
+	    i++;
+	    continue;
+	}
+
+	if (!(masks.l & bit) || !(masks.v & (bit << 1)))
+	    break;
+
+	c = ((str[i] - choseong_base) * njungseong +
+	     (str[i + 1] - jungseong_base)) * njongseong + syllable_base;
+	if ((masks.t & (bit << 2)) && (next_ok & (bit << 3))) {
+	    dest[n++] = c + (str[i + 2] - jongseong_base);
+	    i += 3;
+	} else if (next_ok & (bit << 2)) {
+	    dest[n++] = c;
+	    i += 2;
+	} else {
+	    break;
+	}
+    }
+
+    *nread = i;
+    return n;
+}
+
 /**
  * @ingroup hangulctype
  * @brief 자모 스트링을 음절 스트링으로 변환
@@ -1703,9 +1742,27 @@ hangul_jamos_to_syllables(ucschar* dest, int destlen, const ucschar* src, int sr
     inleft = srclen;
     outleft = destlen;
 
-    n = hangul_syllable_len(s, inleft);
-    while (n > 0 && inleft > 0 && outleft > 0) {
-	ucschar c = build_syllable(s, n);
+    while (inleft > 0 && outleft > 0) {
+	ucschar c;
+
+	/* 현대 한글 음절은 한 블럭씩 바로 조합하고, 옛한글이나 채움 문자처럼
+	 * 그렇게 할 수 없는 곳만 아래에서 한 음절씩 처리한다. */
+	if (inleft >= HANGUL_JAMO_BLOCK) {
+	    int nread;
+	    int nwritten = hangul_jamos_compose_block(d, outleft, s, &nread);
+	    d += nwritten;
+	    outleft -= nwritten;
+	    s += nread;
+	    inleft -= nread;
+	    if (nread > 0)
+		continue;
+	}
+
+	n = hangul_syllable_len(s, inleft);
+	if (n <= 0)
+	    break;
+
+	c = build_syllable(s, n);
 	if (c != 0) {
 	    *d = c;
 	    d++;
@@ -1721,8 +1778,2160 @@ hangul_jamos_to_syllables(ucschar* dest, int destlen, const ucschar* src, int sr
 
 	s += n;
 	inleft -= n;
-	n = hangul_syllable_len(s, inleft);
     }
 
     return destlen - outleft;
 }
+
+/* 음절을 분해할 때 한번에 처리하는 음절의 수 */
+#define HANGUL_SYLLABLE_BLOCK 8
+
+/* 현대 한글 자모의 호환 자모. 중성은 U+314F부터 차례로 있다. */
+static const unsigned short hangul_choseong_cjamo[] = {
+    0x3131, 0x3132, 0x3134, 0x3137, 0x3138, 0x3139, 0x3141, 0x3142,
+    0x3143, 0x3145, 0x3146, 0x3147, 0x3148, 0x3149, 0x314a, 0x314b,
+    0x314c, 0x314d, 0x314e
+};
+
+static const unsigned short hangul_jongseong_cjamo[] = {
+    0x0000, 0x3131, 0x3132, 0x3133, 0x3134, 0x3135, 0x3136, 0x3137,
+    0x3139, 0x313a, 0x313b, 0x313c, 0x313d, 0x313e, 0x313f, 0x3140,
+    0x3141, 0x3142, 0x3144, 0x3145, 0x3146, 0x3147, 0x3148, 0x314a,
+    0x314b, 0x314c, 0x314d, 0x314e
+};
+
+/* 음절 8개를 초성, 중성, 종성의 순서값으로 나눈다. 모두 음절이 아니면
+ * false를 리턴한다. 음절의 순서값은 16bit에 들어가므로 SSE2에서는
+ * 나눗셈을 16bit 곱셈의 상위 값으로 한번에 계산한다.
+ *  s / 28 = (s * 9363) >> 18,  q / 21 = (q * 3121) >> 16  (s < 11172) */
+static bool
+hangul_syllable_block_split(const ucschar* src, uint16_t* cho,
+			    uint16_t* jung, uint16_t* jong)
+{
+#ifdef HANGUL_CTYPE_USE_SSE2
+    const __m128i base = _mm_set1_epi32(syllable_base);
+    __m128i c0 = _mm_loadu_si128((const __m128i*)src);
+    __m128i c1 = _mm_loadu_si128((const __m128i*)(src + 4));
+    __m128i ok = _mm_and_si128(hangul_sse2_in_range(c0, 0xac00, 0xd7a3),
+			       hangul_sse2_in_range(c1, 0xac00, 0xd7a3));
+    __m128i s, q, t, l, v;
+
+    if (hangul_sse2_mask(ok) != 0xf)
+	return false;
+
+    s = _mm_packs_epi32(_mm_sub_epi32(c0, base), _mm_sub_epi32(c1, base));
+    q = _mm_srli_epi16(_mm_mulhi_epu16(s, _mm_set1_epi16(9363)), 2);
+    t = _mm_sub_epi16(s, _mm_mullo_epi16(q, _mm_set1_epi16(njongseong)));
+    l = _mm_mulhi_epu16(q, _mm_set1_epi16(3121));
+    v = _mm_sub_epi16(q, _mm_mullo_epi16(l, _mm_set1_epi16(njungseong)));
+
+    _mm_storeu_si128((__m128i*)cho, l);
+    _mm_storeu_si128((__m128i*)jung, v);
+    _mm_storeu_si128((__m128i*)jong, t);
+#else
+    int i;
+
+    for (i = 0; i < HANGUL_SYLLABLE_BLOCK; i++) {
+	if (!hangul_is_syllable(src[i]))
+	    return false;
+    }
+
+    for (i = 0; i < HANGUL_SYLLABLE_BLOCK; i++) {
+	unsigned s = src[i] - syllable_base;
+	jong[i] = s % njongseong;
+	s /= njongseong;
+	jung[i] = s % njungseong;
+	cho[i] = s / njungseong;
+    }
+#endif /* HANGUL_CTYPE_USE_SSE2 */
+    return true;
+}
+
+/* 초성, 중성, 종성 순서값을 자모로 바꾸어 dest에 쓰고 쓴 코드의 수를
+ * 리턴한다. dest가 NULL이면 길이만 계산한다. */
+static inline int
+hangul_syllable_emit(ucschar* dest, unsigned cho, unsigned jung, unsigned jong,
+		     bool cjamo)
+{
+    if (dest != NULL) {
+	if (cjamo) {
+	    dest[0] = hangul_choseong_cjamo[cho];
+	    dest[1] = 0x314f + jung;
+	    if (jong != 0)
+		dest[2] = hangul_jongseong_cjamo[jong];
+	} else {
+	    dest[0] = choseong_base + cho;
+	    dest[1] = jungseong_base + jung;
+	    if (jong != 0)
+		dest[2] = jongseong_base + jong;
+	}
+    }
+
+    return jong != 0 ? 3 : 2;
+}
+
+static int
+hangul_syllables_decompose(ucschar* dest, int destlen,
+			   const ucschar* src, int srclen, bool cjamo)
+{
+    uint16_t cho[HANGUL_SYLLABLE_BLOCK];
+    uint16_t jung[HANGUL_SYLLABLE_BLOCK];
+    uint16_t jong[HANGUL_SYLLABLE_BLOCK];
+    int i = 0;
+    int n = 0;
+    int j, end;
+
+    if (src == NULL)
+	return 0;
+
+    if (srclen < 0) {
+	srclen = 0;
+	while (src[srclen] != 0)
+	    srclen++;
+    }
+
+    /* dest가 NULL이면 길이만 구한다 */
+    if (dest == NULL)
+	destlen = INT_MAX;
+
+    while (i < srclen) {
+	/* 음절만 8개 이어지고 dest에 자리가 충분하면 한번에 처리한다 */
+	if (i + HANGUL_SYLLABLE_BLOCK <= srclen &&
+	    destlen - n >= HANGUL_SYLLABLE_BLOCK * 3 &&
+	    hangul_syllable_block_split(src + i, cho, jung, jong)) {
+	    for (j = 0; j < HANGUL_SYLLABLE_BLOCK; j++) {
+		n += hangul_syllable_emit(dest != NULL ? dest + n : NULL,
+					  cho[j], jung[j], jong[j], cjamo);
+	    }
+	    i += HANGUL_SYLLABLE_BLOCK;
+	    continue;
+	}
+
+	/* 그렇지 않으면 다음 블럭까지 한 글자씩 처리한다 */
+	end = i + HANGUL_SYLLABLE_BLOCK < srclen ? i + HANGUL_SYLLABLE_BLOCK
+						 : srclen;
+	for (; i < end; i++) {
+	    ucschar c = src[i];
+
+	    if (hangul_is_syllable(c)) {
+		unsigned s = c - syllable_base;
+		unsigned t = s % njongseong;
+
+		/* 한 음절의 자모를 나누어 쓰지는 않는다 */
+		if (destlen - n < (t != 0 ? 3 : 2))
+		    return n;
+
+		s /= njongseong;
+		n += hangul_syllable_emit(dest != NULL ? dest + n : NULL,
+					  s / njungseong, s % njungseong, t,
+					  cjamo);
+	    } else {
+		if (destlen - n < 1)
+		    return n;
+
+		if (dest != NULL)
+		    dest[n] = cjamo ? hangul_jamo_to_cjamo(c) : c;
+		n++;
+	    }
+	}
+    }
+
+    return n;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief 음절 스트링을 자모 스트링으로 분해
+ * @param dest 분해한 자모를 저장할 버퍼, NULL이면 필요한 길이만 구한다
+ * @param destlen @a dest 의 길이(ucschar 코드 단위)
+ * @param src 분해할 스트링
+ * @param srclen @a src 의 길이(ucschar 코드 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @return @a dest 에 저장한 코드의 갯수
+ *
+ * 이 함수는 @a src 의 현대 한글 음절을 각각 @ref hangul_syllable_to_jamo 와
+ * 같이 초성, 중성, 종성의 자모로 분해하여 @a dest 에 저장한다. 음절이 아닌
+ * 글자는 그대로 복사한다. 한 음절의 자모는 나누어 저장하지 않으므로
+ * @a destlen 이 모자라면 그 음절 앞에서 멈춘다.
+ *
+ * @a dest 를 NULL로 주면 @a destlen 은 무시하고, 모두 분해했을 때의
+ * 길이를 리턴한다. 따라서 다음과 같이 정확한 크기의 버퍼를 준비할 수 있다.
+ *
+ * @code
+ * int n = hangul_syllables_to_jamos(NULL, 0, src, srclen);
+ * ucschar* jamos = malloc(sizeof(ucschar) * n);
+ * hangul_syllables_to_jamos(jamos, n, src, srclen);
+ * @endcode
+ */
+int
+hangul_syllables_to_jamos(ucschar* dest, int destlen,
+			  const ucschar* src, int srclen)
+{
+    return hangul_syllables_decompose(dest, destlen, src, srclen, false);
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief 음절 스트링을 호환 자모 스트링으로 분해
+ * @param dest 분해한 호환 자모를 저장할 버퍼, NULL이면 필요한 길이만 구한다
+ * @param destlen @a dest 의 길이(ucschar 코드 단위)
+ * @param src 분해할 스트링
+ * @param srclen @a src 의 길이(ucschar 코드 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @return @a dest 에 저장한 코드의 갯수
+ *
+ * @ref hangul_syllables_to_jamos 와 같이 음절을 분해하지만, 결과를
+ * 호환 자모(U+3131-U+318E)로 저장한다. 겹받침은 "ㄳ"과 같이 한 글자가 된다.
+ * 음절이 아닌 글자는 @ref hangul_jamo_to_cjamo 로 변환하여 저장한다.
+ * 길이는 @ref hangul_syllables_to_jamos 와 같다.
+ */
+int
+hangul_syllables_to_cjamos(ucschar* dest, int destlen,
+			   const ucschar* src, int srclen)
+{
+    return hangul_syllables_decompose(dest, destlen, src, srclen, true);
+}
+
+/* 초성 검색에 쓰는 글자. 음절과 첫가끝 초성은 초성의 호환 자모로 바꾸고,
+ * 버려야 하는 글자는 0을 리턴한다. */
+static inline ucschar
+hangul_choseong_signature_char(ucschar c)
+{
+    unsigned type = hangul_ctype(c);
+
+    if (type & (HANGUL_CTYPE_LV | HANGUL_CTYPE_LVT))
+	return hangul_choseong_cjamo[(c - syllable_base) /
+				     (njungseong * njongseong)];
+
+    if ((type & HANGUL_CTYPE_L) && !(type & HANGUL_CTYPE_FILLER))
+	return hangul_jamo_to_cjamo(c);
+
+    if (type & (HANGUL_CTYPE_L | HANGUL_CTYPE_V |
+		HANGUL_CTYPE_T | HANGUL_CTYPE_MARK))
+	return 0;
+
+    return c;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief 스트링에서 초성만 뽑아내는 함수
+ * @param dest 초성을 저장할 버퍼, NULL이면 필요한 길이만 구한다
+ * @param destlen @a dest 의 길이(ucschar 코드 단위)
+ * @param src 초성을 뽑을 스트링
+ * @param srclen @a src 의 길이(ucschar 코드 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @return @a dest 에 저장한 코드의 갯수
+ *
+ * 이 함수는 "사과"를 "ㅅㄱ"으로 바꾸는 것과 같이 @a src 의 음절을 그 초성의
+ * 호환 자모(U+3131-U+314E)로 바꾸어 @a dest 에 저장한다. 초성 검색에서
+ * 후보 스트링과 검색어를 비교할 수 있는 형태로 바꿀 때 사용한다.
+ *
+ * 첫가끝 자모 스트링은 초성만 @ref hangul_jamo_to_cjamo 로 바꾸어 저장하고
+ * 중성, 종성, 채움 문자, 방점은 버린다. 그 외의 글자는 그대로 복사하므로
+ * "ㅅ과"와 같이 호환 자모가 섞인 검색어도 같은 결과 "ㅅㄱ"이 된다.
+ *
+ * @a dest 가 NULL이면 @a destlen 은 무시하고 필요한 길이를 리턴한다.
+ */
+int
+hangul_syllables_to_choseongs(ucschar* dest, int destlen,
+			      const ucschar* src, int srclen)
+{
+    uint16_t cho[HANGUL_SYLLABLE_BLOCK];
+    uint16_t jung[HANGUL_SYLLABLE_BLOCK];
+    uint16_t jong[HANGUL_SYLLABLE_BLOCK];
+    int i = 0;
+    int n = 0;
+    int j, end;
+
+    if (src == NULL)
+	return 0;
+
+    if (srclen < 0) {
+	srclen = 0;
+	while (src[srclen] != 0)
+	    srclen++;
+    }
+
+    if (dest == NULL)
+	destlen = INT_MAX;
+
+    while (i < srclen) {
+	if (i + HANGUL_SYLLABLE_BLOCK <= srclen &&
+	    destlen - n >= HANGUL_SYLLABLE_BLOCK &&
+	    hangul_syllable_block_split(src + i, cho, jung, jong)) {
+	    if (dest != NULL) {
+		for (j = 0; j < HANGUL_SYLLABLE_BLOCK; j++)
+		    dest[n + j] = hangul_choseong_cjamo[cho[j]];
+	    }
+	    n += HANGUL_SYLLABLE_BLOCK;
+	    i += HANGUL_SYLLABLE_BLOCK;
+	    continue;
+	}
+
+	end = i + HANGUL_SYLLABLE_BLOCK < srclen ? i + HANGUL_SYLLABLE_BLOCK
+						 : srclen;
+	for (; i < end; i++) {
+	    ucschar c = hangul_choseong_signature_char(src[i]);
+	    if (c == 0)
+		continue;
+
+	    if (destlen - n < 1)
+		return n;
+
+	    if (dest != NULL)
+		dest[n] = c;
+	    n++;
+	}
+    }
+
+    return n;
+}
+
+/* 음절 경계를 한번에 확인하는 코드의 수 */
+#define HANGUL_BOUNDARY_BLOCK 8
+
+/* src의 8 글자 중에 자모나 결합 문자가 없는지 확인한다. 이런 글자들은
+ * 앞 글자가 초성이 아니라면 모두 음절의 시작이 된다. 음절과 그 외의
+ * 글자는 이어지는 글자가 자모나 결합 문자일 때만 경계가 아니기 때문이다.
+ * 범위는 hangul_ctype()의 L, V, T, MARK를 따르고, 확인을 줄이기 위해
+ * 옛한글 자모 영역은 한 범위로 본다. */
+static inline bool
+hangul_boundary_block_is_simple(const ucschar* src)
+{
+#ifdef HANGUL_CTYPE_USE_SSE2
+    __m128i other = _mm_setzero_si128();
+    int i;
+
+    for (i = 0; i < HANGUL_BOUNDARY_BLOCK; i += 4) {
+	__m128i c = _mm_loadu_si128((const __m128i*)(src + i));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0x0300, 0x036f));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0x1100, 0x11ff));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0x1dc0, 0x1dff));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0x302e, 0x302f));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0xa960, 0xa97f));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0xd7b0, 0xd7ff));
+	other = _mm_or_si128(other, hangul_sse2_in_range(c, 0xfe20, 0xfe2f));
+    }
+
+    return hangul_sse2_mask(other) == 0;
+#else
+    unsigned type = 0;
+    int i;
+
+    for (i = 0; i < HANGUL_BOUNDARY_BLOCK; i++)
+	type |= hangul_ctype(src[i]);
+
+    return (type & (HANGUL_CTYPE_L | HANGUL_CTYPE_V |
+		    HANGUL_CTYPE_T | HANGUL_CTYPE_MARK)) == 0;
+#endif /* HANGUL_CTYPE_USE_SSE2 */
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief 스트링의 모든 음절 경계를 구하는 함수
+ * @param dest 음절이 시작하는 위치를 저장할 버퍼, NULL이면 갯수만 구한다
+ * @param destlen @a dest 의 길이(int 단위)
+ * @param src 음절 경계를 구할 스트링
+ * @param srclen @a src 의 길이(ucschar 코드 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @return @a dest 에 저장한 위치의 갯수
+ *
+ * 이 함수는 @a src 에 있는 음절마다 그 음절이 시작하는 위치(@a src 에서의
+ * offset)를 차례로 @a dest 에 저장한다. 첫 음절은 항상 0에서 시작하고,
+ * 마지막 음절은 @a srclen 에서 끝난다. 음절을 나누는 기준은
+ * @ref hangul_syllable_iterator_next 와 같으므로, 이 함수가 구한 위치는
+ * @a src 의 처음부터 @ref hangul_syllable_iterator_next 를 차례로 불러서
+ * 얻는 위치와 같다. 그러나 스트링을 한번만 읽는다.
+ *
+ * @a dest 가 모자라면 @a destlen 개의 위치만 저장하고 멈춘다. 마지막으로
+ * 저장한 위치는 음절의 시작이므로, 그 위치부터 다시 이 함수를 부르면 나머지
+ * 경계를 이어서 구할 수 있다. 따라서 고정된 크기의 버퍼로 길이에 제한 없이
+ * 스트링을 처리할 수 있다.
+ *
+ * @a dest 를 NULL로 주면 @a destlen 은 무시하고, 음절의 갯수를 리턴한다.
+ */
+int
+hangul_syllable_boundaries(int* dest, int destlen,
+			   const ucschar* src, int srclen)
+{
+    unsigned prev;
+    unsigned type;
+    unsigned seen;
+    bool probe;
+    int i, j, end;
+    int n = 0;
+
+    if (src == NULL)
+	return 0;
+
+    if (srclen < 0) {
+	srclen = 0;
+	while (src[srclen] != 0)
+	    srclen++;
+    }
+
+    /* dest가 NULL이면 갯수만 구한다 */
+    if (dest == NULL)
+	destlen = INT_MAX;
+
+    if (srclen == 0 || destlen <= 0)
+	return 0;
+
+    if (dest != NULL)
+	dest[0] = 0;
+    n = 1;
+    prev = hangul_ctype(src[0]);
+
+    i = 1;
+    probe = true;
+    while (i < srclen) {
+	/* 앞 글자가 초성이 아니고 자모나 결합 문자가 없으면, 모두 음절의
+	 * 시작이다 */
+	if (probe && (prev & HANGUL_CTYPE_L) == 0 &&
+	    i + HANGUL_BOUNDARY_BLOCK <= srclen &&
+	    destlen - n >= HANGUL_BOUNDARY_BLOCK &&
+	    hangul_boundary_block_is_simple(src + i)) {
+	    if (dest != NULL) {
+		for (j = 0; j < HANGUL_BOUNDARY_BLOCK; j++)
+		    dest[n + j] = i + j;
+	    }
+	    n += HANGUL_BOUNDARY_BLOCK;
+	    i += HANGUL_BOUNDARY_BLOCK;
+	    prev = hangul_ctype(src[i - 1]);
+	    continue;
+	}
+
+	/* 그렇지 않으면 다음 블럭까지 한 글자씩 확인한다. dest가 블럭의
+	 * 글자 수만큼 남아 있으면 경계가 아닌 위치에도 써 두고 다음 위치에
+	 * 덮어쓰게 해서 분기를 없앤다. */
+	end = i + HANGUL_BOUNDARY_BLOCK < srclen ? i + HANGUL_BOUNDARY_BLOCK
+						 : srclen;
+	seen = 0;
+	if (dest == NULL) {
+	    for (; i < end; i++) {
+		type = hangul_ctype(src[i]);
+		n += (type & hangul_ctype_follow[prev & 0x1f]) == 0;
+		seen |= type;
+		prev = type;
+	    }
+	} else if (destlen - n >= end - i) {
+	    for (; i < end; i++) {
+		type = hangul_ctype(src[i]);
+		dest[n] = i;
+		n += (type & hangul_ctype_follow[prev & 0x1f]) == 0;
+		seen |= type;
+		prev = type;
+	    }
+	} else {
+	    for (; i < end; i++) {
+		type = hangul_ctype(src[i]);
+		if ((type & hangul_ctype_follow[prev & 0x1f]) == 0) {
+		    if (n >= destlen)
+			return n;
+		    dest[n] = i;
+		    n++;
+		}
+		seen |= type;
+		prev = type;
+	    }
+	}
+
+	/* 자모나 결합 문자가 있었던 블럭 다음은 대개 또 자모가 이어지므로,
+	 * 한 글자씩 확인한 블럭에 그런 글자가 없을 때만 다음 블럭을 한꺼번에
+	 * 확인해 본다. */
+	probe = (seen & (HANGUL_CTYPE_L | HANGUL_CTYPE_V |
+			 HANGUL_CTYPE_T | HANGUL_CTYPE_MARK)) == 0;
+    }
+
+    return n;
+}
+
+/* s에서 UTF-8 글자 하나를 읽어 c에 저장하고 읽은 byte 수를 리턴한다.
+ * 올바른 UTF-8이 아니면 1 byte만 읽고 c는 U+FFFD가 된다. */
+static inline int
+hangul_utf8_decode(const unsigned char* s, const unsigned char* end,
+		   ucschar* c)
+{
+    ucschar v, min;
+    int len, i;
+
+    if (s[0] < 0x80) {
+	*c = s[0];
+	return 1;
+    } else if (s[0] >= 0xc2 && s[0] <= 0xdf) {
+	len = 2;
+	v = s[0] & 0x1f;
+	min = 0x80;
+    } else if (s[0] >= 0xe0 && s[0] <= 0xef) {
+	len = 3;
+	v = s[0] & 0x0f;
+	min = 0x800;
+    } else if (s[0] >= 0xf0 && s[0] <= 0xf4) {
+	len = 4;
+	v = s[0] & 0x07;
+	min = 0x10000;
+    } else {
+	goto invalid;
+    }
+
+    if (end - s < len)
+	goto invalid;
+
+    for (i = 1; i < len; i++) {
+	if ((s[i] & 0xc0) != 0x80)
+	    goto invalid;
+	v = (v << 6) | (s[i] & 0x3f);
+    }
+
+    if (v < min || v > 0x10ffff || (v >= 0xd800 && v <= 0xdfff))
+	goto invalid;
+
+    *c = v;
+    return len;
+
+invalid:
+    *c = 0xfffd;
+    return 1;
+}
+
+/* p 앞의 UTF-8 글자가 시작하는 위치를 찾고 그 글자를 c에 저장한다.
+ * hangul_utf8_decode()로 앞에서부터 읽은 것과 같은 위치가 된다. */
+static inline const unsigned char*
+hangul_utf8_prev(const unsigned char* begin, const unsigned char* p,
+		 ucschar* c)
+{
+    const unsigned char* q = p - 1;
+    int i;
+
+    for (i = 0; i < 3 && q > begin && (*q & 0xc0) == 0x80; i++)
+	q--;
+
+    if (q + hangul_utf8_decode(q, p, c) == p)
+	return q;
+
+    hangul_utf8_decode(p - 1, p, c);
+    return p - 1;
+}
+
+/* c를 UTF-8로 buf에 쓰고 쓴 byte 수를 리턴한다. */
+static inline int
+hangul_utf8_encode(ucschar c, char* buf)
+{
+    if (c < 0x80) {
+	buf[0] = c;
+	return 1;
+    } else if (c < 0x800) {
+	buf[0] = 0xc0 | (c >> 6);
+	buf[1] = 0x80 | (c & 0x3f);
+	return 2;
+    } else if (c < 0x10000) {
+	buf[0] = 0xe0 | (c >> 12);
+	buf[1] = 0x80 | ((c >> 6) & 0x3f);
+	buf[2] = 0x80 | (c & 0x3f);
+	return 3;
+    } else {
+	buf[0] = 0xf0 | (c >> 18);
+	buf[1] = 0x80 | ((c >> 12) & 0x3f);
+	buf[2] = 0x80 | ((c >> 6) & 0x3f);
+	buf[3] = 0x80 | (c & 0x3f);
+	return 4;
+    }
+}
+
+/* s가 현대 한글 초성, 중성, (종성)으로 된 한 음절이면 음절 코드를 c에
+ * 저장하고 읽은 byte 수를 리턴한다. 그렇지 않으면 0을 리턴한다.
+ * 현대 한글 자모는 UTF-8로 다음과 같으므로 byte를 바로 비교한다.
+ *   초성 U+1100-U+1112: E1 84 80-92
+ *   중성 U+1161-U+1175: E1 85 A1-B5
+ *   종성 U+11A8-U+11C2: E1 86 A8-BF, E1 87 80-82
+ * 음절의 끝은 is_syllable_boundary()와 같이 다음 글자로 확인한다. */
+static inline int
+hangul_utf8_compose_modern(const unsigned char* s, const unsigned char* end,
+			   ucschar* c)
+{
+    ucschar next;
+    unsigned t;
+
+    if (end - s < 6 ||
+	s[0] != 0xe1 || s[1] != 0x84 || s[2] > 0x92 ||
+	s[3] != 0xe1 || s[4] != 0x85 || s[5] < 0xa1 || s[5] > 0xb5)
+	return 0;
+
+    *c = ((s[2] - 0x80) * njungseong + (s[5] - 0xa1)) * njongseong +
+	 syllable_base;
+    if (end - s == 6 || s[6] < 0x80)
+	return 6;
+
+    if (end - s >= 9 && s[6] == 0xe1 &&
+	((s[7] == 0x86 && s[8] >= 0xa8 && s[8] <= 0xbf) ||
+	 (s[7] == 0x87 && s[8] >= 0x80 && s[8] <= 0x82))) {
+	t = ((s[7] & 0x3f) << 6 | (s[8] & 0x3f)) + 0x1000 - jongseong_base;
+	if (end - s == 9 || s[9] < 0x80) {
+	    *c += t;
+	    return 9;
+	}
+	hangul_utf8_decode(s + 9, end, &next);
+	if (hangul_ctype(next) & hangul_ctype_follow[HANGUL_CTYPE_T])
+	    return 0;
+	*c += t;
+	return 9;
+    }
+
+    hangul_utf8_decode(s + 6, end, &next);
+    if (hangul_ctype(next) & hangul_ctype_follow[HANGUL_CTYPE_V])
+	return 0;
+    return 6;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief UTF-8 자모 스트링을 UTF-8 음절 스트링으로 변환
+ * @param dest 음절형으로 변환된 결과가 저장될 버퍼
+ * @param destlen 결과를 저장할 버퍼의 길이(byte 단위)
+ * @param src 변환할 UTF-8 자모 스트링
+ * @param srclen 변환할 자모 스트링의 길이(byte 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @return @a dest 에 저장한 byte 수
+ *
+ * @ref hangul_jamos_to_syllables 의 UTF-8 버전이다. @a src 를 UCS4로
+ * 변환하지 않고 한 음절씩 읽어서 바로 조합하므로 결과는
+ * @ref hangul_jamos_to_syllables 와 같다. 조합할 수 없는 음절과 올바르지
+ * 않은 UTF-8 byte는 그대로 복사한다.
+ *
+ * 글자의 중간에서 자르지 않으므로 @a destlen 이 모자라면 그 글자 앞에서
+ * 멈춘다. 결과 스트링은 0으로 끝나지 않는다.
+ */
+int
+hangul_jamos_to_syllables_utf8(char* dest, int destlen,
+			       const char* src, int srclen)
+{
+    const unsigned char* s = (const unsigned char*)src;
+    const unsigned char* end;
+    int n = 0;
+
+    if (src == NULL || dest == NULL)
+	return 0;
+
+    if (srclen < 0)
+	srclen = strlen(src);
+    end = s + srclen;
+
+    while (s < end && n < destlen) {
+	HangulSyllableBuilder builder;
+	const unsigned char* begin;
+	ucschar prev, curr, c;
+	int len;
+
+#ifdef HANGUL_CTYPE_USE_SSE2
+	/* ASCII 글자는 각각 한 음절이므로 16 byte씩 그대로 복사한다 */
+	if (end - s >= 16 && destlen - n >= 16) {
+	    __m128i b = _mm_loadu_si128((const __m128i*)s);
+	    __m128i z = _mm_cmpeq_epi8(b, _mm_setzero_si128());
+	    if ((_mm_movemask_epi8(b) | _mm_movemask_epi8(z)) == 0) {
+		_mm_storeu_si128((__m128i*)(dest + n), b);
+		s += 16;
+		n += 16;
+		continue;
+	    }
+	}
+#endif /* HANGUL_CTYPE_USE_SSE2 */
+
+	if (*s < 0x80) {
+	    if (*s == 0)
+		break;
+	    dest[n++] = *s++;
+	    continue;
+	}
+
+	/* 현대 한글 자모는 바로 조합하고, 그 외에는 음절 경계까지 읽으면서
+	 * 조합한다 */
+	len = hangul_utf8_compose_modern(s, end, &c);
+	if (len > 0) {
+	    if (destlen - n < 3)
+		break;
+	    n += hangul_utf8_encode(c, dest + n);
+	    s += len;
+	    continue;
+	}
+
+	begin = s;
+	s += hangul_utf8_decode(s, end, &prev);
+	syllable_builder_init(&builder);
+	syllable_builder_push(&builder, prev);
+	while (s < end) {
+	    len = hangul_utf8_decode(s, end, &curr);
+	    if (is_syllable_boundary(prev, curr))
+		break;
+	    syllable_builder_push(&builder, curr);
+	    prev = curr;
+	    s += len;
+	}
+
+	c = syllable_builder_get(&builder);
+	if (c != 0) {
+	    char buf[4];
+	    len = hangul_utf8_encode(c, buf);
+	    if (destlen - n < len)
+		break;
+	    memcpy(dest + n, buf, len);
+	    n += len;
+	} else {
+	    /* 조합할 수 없으면 읽은 글자를 그대로 복사한다 */
+	    while (begin < s) {
+		len = hangul_utf8_decode(begin, s, &curr);
+		if (destlen - n < len)
+		    return n;
+		memcpy(dest + n, begin, len);
+		begin += len;
+		n += len;
+	    }
+	}
+    }
+
+    return n;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief UTF-8 스트링에서 다음 음절의 위치를 구하는 함수
+ * @param iter 현재 위치
+ * @param end 스트링의 끝위치, 포인터가 이동할 한계값
+ * @return 다음 음절의 첫번째 byte에 대한 포인터
+ *
+ * @ref hangul_syllable_iterator_next 의 UTF-8 버전이다. 음절을 나누는
+ * 기준은 같고, 올바르지 않은 UTF-8 byte는 한 글자로 본다.
+ */
+const char*
+hangul_syllable_iterator_next_utf8(const char* iter, const char* end)
+{
+    const unsigned char* s = (const unsigned char*)iter;
+    const unsigned char* e = (const unsigned char*)end;
+    ucschar prev, curr;
+    int len;
+
+    if (s >= e)
+	return iter;
+
+    s += hangul_utf8_decode(s, e, &prev);
+    while (s < e) {
+	len = hangul_utf8_decode(s, e, &curr);
+	if (is_syllable_boundary(prev, curr))
+	    break;
+	prev = curr;
+	s += len;
+    }
+
+    return (const char*)s;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief UTF-8 스트링에서 이전 음절의 위치를 구하는 함수
+ * @param iter 현재 위치
+ * @param begin 스트링의 시작위치, 포인터가 이동할 한계값
+ * @return 이전 음절의 첫번째 byte에 대한 포인터
+ *
+ * @ref hangul_syllable_iterator_prev 의 UTF-8 버전이다. 음절을 나누는
+ * 기준은 같고, 올바르지 않은 UTF-8 byte는 한 글자로 본다.
+ */
+const char*
+hangul_syllable_iterator_prev_utf8(const char* iter, const char* begin)
+{
+    const unsigned char* s = (const unsigned char*)iter;
+    const unsigned char* b = (const unsigned char*)begin;
+    const unsigned char* p;
+    ucschar prev, curr;
+
+    if (s <= b)
+	return iter;
+
+    s = hangul_utf8_prev(b, s, &curr);
+    while (s > b) {
+	p = hangul_utf8_prev(b, s, &prev);
+	if (is_syllable_boundary(prev, curr))
+	    break;
+	curr = prev;
+	s = p;
+    }
+
+    return (const char*)s;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief UTF-8 스트링에서 초성만 뽑아내는 함수
+ * @param dest 초성을 저장할 버퍼, NULL이면 필요한 길이만 구한다
+ * @param destlen @a dest 의 길이(byte 단위)
+ * @param src 초성을 뽑을 UTF-8 스트링
+ * @param srclen @a src 의 길이(byte 단위), -1이면 0으로 끝나는 스트링으로 본다
+ * @return @a dest 에 저장한 byte 수
+ *
+ * @ref hangul_syllables_to_choseongs 의 UTF-8 버전이다. 올바르지 않은
+ * UTF-8 byte는 그대로 복사한다. 글자의 중간에서 자르지 않으므로
+ * @a destlen 이 모자라면 그 글자 앞에서 멈춘다. 결과 스트링은 0으로
+ * 끝나지 않는다.
+ */
+int
+hangul_syllables_to_choseongs_utf8(char* dest, int destlen,
+				   const char* src, int srclen)
+{
+    const unsigned char* s = (const unsigned char*)src;
+    const unsigned char* end;
+    int n = 0;
+
+    if (src == NULL)
+	return 0;
+
+    if (srclen < 0)
+	srclen = strlen(src);
+    end = s + srclen;
+
+    if (dest == NULL)
+	destlen = INT_MAX;
+
+    while (s < end) {
+	char buf[4];
+	ucschar c;
+	int len, outlen;
+
+	len = hangul_utf8_decode(s, end, &c);
+	if (c == 0xfffd && len == 1) {
+	    /* 올바르지 않은 byte는 그대로 복사한다 */
+	    buf[0] = *s;
+	    outlen = 1;
+	} else {
+	    c = hangul_choseong_signature_char(c);
+	    if (c == 0) {
+		s += len;
+		continue;
+	    }
+	    outlen = hangul_utf8_encode(c, buf);
+	}
+
+	if (destlen - n < outlen)
+	    break;
+	if (dest != NULL)
+	    memcpy(dest + n, buf, outlen);
+	n += outlen;
+	s += len;
+    }
+
+    return n;
+}
+
+/* 조합 중인 음절을 보관할 때는 같은 글자가 이어지면 하나로 묶는다.
+ * 조합할 수 있는 음절은 몇 글자 되지 않지만, 종성 ㄴ 뒤의 ㄺ처럼 조합
+ * 결과를 바꾸지 않는 글자는 몇 개라도 이어질 수 있기 때문이다. */
+#define HANGUL_COMPOSER_MAX_RUNS 16
+
+typedef struct _HangulComposerRun {
+    ucschar c;
+    unsigned long count;
+} HangulComposerRun;
+
+struct _HangulComposer {
+    HangulSyllableBuilder builder;
+    HangulComposerRun runs[HANGUL_COMPOSER_MAX_RUNS];
+    int nruns;
+    int drain;		    /* 출력하고 있는 run */
+    unsigned long drained;  /* drain run에서 출력한 글자 수 */
+    ucschar prev;	    /* 마지막으로 읽은 글자 */
+    bool active;	    /* 음절을 읽고 있음 */
+    bool passthrough;	    /* 읽고 있는 음절을 조합하지 않고 바로 출력함 */
+    bool draining;	    /* 보관한 글자를 그대로 출력하고 있음 */
+};
+
+/**
+ * @ingroup hangulctype
+ * @brief 스트림을 조합하는 오브젝트를 생성하는 함수
+ * @return 새로 생성된 HangulComposer 오브젝트, 실패하면 NULL
+ *
+ * 자모 스트링을 여러 조각으로 나누어 @ref hangul_composer_compose 에 차례로
+ * 주면, 전체를 한번에 @ref hangul_jamos_to_syllables 로 변환한 것과 같은
+ * 결과를 얻을 수 있다. 조각의 경계에 걸친 음절은 다음 조각이 올 때까지
+ * 보관하므로, 길이에 제한 없는 스트림을 일정한 메모리로 처리할 수 있다.
+ * 다 쓴 오브젝트는 @ref hangul_composer_delete 로 지운다.
+ */
+HangulComposer*
+hangul_composer_new(void)
+{
+    HangulComposer* composer = malloc(sizeof(HangulComposer));
+    if (composer == NULL)
+	return NULL;
+
+    hangul_composer_reset(composer);
+    return composer;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief HangulComposer 오브젝트를 삭제하는 함수
+ * @param composer 삭제할 오브젝트
+ */
+void
+hangul_composer_delete(HangulComposer* composer)
+{
+    free(composer);
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief HangulComposer 오브젝트가 보관한 글자를 모두 버리는 함수
+ * @param composer 초기화할 오브젝트
+ */
+void
+hangul_composer_reset(HangulComposer* composer)
+{
+    if (composer == NULL)
+	return;
+
+    syllable_builder_init(&composer->builder);
+    composer->nruns = 0;
+    composer->drain = 0;
+    composer->drained = 0;
+    composer->prev = 0;
+    composer->active = false;
+    composer->passthrough = false;
+    composer->draining = false;
+}
+
+/* 보관한 글자를 dest에 출력한다. 모두 출력하면 draining이 false가 된다. */
+static int
+hangul_composer_drain(HangulComposer* composer, ucschar* dest, int destlen)
+{
+    int n = 0;
+
+    while (composer->drain < composer->nruns) {
+	const HangulComposerRun* run = &composer->runs[composer->drain];
+	while (composer->drained < run->count) {
+	    if (n >= destlen)
+		return n;
+	    dest[n++] = run->c;
+	    composer->drained++;
+	}
+	composer->drain++;
+	composer->drained = 0;
+    }
+
+    composer->nruns = 0;
+    composer->drain = 0;
+    composer->draining = false;
+    return n;
+}
+
+/* 읽고 있던 음절을 끝낸다. 조합할 수 있으면 dest에 쓰고, 그렇지 않으면
+ * 보관한 글자를 출력하도록 한다. dest에 자리가 없으면 false를 리턴한다. */
+static bool
+hangul_composer_end_syllable(HangulComposer* composer,
+			     ucschar* dest, int destlen, int* n)
+{
+    if (!composer->passthrough) {
+	ucschar c = syllable_builder_get(&composer->builder);
+	if (c != 0) {
+	    if (*n >= destlen)
+		return false;
+	    dest[(*n)++] = c;
+	    composer->nruns = 0;
+	} else {
+	    composer->draining = true;
+	}
+    }
+
+    composer->active = false;
+    composer->passthrough = false;
+    return true;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief 자모 스트링의 한 조각을 음절로 조합하는 함수
+ * @param composer 조합에 사용할 HangulComposer 오브젝트
+ * @param dest 조합한 결과를 저장할 버퍼
+ * @param destlen @a dest 의 길이(ucschar 코드 단위)
+ * @param src 조합할 자모 스트링의 조각
+ * @param srclen @a src 의 길이(ucschar 코드 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @param nread @a src 에서 읽은 길이를 저장할 포인터, NULL이어도 된다
+ * @return @a dest 에 저장한 코드의 갯수
+ *
+ * 이 함수는 @a src 를 @ref hangul_jamos_to_syllables 와 같이 조합하여
+ * @a dest 에 저장한다. 마지막 음절은 다음 조각에서 이어질 수 있으므로
+ * 출력하지 않고 보관해 두었다가, 다음 조각을 처리할 때나
+ * @ref hangul_composer_flush 를 부를 때 출력한다.
+ *
+ * @a dest 가 모자라면 중간에 멈추고, 읽은 길이를 @a nread 에 저장한다.
+ * 이 경우에는 @a src 의 나머지를 다시 주어 이어서 처리한다. 출력하는 코드의
+ * 갯수는 읽은 코드의 갯수와 보관하고 있던 코드의 갯수의 합보다 많지 않다.
+ *
+ * 한번에 변환하는 @ref hangul_jamos_to_syllables 와 달리 0도 다른 글자와
+ * 같이 처리한다.
+ */
+int
+hangul_composer_compose(HangulComposer* composer,
+			ucschar* dest, int destlen,
+			const ucschar* src, int srclen, int* nread)
+{
+    int i = 0;
+    int n = 0;
+
+    if (composer == NULL || src == NULL) {
+	if (nread != NULL)
+	    *nread = 0;
+	return 0;
+    }
+
+    if (srclen < 0) {
+	srclen = 0;
+	while (src[srclen] != 0)
+	    srclen++;
+    }
+
+    while (true) {
+	ucschar c;
+
+	if (composer->draining) {
+	    n += hangul_composer_drain(composer, dest + n, destlen - n);
+	    if (composer->draining)
+		break;
+	}
+
+	if (i >= srclen)
+	    break;
+
+	c = src[i];
+	if (composer->active && is_syllable_boundary(composer->prev, c)) {
+	    if (!hangul_composer_end_syllable(composer, dest, destlen, &n))
+		break;
+	    continue;
+	}
+
+	if (!composer->active) {
+	    /* 마지막 음절 앞까지 음절 단위로 나누어지는 곳은 한번에 조합한다.
+	     * hangul_jamos_to_syllables()는 0에서 멈추므로 0 앞까지만 준다. */
+	    int limit = srclen - i < destlen - n ? srclen - i : destlen - n;
+	    if (limit >= HANGUL_JAMO_BLOCK) {
+		const ucschar* tail;
+		const ucschar* p;
+
+		tail = hangul_syllable_iterator_prev(src + i + limit, src + i);
+		for (p = src + i; p < tail && *p != 0; p++)
+		    continue;
+
+		if (p > src + i) {
+		    n += hangul_jamos_to_syllables(dest + n, destlen - n,
+						   src + i, p - (src + i));
+		    i = p - src;
+		    continue;
+		}
+	    }
+
+	    syllable_builder_init(&composer->builder);
+	    composer->active = true;
+	}
+
+	if (composer->passthrough) {
+	    if (n >= destlen)
+		break;
+	    dest[n++] = c;
+	} else {
+	    HangulComposerRun* last = composer->runs + composer->nruns - 1;
+	    if (composer->nruns > 0 && last->c == c) {
+		last->count++;
+	    } else if (composer->nruns < HANGUL_COMPOSER_MAX_RUNS) {
+		composer->runs[composer->nruns].c = c;
+		composer->runs[composer->nruns].count = 1;
+		composer->nruns++;
+	    } else {
+		/* 더 보관할 수 없으면 조합할 수 없는 음절이다 */
+		composer->passthrough = true;
+		composer->draining = true;
+		continue;
+	    }
+
+	    /* 조합할 수 없다는 것을 알게 되면 기다리지 않고 바로 출력한다 */
+	    syllable_builder_push(&composer->builder, c);
+	    if (composer->builder.state < 0) {
+		composer->passthrough = true;
+		composer->draining = true;
+	    }
+	}
+
+	composer->prev = c;
+	i++;
+    }
+
+    if (nread != NULL)
+	*nread = i;
+
+    return n;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief 보관하고 있는 음절을 출력하는 함수
+ * @param composer 조합에 사용하는 HangulComposer 오브젝트
+ * @param dest 결과를 저장할 버퍼
+ * @param destlen @a dest 의 길이(ucschar 코드 단위)
+ * @return @a dest 에 저장한 코드의 갯수
+ *
+ * 스트림이 끝나면 이 함수를 불러서 @ref hangul_composer_compose 가 보관하고
+ * 있는 마지막 음절을 출력한다. @a dest 가 모자라면 나머지는 계속 보관하므로
+ * 0을 리턴할 때까지 다시 부른다.
+ */
+int
+hangul_composer_flush(HangulComposer* composer, ucschar* dest, int destlen)
+{
+    int n = 0;
+
+    if (composer == NULL)
+	return 0;
+
+    if (composer->active &&
+	!hangul_composer_end_syllable(composer, dest, destlen, &n))
+	return 0;
+
+    if (composer->draining)
+	n += hangul_composer_drain(composer, dest + n, destlen - n);
+
+    return n;
+}
+
+/* 정렬 키에 쓰는 자모의 기본 글자. 옛한글 자모도 이 글자들로 나누어서
+ * 비교하며, 값은 1보다 크다. (KS X 1026-1의 정렬 방법 참고) */
+enum {
+    HANGUL_LETTER_FIRST = 2,
+    HANGUL_LETTER_KIYEOK = HANGUL_LETTER_FIRST,
+    HANGUL_LETTER_NIEUN,
+    HANGUL_LETTER_TIKEUT,
+    HANGUL_LETTER_RIEUL,
+    HANGUL_LETTER_MIEUM,
+    HANGUL_LETTER_PIEUP,
+    HANGUL_LETTER_SIOS,
+    HANGUL_LETTER_CHITUEUMSIOS,
+    HANGUL_LETTER_CEONGCHIEUMSIOS,
+    HANGUL_LETTER_PANSIOS,
+    HANGUL_LETTER_IEUNG,
+    HANGUL_LETTER_YESIEUNG,
+    HANGUL_LETTER_CIEUC,
+    HANGUL_LETTER_CHITUEUMCIEUC,
+    HANGUL_LETTER_CEONGCHIEUMCIEUC,
+    HANGUL_LETTER_CHIEUCH,
+    HANGUL_LETTER_CHITUEUMCHIEUCH,
+    HANGUL_LETTER_CEONGCHIEUMCHIEUCH,
+    HANGUL_LETTER_KHIEUKH,
+    HANGUL_LETTER_THIEUTH,
+    HANGUL_LETTER_PHIEUPH,
+    HANGUL_LETTER_HIEUH,
+    HANGUL_LETTER_YEORINHIEUH,
+    HANGUL_LETTER_A,
+    HANGUL_LETTER_AE,
+    HANGUL_LETTER_YA,
+    HANGUL_LETTER_YAE,
+    HANGUL_LETTER_EO,
+    HANGUL_LETTER_E,
+    HANGUL_LETTER_YEO,
+    HANGUL_LETTER_YE,
+    HANGUL_LETTER_O,
+    HANGUL_LETTER_YO,
+    HANGUL_LETTER_U,
+    HANGUL_LETTER_YU,
+    HANGUL_LETTER_EU,
+    HANGUL_LETTER_I,
+    HANGUL_LETTER_ARAEA,
+};
+
+/* U+1100-U+11FF, U+A960-U+A97C, U+D7B0-U+D7FB 자모를 이루는 기본 글자.
+ * 겹자모는 기본 글자를 순서대로 늘어놓은 것으로 보고, 가벼운 소리(ㅸ 등)는
+ * 아래에 붙은 ㅇ을 뒤에 붙인다. 현대 한글 자모는 이렇게 나누어도 코드 순서와
+ * 정렬 순서가 같다. */
+static const unsigned char hangul_jamo_letters[][3] = {
+	{ HANGUL_LETTER_KIYEOK },                                                /* 0x1100 */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_KIYEOK },                          /* 0x1101 */
+	{ HANGUL_LETTER_NIEUN },                                                 /* 0x1102 */
+	{ HANGUL_LETTER_TIKEUT },                                                /* 0x1103 */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_TIKEUT },                          /* 0x1104 */
+	{ HANGUL_LETTER_RIEUL },                                                 /* 0x1105 */
+	{ HANGUL_LETTER_MIEUM },                                                 /* 0x1106 */
+	{ HANGUL_LETTER_PIEUP },                                                 /* 0x1107 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_PIEUP },                            /* 0x1108 */
+	{ HANGUL_LETTER_SIOS },                                                  /* 0x1109 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_SIOS },                              /* 0x110a */
+	{ HANGUL_LETTER_IEUNG },                                                 /* 0x110b */
+	{ HANGUL_LETTER_CIEUC },                                                 /* 0x110c */
+	{ HANGUL_LETTER_CIEUC, HANGUL_LETTER_CIEUC },                            /* 0x110d */
+	{ HANGUL_LETTER_CHIEUCH },                                               /* 0x110e */
+	{ HANGUL_LETTER_KHIEUKH },                                               /* 0x110f */
+	{ HANGUL_LETTER_THIEUTH },                                               /* 0x1110 */
+	{ HANGUL_LETTER_PHIEUPH },                                               /* 0x1111 */
+	{ HANGUL_LETTER_HIEUH },                                                 /* 0x1112 */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_KIYEOK },                           /* 0x1113 */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_NIEUN },                            /* 0x1114 */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_TIKEUT },                           /* 0x1115 */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_PIEUP },                            /* 0x1116 */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_KIYEOK },                          /* 0x1117 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_NIEUN },                            /* 0x1118 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_RIEUL },                            /* 0x1119 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_HIEUH },                            /* 0x111a */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_IEUNG },                            /* 0x111b */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_PIEUP },                            /* 0x111c */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_IEUNG },                            /* 0x111d */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_KIYEOK },                           /* 0x111e */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_NIEUN },                            /* 0x111f */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_TIKEUT },                           /* 0x1120 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS },                             /* 0x1121 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS, HANGUL_LETTER_KIYEOK },       /* 0x1122 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS, HANGUL_LETTER_TIKEUT },       /* 0x1123 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS, HANGUL_LETTER_PIEUP },        /* 0x1124 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS, HANGUL_LETTER_SIOS },         /* 0x1125 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS, HANGUL_LETTER_CIEUC },        /* 0x1126 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_CIEUC },                            /* 0x1127 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_CHIEUCH },                          /* 0x1128 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_THIEUTH },                          /* 0x1129 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_PHIEUPH },                          /* 0x112a */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_IEUNG },                            /* 0x112b */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_PIEUP, HANGUL_LETTER_IEUNG },       /* 0x112c */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_KIYEOK },                            /* 0x112d */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_NIEUN },                             /* 0x112e */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_TIKEUT },                            /* 0x112f */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_RIEUL },                             /* 0x1130 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_MIEUM },                             /* 0x1131 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_PIEUP },                             /* 0x1132 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_PIEUP, HANGUL_LETTER_KIYEOK },       /* 0x1133 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_SIOS, HANGUL_LETTER_SIOS },          /* 0x1134 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_IEUNG },                             /* 0x1135 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_CIEUC },                             /* 0x1136 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_CHIEUCH },                           /* 0x1137 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_KHIEUKH },                           /* 0x1138 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_THIEUTH },                           /* 0x1139 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_PHIEUPH },                           /* 0x113a */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_HIEUH },                             /* 0x113b */
+	{ HANGUL_LETTER_CHITUEUMSIOS },                                          /* 0x113c */
+	{ HANGUL_LETTER_CHITUEUMSIOS, HANGUL_LETTER_SIOS },                      /* 0x113d */
+	{ HANGUL_LETTER_CEONGCHIEUMSIOS },                                       /* 0x113e */
+	{ HANGUL_LETTER_CEONGCHIEUMSIOS, HANGUL_LETTER_SIOS },                   /* 0x113f */
+	{ HANGUL_LETTER_PANSIOS },                                               /* 0x1140 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_KIYEOK },                           /* 0x1141 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_TIKEUT },                           /* 0x1142 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_MIEUM },                            /* 0x1143 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_PIEUP },                            /* 0x1144 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_SIOS },                             /* 0x1145 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_PANSIOS },                          /* 0x1146 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_IEUNG },                            /* 0x1147 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_CIEUC },                            /* 0x1148 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_CHIEUCH },                          /* 0x1149 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_THIEUTH },                          /* 0x114a */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_PHIEUPH },                          /* 0x114b */
+	{ HANGUL_LETTER_YESIEUNG },                                              /* 0x114c */
+	{ HANGUL_LETTER_CIEUC, HANGUL_LETTER_IEUNG },                            /* 0x114d */
+	{ HANGUL_LETTER_CHITUEUMCIEUC },                                         /* 0x114e */
+	{ HANGUL_LETTER_CHITUEUMCIEUC, HANGUL_LETTER_CIEUC },                    /* 0x114f */
+	{ HANGUL_LETTER_CEONGCHIEUMCIEUC },                                      /* 0x1150 */
+	{ HANGUL_LETTER_CEONGCHIEUMCIEUC, HANGUL_LETTER_CIEUC },                 /* 0x1151 */
+	{ HANGUL_LETTER_CHIEUCH, HANGUL_LETTER_KHIEUKH },                        /* 0x1152 */
+	{ HANGUL_LETTER_CHIEUCH, HANGUL_LETTER_HIEUH },                          /* 0x1153 */
+	{ HANGUL_LETTER_CHITUEUMCHIEUCH },                                       /* 0x1154 */
+	{ HANGUL_LETTER_CEONGCHIEUMCHIEUCH },                                    /* 0x1155 */
+	{ HANGUL_LETTER_PHIEUPH, HANGUL_LETTER_PIEUP },                          /* 0x1156 */
+	{ HANGUL_LETTER_PHIEUPH, HANGUL_LETTER_IEUNG },                          /* 0x1157 */
+	{ HANGUL_LETTER_HIEUH, HANGUL_LETTER_HIEUH },                            /* 0x1158 */
+	{ HANGUL_LETTER_YEORINHIEUH },                                           /* 0x1159 */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_TIKEUT },                          /* 0x115a */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_SIOS },                             /* 0x115b */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_CIEUC },                            /* 0x115c */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_HIEUH },                            /* 0x115d */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_RIEUL },                           /* 0x115e */
+	{ 0 },                                                                   /* 0x115f */
+	{ 0 },                                                                   /* 0x1160 */
+	{ HANGUL_LETTER_A },                                                     /* 0x1161 */
+	{ HANGUL_LETTER_AE },                                                    /* 0x1162 */
+	{ HANGUL_LETTER_YA },                                                    /* 0x1163 */
+	{ HANGUL_LETTER_YAE },                                                   /* 0x1164 */
+	{ HANGUL_LETTER_EO },                                                    /* 0x1165 */
+	{ HANGUL_LETTER_E },                                                     /* 0x1166 */
+	{ HANGUL_LETTER_YEO },                                                   /* 0x1167 */
+	{ HANGUL_LETTER_YE },                                                    /* 0x1168 */
+	{ HANGUL_LETTER_O },                                                     /* 0x1169 */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_A },                                    /* 0x116a */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_AE },                                   /* 0x116b */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_I },                                    /* 0x116c */
+	{ HANGUL_LETTER_YO },                                                    /* 0x116d */
+	{ HANGUL_LETTER_U },                                                     /* 0x116e */
+	{ HANGUL_LETTER_U, HANGUL_LETTER_EO },                                   /* 0x116f */
+	{ HANGUL_LETTER_U, HANGUL_LETTER_E },                                    /* 0x1170 */
+	{ HANGUL_LETTER_U, HANGUL_LETTER_I },                                    /* 0x1171 */
+	{ HANGUL_LETTER_YU },                                                    /* 0x1172 */
+	{ HANGUL_LETTER_EU },                                                    /* 0x1173 */
+	{ HANGUL_LETTER_EU, HANGUL_LETTER_I },                                   /* 0x1174 */
+	{ HANGUL_LETTER_I },                                                     /* 0x1175 */
+	{ HANGUL_LETTER_A, HANGUL_LETTER_O },                                    /* 0x1176 */
+	{ HANGUL_LETTER_A, HANGUL_LETTER_U },                                    /* 0x1177 */
+	{ HANGUL_LETTER_YA, HANGUL_LETTER_O },                                   /* 0x1178 */
+	{ HANGUL_LETTER_YA, HANGUL_LETTER_YO },                                  /* 0x1179 */
+	{ HANGUL_LETTER_EO, HANGUL_LETTER_O },                                   /* 0x117a */
+	{ HANGUL_LETTER_EO, HANGUL_LETTER_U },                                   /* 0x117b */
+	{ HANGUL_LETTER_EO, HANGUL_LETTER_EU },                                  /* 0x117c */
+	{ HANGUL_LETTER_YEO, HANGUL_LETTER_O },                                  /* 0x117d */
+	{ HANGUL_LETTER_YEO, HANGUL_LETTER_U },                                  /* 0x117e */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_EO },                                   /* 0x117f */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_E },                                    /* 0x1180 */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_YE },                                   /* 0x1181 */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_O },                                    /* 0x1182 */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_U },                                    /* 0x1183 */
+	{ HANGUL_LETTER_YO, HANGUL_LETTER_YA },                                  /* 0x1184 */
+	{ HANGUL_LETTER_YO, HANGUL_LETTER_YAE },                                 /* 0x1185 */
+	{ HANGUL_LETTER_YO, HANGUL_LETTER_YEO },                                 /* 0x1186 */
+	{ HANGUL_LETTER_YO, HANGUL_LETTER_O },                                   /* 0x1187 */
+	{ HANGUL_LETTER_YO, HANGUL_LETTER_I },                                   /* 0x1188 */
+	{ HANGUL_LETTER_U, HANGUL_LETTER_A },                                    /* 0x1189 */
+	{ HANGUL_LETTER_U, HANGUL_LETTER_AE },                                   /* 0x118a */
+	{ HANGUL_LETTER_U, HANGUL_LETTER_EO, HANGUL_LETTER_EU },                 /* 0x118b */
+	{ HANGUL_LETTER_U, HANGUL_LETTER_YE },                                   /* 0x118c */
+	{ HANGUL_LETTER_U, HANGUL_LETTER_U },                                    /* 0x118d */
+	{ HANGUL_LETTER_YU, HANGUL_LETTER_A },                                   /* 0x118e */
+	{ HANGUL_LETTER_YU, HANGUL_LETTER_EO },                                  /* 0x118f */
+	{ HANGUL_LETTER_YU, HANGUL_LETTER_E },                                   /* 0x1190 */
+	{ HANGUL_LETTER_YU, HANGUL_LETTER_YEO },                                 /* 0x1191 */
+	{ HANGUL_LETTER_YU, HANGUL_LETTER_YE },                                  /* 0x1192 */
+	{ HANGUL_LETTER_YU, HANGUL_LETTER_U },                                   /* 0x1193 */
+	{ HANGUL_LETTER_YU, HANGUL_LETTER_I },                                   /* 0x1194 */
+	{ HANGUL_LETTER_EU, HANGUL_LETTER_U },                                   /* 0x1195 */
+	{ HANGUL_LETTER_EU, HANGUL_LETTER_EU },                                  /* 0x1196 */
+	{ HANGUL_LETTER_EU, HANGUL_LETTER_I, HANGUL_LETTER_U },                  /* 0x1197 */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_A },                                    /* 0x1198 */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_YA },                                   /* 0x1199 */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_O },                                    /* 0x119a */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_U },                                    /* 0x119b */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_EU },                                   /* 0x119c */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_ARAEA },                                /* 0x119d */
+	{ HANGUL_LETTER_ARAEA },                                                 /* 0x119e */
+	{ HANGUL_LETTER_ARAEA, HANGUL_LETTER_EO },                               /* 0x119f */
+	{ HANGUL_LETTER_ARAEA, HANGUL_LETTER_U },                                /* 0x11a0 */
+	{ HANGUL_LETTER_ARAEA, HANGUL_LETTER_I },                                /* 0x11a1 */
+	{ HANGUL_LETTER_ARAEA, HANGUL_LETTER_ARAEA },                            /* 0x11a2 */
+	{ HANGUL_LETTER_A, HANGUL_LETTER_EU },                                   /* 0x11a3 */
+	{ HANGUL_LETTER_YA, HANGUL_LETTER_U },                                   /* 0x11a4 */
+	{ HANGUL_LETTER_YEO, HANGUL_LETTER_YA },                                 /* 0x11a5 */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_YA },                                   /* 0x11a6 */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_YAE },                                  /* 0x11a7 */
+	{ HANGUL_LETTER_KIYEOK },                                                /* 0x11a8 */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_KIYEOK },                          /* 0x11a9 */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_SIOS },                            /* 0x11aa */
+	{ HANGUL_LETTER_NIEUN },                                                 /* 0x11ab */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_CIEUC },                            /* 0x11ac */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_HIEUH },                            /* 0x11ad */
+	{ HANGUL_LETTER_TIKEUT },                                                /* 0x11ae */
+	{ HANGUL_LETTER_RIEUL },                                                 /* 0x11af */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_KIYEOK },                           /* 0x11b0 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_MIEUM },                            /* 0x11b1 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PIEUP },                            /* 0x11b2 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_SIOS },                             /* 0x11b3 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_THIEUTH },                          /* 0x11b4 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PHIEUPH },                          /* 0x11b5 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_HIEUH },                            /* 0x11b6 */
+	{ HANGUL_LETTER_MIEUM },                                                 /* 0x11b7 */
+	{ HANGUL_LETTER_PIEUP },                                                 /* 0x11b8 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS },                             /* 0x11b9 */
+	{ HANGUL_LETTER_SIOS },                                                  /* 0x11ba */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_SIOS },                              /* 0x11bb */
+	{ HANGUL_LETTER_IEUNG },                                                 /* 0x11bc */
+	{ HANGUL_LETTER_CIEUC },                                                 /* 0x11bd */
+	{ HANGUL_LETTER_CHIEUCH },                                               /* 0x11be */
+	{ HANGUL_LETTER_KHIEUKH },                                               /* 0x11bf */
+	{ HANGUL_LETTER_THIEUTH },                                               /* 0x11c0 */
+	{ HANGUL_LETTER_PHIEUPH },                                               /* 0x11c1 */
+	{ HANGUL_LETTER_HIEUH },                                                 /* 0x11c2 */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_RIEUL },                           /* 0x11c3 */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_SIOS, HANGUL_LETTER_KIYEOK },      /* 0x11c4 */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_KIYEOK },                           /* 0x11c5 */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_TIKEUT },                           /* 0x11c6 */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_SIOS },                             /* 0x11c7 */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_PANSIOS },                          /* 0x11c8 */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_THIEUTH },                          /* 0x11c9 */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_KIYEOK },                          /* 0x11ca */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_RIEUL },                           /* 0x11cb */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_KIYEOK, HANGUL_LETTER_SIOS },       /* 0x11cc */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_NIEUN },                            /* 0x11cd */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_TIKEUT },                           /* 0x11ce */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_TIKEUT, HANGUL_LETTER_HIEUH },      /* 0x11cf */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_RIEUL },                            /* 0x11d0 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_MIEUM, HANGUL_LETTER_KIYEOK },      /* 0x11d1 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_MIEUM, HANGUL_LETTER_SIOS },        /* 0x11d2 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS },        /* 0x11d3 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PIEUP, HANGUL_LETTER_HIEUH },       /* 0x11d4 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PIEUP, HANGUL_LETTER_IEUNG },       /* 0x11d5 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_SIOS, HANGUL_LETTER_SIOS },         /* 0x11d6 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PANSIOS },                          /* 0x11d7 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_KHIEUKH },                          /* 0x11d8 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_YEORINHIEUH },                      /* 0x11d9 */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_KIYEOK },                           /* 0x11da */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_RIEUL },                            /* 0x11db */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_PIEUP },                            /* 0x11dc */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_SIOS },                             /* 0x11dd */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_SIOS, HANGUL_LETTER_SIOS },         /* 0x11de */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_PANSIOS },                          /* 0x11df */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_CHIEUCH },                          /* 0x11e0 */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_HIEUH },                            /* 0x11e1 */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_IEUNG },                            /* 0x11e2 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_RIEUL },                            /* 0x11e3 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_PHIEUPH },                          /* 0x11e4 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_HIEUH },                            /* 0x11e5 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_IEUNG },                            /* 0x11e6 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_KIYEOK },                            /* 0x11e7 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_TIKEUT },                            /* 0x11e8 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_RIEUL },                             /* 0x11e9 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_PIEUP },                             /* 0x11ea */
+	{ HANGUL_LETTER_PANSIOS },                                               /* 0x11eb */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_KIYEOK },                           /* 0x11ec */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_KIYEOK, HANGUL_LETTER_KIYEOK },     /* 0x11ed */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_IEUNG },                            /* 0x11ee */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_KHIEUKH },                          /* 0x11ef */
+	{ HANGUL_LETTER_YESIEUNG },                                              /* 0x11f0 */
+	{ HANGUL_LETTER_YESIEUNG, HANGUL_LETTER_SIOS },                          /* 0x11f1 */
+	{ HANGUL_LETTER_YESIEUNG, HANGUL_LETTER_PANSIOS },                       /* 0x11f2 */
+	{ HANGUL_LETTER_PHIEUPH, HANGUL_LETTER_PIEUP },                          /* 0x11f3 */
+	{ HANGUL_LETTER_PHIEUPH, HANGUL_LETTER_IEUNG },                          /* 0x11f4 */
+	{ HANGUL_LETTER_HIEUH, HANGUL_LETTER_NIEUN },                            /* 0x11f5 */
+	{ HANGUL_LETTER_HIEUH, HANGUL_LETTER_RIEUL },                            /* 0x11f6 */
+	{ HANGUL_LETTER_HIEUH, HANGUL_LETTER_MIEUM },                            /* 0x11f7 */
+	{ HANGUL_LETTER_HIEUH, HANGUL_LETTER_PIEUP },                            /* 0x11f8 */
+	{ HANGUL_LETTER_YEORINHIEUH },                                           /* 0x11f9 */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_NIEUN },                           /* 0x11fa */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_PIEUP },                           /* 0x11fb */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_CHIEUCH },                         /* 0x11fc */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_KHIEUKH },                         /* 0x11fd */
+	{ HANGUL_LETTER_KIYEOK, HANGUL_LETTER_HIEUH },                           /* 0x11fe */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_NIEUN },                            /* 0x11ff */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_MIEUM },                           /* 0xa960 */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_PIEUP },                           /* 0xa961 */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_SIOS },                            /* 0xa962 */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_CIEUC },                           /* 0xa963 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_KIYEOK },                           /* 0xa964 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_KIYEOK, HANGUL_LETTER_KIYEOK },     /* 0xa965 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_TIKEUT },                           /* 0xa966 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_TIKEUT, HANGUL_LETTER_TIKEUT },     /* 0xa967 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_MIEUM },                            /* 0xa968 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PIEUP },                            /* 0xa969 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PIEUP, HANGUL_LETTER_PIEUP },       /* 0xa96a */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PIEUP, HANGUL_LETTER_IEUNG },       /* 0xa96b */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_SIOS },                             /* 0xa96c */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_CIEUC },                            /* 0xa96d */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_KHIEUKH },                          /* 0xa96e */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_KIYEOK },                           /* 0xa96f */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_TIKEUT },                           /* 0xa970 */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_SIOS },                             /* 0xa971 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS, HANGUL_LETTER_THIEUTH },      /* 0xa972 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_KHIEUKH },                          /* 0xa973 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_HIEUH },                            /* 0xa974 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_SIOS, HANGUL_LETTER_PIEUP },         /* 0xa975 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_RIEUL },                            /* 0xa976 */
+	{ HANGUL_LETTER_IEUNG, HANGUL_LETTER_HIEUH },                            /* 0xa977 */
+	{ HANGUL_LETTER_CIEUC, HANGUL_LETTER_CIEUC, HANGUL_LETTER_HIEUH },       /* 0xa978 */
+	{ HANGUL_LETTER_THIEUTH, HANGUL_LETTER_THIEUTH },                        /* 0xa979 */
+	{ HANGUL_LETTER_PHIEUPH, HANGUL_LETTER_HIEUH },                          /* 0xa97a */
+	{ HANGUL_LETTER_HIEUH, HANGUL_LETTER_SIOS },                             /* 0xa97b */
+	{ HANGUL_LETTER_YEORINHIEUH, HANGUL_LETTER_YEORINHIEUH },                /* 0xa97c */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_YEO },                                  /* 0xd7b0 */
+	{ HANGUL_LETTER_O, HANGUL_LETTER_O, HANGUL_LETTER_I },                   /* 0xd7b1 */
+	{ HANGUL_LETTER_YO, HANGUL_LETTER_A },                                   /* 0xd7b2 */
+	{ HANGUL_LETTER_YO, HANGUL_LETTER_AE },                                  /* 0xd7b3 */
+	{ HANGUL_LETTER_YO, HANGUL_LETTER_EO },                                  /* 0xd7b4 */
+	{ HANGUL_LETTER_U, HANGUL_LETTER_YEO },                                  /* 0xd7b5 */
+	{ HANGUL_LETTER_U, HANGUL_LETTER_I, HANGUL_LETTER_I },                   /* 0xd7b6 */
+	{ HANGUL_LETTER_YU, HANGUL_LETTER_AE },                                  /* 0xd7b7 */
+	{ HANGUL_LETTER_YU, HANGUL_LETTER_O },                                   /* 0xd7b8 */
+	{ HANGUL_LETTER_EU, HANGUL_LETTER_A },                                   /* 0xd7b9 */
+	{ HANGUL_LETTER_EU, HANGUL_LETTER_EO },                                  /* 0xd7ba */
+	{ HANGUL_LETTER_EU, HANGUL_LETTER_E },                                   /* 0xd7bb */
+	{ HANGUL_LETTER_EU, HANGUL_LETTER_O },                                   /* 0xd7bc */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_YA, HANGUL_LETTER_O },                  /* 0xd7bd */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_YAE },                                  /* 0xd7be */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_YEO },                                  /* 0xd7bf */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_YE },                                   /* 0xd7c0 */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_O, HANGUL_LETTER_I },                   /* 0xd7c1 */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_YO },                                   /* 0xd7c2 */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_YU },                                   /* 0xd7c3 */
+	{ HANGUL_LETTER_I, HANGUL_LETTER_I },                                    /* 0xd7c4 */
+	{ HANGUL_LETTER_ARAEA, HANGUL_LETTER_A },                                /* 0xd7c5 */
+	{ HANGUL_LETTER_ARAEA, HANGUL_LETTER_E },                                /* 0xd7c6 */
+	{ 0 },                                                                   /* 0xd7c7 */
+	{ 0 },                                                                   /* 0xd7c8 */
+	{ 0 },                                                                   /* 0xd7c9 */
+	{ 0 },                                                                   /* 0xd7ca */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_RIEUL },                            /* 0xd7cb */
+	{ HANGUL_LETTER_NIEUN, HANGUL_LETTER_CHIEUCH },                          /* 0xd7cc */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_TIKEUT },                          /* 0xd7cd */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_TIKEUT, HANGUL_LETTER_PIEUP },     /* 0xd7ce */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_PIEUP },                           /* 0xd7cf */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_SIOS },                            /* 0xd7d0 */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_SIOS, HANGUL_LETTER_KIYEOK },      /* 0xd7d1 */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_CIEUC },                           /* 0xd7d2 */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_CHIEUCH },                         /* 0xd7d3 */
+	{ HANGUL_LETTER_TIKEUT, HANGUL_LETTER_THIEUTH },                         /* 0xd7d4 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_KIYEOK, HANGUL_LETTER_KIYEOK },     /* 0xd7d5 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_KIYEOK, HANGUL_LETTER_HIEUH },      /* 0xd7d6 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_RIEUL, HANGUL_LETTER_KHIEUKH },     /* 0xd7d7 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_MIEUM, HANGUL_LETTER_HIEUH },       /* 0xd7d8 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PIEUP, HANGUL_LETTER_TIKEUT },      /* 0xd7d9 */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_PIEUP, HANGUL_LETTER_PHIEUPH },     /* 0xd7da */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_YESIEUNG },                         /* 0xd7db */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_YEORINHIEUH, HANGUL_LETTER_HIEUH }, /* 0xd7dc */
+	{ HANGUL_LETTER_RIEUL, HANGUL_LETTER_IEUNG },                            /* 0xd7dd */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_NIEUN },                            /* 0xd7de */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_NIEUN, HANGUL_LETTER_NIEUN },       /* 0xd7df */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_MIEUM },                            /* 0xd7e0 */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS },        /* 0xd7e1 */
+	{ HANGUL_LETTER_MIEUM, HANGUL_LETTER_CIEUC },                            /* 0xd7e2 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_TIKEUT },                           /* 0xd7e3 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_RIEUL, HANGUL_LETTER_PHIEUPH },     /* 0xd7e4 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_MIEUM },                            /* 0xd7e5 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_PIEUP },                            /* 0xd7e6 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_SIOS, HANGUL_LETTER_TIKEUT },       /* 0xd7e7 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_CIEUC },                            /* 0xd7e8 */
+	{ HANGUL_LETTER_PIEUP, HANGUL_LETTER_CHIEUCH },                          /* 0xd7e9 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_MIEUM },                             /* 0xd7ea */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_PIEUP, HANGUL_LETTER_IEUNG },        /* 0xd7eb */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_SIOS, HANGUL_LETTER_KIYEOK },        /* 0xd7ec */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_SIOS, HANGUL_LETTER_TIKEUT },        /* 0xd7ed */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_PANSIOS },                           /* 0xd7ee */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_CIEUC },                             /* 0xd7ef */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_CHIEUCH },                           /* 0xd7f0 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_THIEUTH },                           /* 0xd7f1 */
+	{ HANGUL_LETTER_SIOS, HANGUL_LETTER_HIEUH },                             /* 0xd7f2 */
+	{ HANGUL_LETTER_PANSIOS, HANGUL_LETTER_PIEUP },                          /* 0xd7f3 */
+	{ HANGUL_LETTER_PANSIOS, HANGUL_LETTER_PIEUP, HANGUL_LETTER_IEUNG },     /* 0xd7f4 */
+	{ HANGUL_LETTER_YESIEUNG, HANGUL_LETTER_MIEUM },                         /* 0xd7f5 */
+	{ HANGUL_LETTER_YESIEUNG, HANGUL_LETTER_HIEUH },                         /* 0xd7f6 */
+	{ HANGUL_LETTER_CIEUC, HANGUL_LETTER_PIEUP },                            /* 0xd7f7 */
+	{ HANGUL_LETTER_CIEUC, HANGUL_LETTER_PIEUP, HANGUL_LETTER_PIEUP },       /* 0xd7f8 */
+	{ HANGUL_LETTER_CIEUC, HANGUL_LETTER_CIEUC },                            /* 0xd7f9 */
+	{ HANGUL_LETTER_PHIEUPH, HANGUL_LETTER_SIOS },                           /* 0xd7fa */
+	{ HANGUL_LETTER_PHIEUPH, HANGUL_LETTER_THIEUTH },                        /* 0xd7fb */
+};
+
+static const unsigned char*
+hangul_jamo_get_letters(ucschar c)
+{
+    if (c >= 0x1100 && c <= 0x11ff)
+	return hangul_jamo_letters[c - 0x1100];
+    if (c >= 0xa960 && c <= 0xa97c)
+	return hangul_jamo_letters[c - 0xa960 + 0x100];
+    if (c >= 0xd7b0 && c <= 0xd7fb)
+	return hangul_jamo_letters[c - 0xd7b0 + 0x100 + 0x1d];
+    return NULL;
+}
+
+/* 정렬 키의 단위를 시작하는 값. 한글은 U+AC00 자리에 정렬한다. */
+enum {
+    HANGUL_SORT_KEY_SEPARATOR	 = 1,	/* 초성, 중성, 종성의 끝 */
+    HANGUL_SORT_KEY_BEFORE_HANGUL = 1,
+    HANGUL_SORT_KEY_HANGUL	 = 2,
+    HANGUL_SORT_KEY_AFTER_HANGUL  = 3
+};
+
+typedef struct _HangulSortKey {
+    char* dest;
+    int destlen;
+    int len;
+    int part;	    /* 쓰고 있는 음절의 부분. 0: 초성, 1: 중성, 2: 종성, -1: 없음 */
+} HangulSortKey;
+
+static inline void
+sort_key_put(HangulSortKey* key, unsigned char b)
+{
+    if (key->dest != NULL && key->len < key->destlen)
+	key->dest[key->len] = (char)b;
+    key->len++;
+}
+
+static void
+sort_key_put_letters(HangulSortKey* key, const unsigned char* letters)
+{
+    int i;
+    for (i = 0; i < 3 && letters[i] != 0; i++)
+	sort_key_put(key, letters[i]);
+}
+
+static void
+sort_key_begin_syllable(HangulSortKey* key)
+{
+    sort_key_put(key, HANGUL_SORT_KEY_HANGUL);
+    key->part = 0;
+}
+
+/* 지금 쓰고 있는 음절을 part 부분까지 끝낸다 */
+static void
+sort_key_end_part(HangulSortKey* key, int part)
+{
+    while (key->part >= 0 && key->part < part) {
+	sort_key_put(key, HANGUL_SORT_KEY_SEPARATOR);
+	key->part++;
+    }
+    if (key->part >= 3)
+	key->part = -1;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief 정렬에 쓰는 키를 만드는 함수
+ * @param dest 키를 저장할 버퍼
+ * @param destlen @a dest 의 길이(byte 단위)
+ * @param src 키를 만들 UCS4 스트링
+ * @param srclen @a src 의 길이(ucschar 코드 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @return 키의 길이(byte 단위)
+ *
+ * 이 함수는 두 스트링의 키를 memcmp()로 비교한 결과가 자모 순서로 비교한
+ * 결과와 같도록 @a src 의 정렬 키를 만든다. 키가 같은 길이까지 같으면 짧은
+ * 쪽이 앞선다. 매번 음절을 자모로 분해하여 비교하는 대신 미리 키를 만들어
+ * 두면 정렬이나 색인을 빠르게 할 수 있다.
+ *
+ * 음절은 초성, 중성, 종성의 순서로 비교하고, 종성이 없는 음절은 종성이
+ * 있는 음절보다 앞선다. 완성형 음절과 같은 음절을 나타내는 첫가끝 자모
+ * 스트링은 같은 키가 된다. 옛한글 자모는 자모를 이루는 기본 글자로 나누어
+ * 비교하므로 ㄱ, ㄲ, ꥠ(ㄱㄷ), ㄴ과 같은 순서가 된다. 한글이 아닌 글자는
+ * 코드 순서로 비교하고 한글은 U+AC00 자리에 온다.
+ *
+ * @a dest 가 NULL이면 키의 길이만 리턴한다. @a dest 가 모자라면 들어가는
+ * 만큼만 저장하고 전체 키의 길이를 리턴한다. 키에는 0이 없으므로 끝에 0을
+ * 붙이면 strcmp()로 비교할 수도 있다.
+ */
+int
+hangul_sort_key(char* dest, int destlen, const ucschar* src, int srclen)
+{
+    HangulSortKey key = { dest, destlen, 0, -1 };
+    ucschar prev = 0;
+    int i;
+
+    if (src == NULL)
+	return 0;
+
+    if (srclen < 0) {
+	srclen = 0;
+	while (src[srclen] != 0)
+	    srclen++;
+    }
+
+    for (i = 0; i < srclen; i++) {
+	ucschar c = src[i];
+	unsigned type = hangul_ctype(c);
+
+	if (type & (HANGUL_CTYPE_LV | HANGUL_CTYPE_LVT)) {
+	    ucschar cho, jung, jong;
+
+	    sort_key_end_part(&key, 3);
+	    sort_key_begin_syllable(&key);
+
+	    hangul_syllable_to_jamo(c, &cho, &jung, &jong);
+	    sort_key_put_letters(&key, hangul_jamo_get_letters(cho));
+	    sort_key_end_part(&key, 1);
+	    sort_key_put_letters(&key, hangul_jamo_get_letters(jung));
+	    if (jong != 0) {
+		sort_key_end_part(&key, 2);
+		sort_key_put_letters(&key, hangul_jamo_get_letters(jong));
+	    }
+	} else if (type & (HANGUL_CTYPE_L | HANGUL_CTYPE_V | HANGUL_CTYPE_T)) {
+	    int part = (type & HANGUL_CTYPE_L) ? 0 :
+		       (type & HANGUL_CTYPE_V) ? 1 : 2;
+
+	    if (key.part < 0 || key.part > part ||
+		is_syllable_boundary(prev, c)) {
+		sort_key_end_part(&key, 3);
+		sort_key_begin_syllable(&key);
+	    }
+
+	    sort_key_end_part(&key, part);
+	    sort_key_put_letters(&key, hangul_jamo_get_letters(c));
+	} else {
+	    sort_key_end_part(&key, 3);
+	    sort_key_put(&key, c < 0xac00 ? HANGUL_SORT_KEY_BEFORE_HANGUL :
+					    HANGUL_SORT_KEY_AFTER_HANGUL);
+	    sort_key_put(&key, 0x80 | ((c >> 14) & 0x7f));
+	    sort_key_put(&key, 0x80 | ((c >> 7) & 0x7f));
+	    sort_key_put(&key, 0x80 | (c & 0x7f));
+	}
+
+	prev = c;
+    }
+
+    sort_key_end_part(&key, 3);
+
+    return key.len;
+}
+
+/* 근사 검색에서 비트 병렬로 비교할 수 있는 패턴의 최대 자모 수 */
+#define HANGUL_FUZZY_PATTERN_MAX 64
+
+struct _HangulFuzzyMatcher {
+    uint64_t  peq[0x100];	/* U+1100-U+11FF 자모가 패턴의 어디에 있는지 */
+    ucschar   other[HANGUL_FUZZY_PATTERN_MAX];
+    uint64_t  other_peq[HANGUL_FUZZY_PATTERN_MAX];
+    int       nother;
+    int       m;		/* 패턴의 자모 수 */
+    int       max_distance;
+
+    /* 바로 전에 비교한 스트링의 자모와 자모마다 비교한 상태.
+     * pv, mv, score의 j 번째는 text의 앞 j 자모까지 비교한 상태다. */
+    ucschar*  text;
+    uint64_t* pv;
+    uint64_t* mv;
+    int*      score;
+    int       alloc;
+    int       nstates;		/* 앞에서부터 유효한 상태의 수 */
+    int       dead;		/* text의 앞 dead 자모가 같으면 매치하지 않는다 */
+};
+
+static inline uint64_t
+fuzzy_matcher_peq(const HangulFuzzyMatcher* matcher, ucschar c)
+{
+    int i;
+
+    if (c >= 0x1100 && c <= 0x11ff)
+	return matcher->peq[c - 0x1100];
+
+    for (i = 0; i < matcher->nother; i++) {
+	if (matcher->other[i] == c)
+	    return matcher->other_peq[i];
+    }
+
+    return 0;
+}
+
+static bool
+fuzzy_matcher_reserve(HangulFuzzyMatcher* matcher, int n)
+{
+    int alloc = matcher->alloc;
+    ucschar* text;
+    uint64_t* pv;
+    uint64_t* mv;
+    int* score;
+
+    if (n <= alloc)
+	return true;
+
+    while (alloc < n)
+	alloc *= 2;
+
+    text = realloc(matcher->text, sizeof(text[0]) * alloc);
+    if (text == NULL)
+	return false;
+    matcher->text = text;
+
+    pv = realloc(matcher->pv, sizeof(pv[0]) * (alloc + 1));
+    if (pv == NULL)
+	return false;
+    matcher->pv = pv;
+
+    mv = realloc(matcher->mv, sizeof(mv[0]) * (alloc + 1));
+    if (mv == NULL)
+	return false;
+    matcher->mv = mv;
+
+    score = realloc(matcher->score, sizeof(score[0]) * (alloc + 1));
+    if (score == NULL)
+	return false;
+    matcher->score = score;
+
+    matcher->alloc = alloc;
+    return true;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief 자모 단위로 근사 검색을 하는 오브젝트를 생성하는 함수
+ * @param pattern 찾을 스트링
+ * @param len @a pattern 의 길이(ucschar 코드 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @param max_distance 매치로 볼 최대 편집 거리
+ * @return 새로 생성된 HangulFuzzyMatcher 오브젝트, 실패하면 NULL
+ *
+ * 한글은 음절 하나에 자모가 여럿 있으므로 "한"과 "핸"처럼 모음 하나가
+ * 틀려도 음절 단위로는 완전히 다른 글자가 된다. 이 오브젝트는 음절을
+ * @ref hangul_syllables_to_jamos 와 같이 자모로 분해하여 자모 단위의 편집
+ * 거리(Levenshtein distance)로 스트링을 비교한다. 첫가끝 자모로 쓴 음절은
+ * 완성형 음절과 같게 취급한다.
+ *
+ * 패턴은 자모로 분해해서 최대 64 자모까지 쓸 수 있고, 그보다 길면 NULL을
+ * 리턴한다. 다 쓴 오브젝트는 @ref hangul_fuzzy_matcher_delete 로 지운다.
+ */
+HangulFuzzyMatcher*
+hangul_fuzzy_matcher_new(const ucschar* pattern, int len, int max_distance)
+{
+    HangulFuzzyMatcher* matcher;
+    ucschar jamos[HANGUL_FUZZY_PATTERN_MAX];
+    int i, j, m;
+
+    if (pattern == NULL || max_distance < 0)
+	return NULL;
+
+    m = hangul_syllables_to_jamos(NULL, 0, pattern, len);
+    if (m > HANGUL_FUZZY_PATTERN_MAX)
+	return NULL;
+    hangul_syllables_to_jamos(jamos, m, pattern, len);
+
+    matcher = calloc(1, sizeof(HangulFuzzyMatcher));
+    if (matcher == NULL)
+	return NULL;
+
+    for (i = 0; i < m; i++) {
+	ucschar c = jamos[i];
+	if (c >= 0x1100 && c <= 0x11ff) {
+	    matcher->peq[c - 0x1100] |= UINT64_C(1) << i;
+	} else {
+	    for (j = 0; j < matcher->nother; j++) {
+		if (matcher->other[j] == c)
+		    break;
+	    }
+	    if (j == matcher->nother) {
+		matcher->other[j] = c;
+		matcher->nother++;
+	    }
+	    matcher->other_peq[j] |= UINT64_C(1) << i;
+	}
+    }
+
+    matcher->m = m;
+    matcher->max_distance = max_distance;
+    matcher->alloc = 1;
+    matcher->text = malloc(sizeof(ucschar) * 1);
+    matcher->pv = malloc(sizeof(uint64_t) * 2);
+    matcher->mv = malloc(sizeof(uint64_t) * 2);
+    matcher->score = malloc(sizeof(int) * 2);
+    if (matcher->text == NULL || matcher->pv == NULL ||
+	matcher->mv == NULL || matcher->score == NULL) {
+	hangul_fuzzy_matcher_delete(matcher);
+	return NULL;
+    }
+
+    /* 빈 스트링과 비교한 상태 */
+    matcher->pv[0] = ~UINT64_C(0);
+    matcher->mv[0] = 0;
+    matcher->score[0] = m;
+    matcher->nstates = 1;
+    matcher->dead = INT_MAX;
+
+    return matcher;
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief UTF-8 스트링으로 HangulFuzzyMatcher 오브젝트를 생성하는 함수
+ * @param pattern 찾을 UTF-8 스트링
+ * @param len @a pattern 의 길이(byte 단위), -1이면 0으로 끝나는 스트링으로
+ *        본다
+ * @param max_distance 매치로 볼 최대 편집 거리
+ * @return 새로 생성된 HangulFuzzyMatcher 오브젝트, 실패하면 NULL
+ *
+ * @ref hangul_fuzzy_matcher_new 의 UTF-8 버전이다.
+ */
+HangulFuzzyMatcher*
+hangul_fuzzy_matcher_new_utf8(const char* pattern, int len, int max_distance)
+{
+    ucschar buf[HANGUL_FUZZY_PATTERN_MAX];
+    const unsigned char* s = (const unsigned char*)pattern;
+    const unsigned char* end;
+    int n = 0;
+
+    if (pattern == NULL)
+	return NULL;
+
+    if (len < 0)
+	len = strlen(pattern);
+    end = s + len;
+
+    /* 글자마다 자모가 하나 이상이므로 이보다 길면 쓸 수 없다 */
+    while (s < end) {
+	if (n >= HANGUL_FUZZY_PATTERN_MAX)
+	    return NULL;
+	s += hangul_utf8_decode(s, end, &buf[n++]);
+    }
+
+    return hangul_fuzzy_matcher_new(buf, n, max_distance);
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief HangulFuzzyMatcher 오브젝트를 삭제하는 함수
+ * @param matcher 삭제할 오브젝트
+ */
+void
+hangul_fuzzy_matcher_delete(HangulFuzzyMatcher* matcher)
+{
+    if (matcher == NULL)
+	return;
+
+    free(matcher->text);
+    free(matcher->pv);
+    free(matcher->mv);
+    free(matcher->score);
+    free(matcher);
+}
+
+/* matcher->text의 앞 n 자모를 비교한다. lcp는 바로 전에 비교한 스트링과
+ * 앞부분이 같은 자모의 수다.
+ * 패턴을 행, 스트링을 열로 하는 편집 거리 표의 한 열을 패턴의 자모마다
+ * 위 칸과의 차이(+1: pv, -1: mv)로 나타내어 64bit 연산 몇 번으로 다음 열을
+ * 구한다. (G. Myers, "A fast bit-vector algorithm for approximate string
+ * matching based on dynamic programming", 1999)
+ * 바로 전의 스트링과 같은 앞부분은 저장한 상태에서 이어서 비교하므로,
+ * 정렬된 낱말 목록을 차례로 비교하면 트라이를 따라가는 것과 같다. */
+static int
+fuzzy_matcher_run(HangulFuzzyMatcher* matcher, int n, int lcp)
+{
+    const int m = matcher->m;
+    const int max = matcher->max_distance;
+    const uint64_t high = m > 0 ? UINT64_C(1) << (m - 1) : 0;
+    int j;
+
+    if (matcher->dead <= lcp)
+	return -1;
+    matcher->dead = INT_MAX;
+
+    if (matcher->nstates > lcp + 1)
+	matcher->nstates = lcp + 1;
+
+    for (j = matcher->nstates - 1; j < n; j++) {
+	uint64_t pv = matcher->pv[j];
+	uint64_t mv = matcher->mv[j];
+	uint64_t eq = fuzzy_matcher_peq(matcher, matcher->text[j]);
+	uint64_t xv = eq | mv;
+	uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+	uint64_t ph = mv | ~(xh | pv);
+	uint64_t mh = pv & xh;
+	int score = matcher->score[j];
+	int d, i;
+
+	if (ph & high)
+	    score++;
+	else if (mh & high)
+	    score--;
+
+	/* 첫 행은 열마다 1씩 커진다 */
+	ph = (ph << 1) | 1;
+	mh = mh << 1;
+	pv = mh | ~(xv | ph);
+	mv = ph & xv;
+
+	matcher->pv[j + 1] = pv;
+	matcher->mv[j + 1] = mv;
+	matcher->score[j + 1] = m > 0 ? score : j + 1;
+	matcher->nstates = j + 2;
+
+	/* 이 열의 모든 값이 max보다 크면 뒤에 무엇이 와도 매치하지 않는다 */
+	d = j + 1;
+	for (i = 0; d > max && i < m; i++) {
+	    d += (int)((pv >> i) & 1) - (int)((mv >> i) & 1);
+	}
+	if (d > max) {
+	    matcher->dead = j + 1;
+	    return -1;
+	}
+    }
+
+    return matcher->score[n] <= max ? matcher->score[n] : -1;
+}
+
+/* text의 n 번째에 자모 c를 쓰고 lcp를 갱신한다 */
+static inline bool
+fuzzy_matcher_push(HangulFuzzyMatcher* matcher, ucschar c,
+		   int* n, int oldlen, int* lcp)
+{
+    if (*n >= matcher->alloc && !fuzzy_matcher_reserve(matcher, *n + 1))
+	return false;
+
+    if (*lcp < 0 && (*n >= oldlen || matcher->text[*n] != c))
+	*lcp = *n;
+
+    matcher->text[(*n)++] = c;
+    return true;
+}
+
+static bool
+fuzzy_matcher_push_char(HangulFuzzyMatcher* matcher, ucschar c,
+			int* n, int oldlen, int* lcp)
+{
+    if (hangul_is_syllable(c)) {
+	ucschar cho, jung, jong;
+	hangul_syllable_to_jamo(c, &cho, &jung, &jong);
+	if (!fuzzy_matcher_push(matcher, cho, n, oldlen, lcp) ||
+	    !fuzzy_matcher_push(matcher, jung, n, oldlen, lcp))
+	    return false;
+	if (jong != 0)
+	    return fuzzy_matcher_push(matcher, jong, n, oldlen, lcp);
+	return true;
+    }
+
+    return fuzzy_matcher_push(matcher, c, n, oldlen, lcp);
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief 스트링을 패턴과 자모 단위로 비교하는 함수
+ * @param matcher 사용할 HangulFuzzyMatcher 오브젝트
+ * @param str 비교할 스트링
+ * @param len @a str 의 길이(ucschar 코드 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @return 패턴과의 자모 단위 편집 거리, max_distance보다 크면 -1
+ *
+ * 오브젝트는 바로 전에 비교한 스트링을 기억하고 앞부분이 같은 곳까지는
+ * 다시 비교하지 않는다. 그리고 앞부분만으로도 max_distance를 넘게 되면
+ * 그 앞부분으로 시작하는 스트링은 더 비교하지 않고 -1을 리턴한다.
+ * 따라서 정렬된 낱말 목록을 차례로 비교하면 가장 빠르다.
+ */
+int
+hangul_fuzzy_matcher_match(HangulFuzzyMatcher* matcher,
+			   const ucschar* str, int len)
+{
+    int oldlen, n = 0, lcp = -1;
+    int i;
+
+    if (matcher == NULL || str == NULL)
+	return -1;
+
+    oldlen = matcher->nstates - 1;
+    if (matcher->dead != INT_MAX && matcher->dead > oldlen)
+	oldlen = matcher->dead;
+
+    for (i = 0; len < 0 ? str[i] != 0 : i < len; i++) {
+	if (!fuzzy_matcher_push_char(matcher, str[i], &n, oldlen, &lcp)) {
+	    matcher->nstates = 1;
+	    matcher->dead = INT_MAX;
+	    return -1;
+	}
+	/* 매치하지 않는 앞부분과 같으면 나머지는 읽지 않는다 */
+	if ((lcp < 0 ? n : lcp) >= matcher->dead)
+	    return -1;
+    }
+
+    if (lcp < 0)
+	lcp = n < oldlen ? n : oldlen;
+
+    return fuzzy_matcher_run(matcher, n, lcp);
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief UTF-8 스트링을 패턴과 자모 단위로 비교하는 함수
+ * @param matcher 사용할 HangulFuzzyMatcher 오브젝트
+ * @param str 비교할 UTF-8 스트링
+ * @param len @a str 의 길이(byte 단위), -1이면 0으로 끝나는 스트링으로 본다
+ * @return 패턴과의 자모 단위 편집 거리, max_distance보다 크면 -1
+ *
+ * @ref hangul_fuzzy_matcher_match 의 UTF-8 버전이다.
+ */
+int
+hangul_fuzzy_matcher_match_utf8(HangulFuzzyMatcher* matcher,
+				const char* str, int len)
+{
+    const unsigned char* s = (const unsigned char*)str;
+    const unsigned char* end;
+    int oldlen, n = 0, lcp = -1;
+
+    if (matcher == NULL || str == NULL)
+	return -1;
+
+    if (len < 0)
+	len = strlen(str);
+    end = s + len;
+
+    oldlen = matcher->nstates - 1;
+    if (matcher->dead != INT_MAX && matcher->dead > oldlen)
+	oldlen = matcher->dead;
+
+    while (s < end) {
+	ucschar c;
+	s += hangul_utf8_decode(s, end, &c);
+	if (!fuzzy_matcher_push_char(matcher, c, &n, oldlen, &lcp)) {
+	    matcher->nstates = 1;
+	    matcher->dead = INT_MAX;
+	    return -1;
+	}
+	/* 매치하지 않는 앞부분과 같으면 나머지는 읽지 않는다 */
+	if ((lcp < 0 ? n : lcp) >= matcher->dead)
+	    return -1;
+    }
+
+    if (lcp < 0)
+	lcp = n < oldlen ? n : oldlen;
+
+    return fuzzy_matcher_run(matcher, n, lcp);
+}
+
+/**
+ * @ingroup hangulctype
+ * @brief 두 스트링의 자모 단위 편집 거리를 구하는 함수
+ * @param a 비교할 스트링
+ * @param alen @a a 의 길이(ucschar 코드 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @param b 비교할 스트링
+ * @param blen @a b 의 길이(ucschar 코드 단위), -1이면 0으로 끝나는
+ *        스트링으로 본다
+ * @return 자모 단위 편집 거리, 메모리가 부족하면 -1
+ *
+ * 두 스트링의 음절을 자모로 분해하여 편집 거리를 구한다. 예를 들면 "한"과
+ * "핸"은 1, "한"과 "하"는 1이 된다. 같은 패턴으로 여러 스트링과 비교할
+ * 때에는 @ref hangul_fuzzy_matcher_new 를 사용한다.
+ */
+int
+hangul_jamo_distance(const ucschar* a, int alen, const ucschar* b, int blen)
+{
+    HangulFuzzyMatcher* matcher;
+    ucschar* x;
+    ucschar* y;
+    int* row;
+    int m, n, i, j, d;
+
+    if (a == NULL || b == NULL)
+	return -1;
+
+    m = hangul_syllables_to_jamos(NULL, 0, a, alen);
+    n = hangul_syllables_to_jamos(NULL, 0, b, blen);
+
+    /* 짧은 쪽을 패턴으로 한다 */
+    if (m <= HANGUL_FUZZY_PATTERN_MAX || n <= HANGUL_FUZZY_PATTERN_MAX) {
+	if (m <= n)
+	    matcher = hangul_fuzzy_matcher_new(a, alen, INT_MAX);
+	else
+	    matcher = hangul_fuzzy_matcher_new(b, blen, INT_MAX);
+	if (matcher == NULL)
+	    return -1;
+	d = m <= n ? hangul_fuzzy_matcher_match(matcher, b, blen)
+		   : hangul_fuzzy_matcher_match(matcher, a, alen);
+	hangul_fuzzy_matcher_delete(matcher);
+	return d;
+    }
+
+    /* 둘 다 길면 한 행씩 계산한다 */
+    x = malloc(sizeof(ucschar) * m);
+    y = malloc(sizeof(ucschar) * n);
+    row = malloc(sizeof(int) * (n + 1));
+    d = -1;
+    if (x != NULL && y != NULL && row != NULL) {
+	hangul_syllables_to_jamos(x, m, a, alen);
+	hangul_syllables_to_jamos(y, n, b, blen);
+
+	for (j = 0; j <= n; j++)
+	    row[j] = j;
+
+	for (i = 1; i <= m; i++) {
+	    int diag = row[0];
+	    row[0] = i;
+	    for (j = 1; j <= n; j++) {
+		int up = row[j];
+		int v = diag + (x[i - 1] != y[j - 1]);
+		if (up + 1 < v)
+		    v = up + 1;
+		if (row[j - 1] + 1 < v)
+		    v = row[j - 1] + 1;
+		row[j] = v;
+		diag = up;
+	    }
+	}
+	d = row[n];
+    }
+
+    free(x);
+    free(y);
+    free(row);
+    return d;
+}
@@ -23,7 +23,12 @@
 #include <string.h>
 #ifndef _WIN32
 #include <strings.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif /* HAVE_PTHREAD_H */
 #else
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
 #define strcasecmp _stricmp
 #endif
 #include <ctype.h>
@@ -187,6 +192,14 @@ typedef bool   (*HangulOnTransition) (HangulInputContext*,
 				      ucschar,
 				      const ucschar*,
 				      void*);
+typedef void   (*HangulOnCommit)     (HangulInputContext*,
+				      const ucschar*,
+				      int,
+				      void*);
+typedef void   (*HangulOnPreeditChanged) (HangulInputContext*,
+					  const ucschar*,
+					  int,
+					  void*);
 
 struct _HangulBuffer {
     ucschar choseong;
@@ -197,6 +210,65 @@ struct _HangulBuffer {
     int     index;
 };
 
+/* 조합 오토마타
+ *
+ * 자판과 조합 옵션, 출력 모드가 정해지면 키 하나를 처리한 결과는 조합
+ * 버퍼의 상태와 그 키가 변환된 글자만으로 결정된다. 그래서 버퍼의 상태를
+ * state로, 같은 글자로 변환되는 키들을 하나의 키 클래스로 보면
+ * (state, 키 클래스)로 인덱스되는 전이 테이블을 만들 수 있다.
+ * 각 전이는 기존 조합 함수를 한번 실행한 결과를 기록한 것이므로 전이
+ * 테이블로 처리한 결과는 기존 조합 함수의 결과와 같다. */
+#define HANGUL_AUTOMATON_MAX_STATES 0x8000
+/* 오토마타 하나가 쓸 수 있는 메모리, 넘으면 더 배우지 않고 조합 함수로
+ * 처리한다 */
+#define HANGUL_AUTOMATON_MAX_BYTES  (1 << 20)
+#define HANGUL_AUTOMATON_UNKNOWN    UINT32_MAX
+#define HANGUL_AUTOMATON_NO_NEXT    UINT16_MAX
+#define HANGUL_AUTOMATON_NCONFIGS   16
+
+enum {
+    HANGUL_AUTOMATON_RETURN = 1 << 0,	/* hangul_ic_process()의 리턴값 */
+    HANGUL_AUTOMATON_APPEND = 1 << 1,	/* commit string 뒤에 키의 글자를 붙인다 */
+    HANGUL_AUTOMATON_SLOW   = 1 << 2	/* 테이블로 처리할 수 없는 전이 */
+};
+
+typedef struct _HangulAutomaton           HangulAutomaton;
+typedef struct _HangulAutomatonState      HangulAutomatonState;
+typedef struct _HangulAutomatonTransition HangulAutomatonTransition;
+
+struct _HangulAutomatonState {
+    HangulBuffer buffer;
+    ucschar preedit[4];
+};
+
+/* commit string은 조합 버퍼 하나를 스트링으로 바꾼 것이므로 3글자를
+ * 넘지 않고, 한글 자모와 음절은 모두 BMP 안에 있다. */
+struct _HangulAutomatonTransition {
+    uint16_t next;
+    uint16_t flags;
+    uint16_t commit[3];
+};
+
+struct _HangulAutomaton {
+    const HangulKeyboard* keyboard;
+    int type;
+    unsigned config;
+
+    unsigned nclasses;
+    unsigned char keyclass[128];
+    ucschar keychar[128];
+    int classkey[128];
+
+    HangulAutomatonState* states;
+    HangulAutomatonTransition* transitions;
+    unsigned nstates;
+    unsigned nalloced;
+    unsigned maxstates;
+
+    uint32_t* hash;
+    unsigned hashsize;
+};
+
 struct _HangulInputContext {
     int type;
 
@@ -216,6 +288,12 @@ struct _HangulInputContext {
     HangulOnTransition  on_transition;
     void*               on_transition_data;
 
+    HangulOnCommit      on_commit;
+    void*               on_commit_data;
+
+    HangulOnPreeditChanged on_preedit_changed;
+    void*                  on_preedit_changed_data;
+
     unsigned int use_jamo_mode_only : 1;
     unsigned int option_auto_reorder : 1;
     unsigned int option_combi_on_double_stroke : 1;
@@ -223,9 +301,34 @@ struct _HangulInputContext {
     
     /* 갈마들이 기능을 위한 이전 키 추적 */
     int prev_ascii;  
+
+    /* 조합 옵션과 출력 모드의 조합마다 하나씩 만드는 조합 오토마타와
+     * 지금 사용중인 오토마타, 현재 버퍼의 state */
+    HangulAutomaton* automata[HANGUL_AUTOMATON_NCONFIGS];
+    HangulAutomaton* automaton;
+    uint32_t automaton_state;
+
+    /* hangul_ic_pool_release()로 반환된 ic의 목록 */
+    HangulInputContext* pool_next;
 };
 
-static void    hangul_buffer_push(HangulBuffer *buffer, ucschar ch);
+#if defined(_MSC_VER)
+#define HANGUL_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define HANGUL_THREAD_LOCAL __thread
+#else
+#define HANGUL_THREAD_LOCAL _Thread_local
+#endif
+
+/* 쓰레드마다 따로 두는 ic 목록, 갯수가 이보다 많아지면 반환된 ic는
+ * 바로 삭제한다 */
+#define HANGUL_IC_POOL_MAX 16
+
+static HANGUL_THREAD_LOCAL HangulInputContext* hangul_ic_pool = NULL;
+static HANGUL_THREAD_LOCAL unsigned int hangul_ic_pool_size = 0;
+static HANGUL_THREAD_LOCAL bool hangul_ic_pool_registered = false;
+
+static bool    hangul_buffer_push(HangulBuffer *buffer, ucschar ch);
 static ucschar hangul_buffer_pop (HangulBuffer *buffer);
 static ucschar hangul_buffer_peek(HangulBuffer *buffer);
 
@@ -234,6 +337,9 @@ static int     hangul_buffer_get_string(HangulBuffer *buffer, ucschar*buf, int b
 static int     hangul_buffer_get_jamo_string(HangulBuffer *buffer, ucschar *buf, int buflen);
 
 static void    hangul_ic_flush_internal(HangulInputContext *hic);
+static bool    hangul_ic_process_key(HangulInputContext *hic, int ascii);
+static bool    hangul_ic_backspace_internal(HangulInputContext *hic);
+static bool    is_galmadeuli_keyboard(const HangulKeyboard* keyboard);
 
 
 static bool
@@ -261,19 +367,31 @@ hangul_buffer_has_jongseong(HangulBuffer *buffer)
     return buffer->jongseong != 0;
 }
 
-static void
+static bool
+hangul_buffer_is_full(HangulBuffer *buffer)
+{
+    return buffer->index >= (int)N_ELEMENTS(buffer->stack) - 1;
+}
+
+/* 스택이 가득 차면 아무것도 바꾸지 않고 false를 리턴한다. */
+static bool
 hangul_buffer_push(HangulBuffer *buffer, ucschar ch)
 {
-    if (hangul_is_choseong(ch)) {
+    unsigned type = hangul_ctype(ch);
+
+    if (hangul_buffer_is_full(buffer))
+	return false;
+
+    if (type & HANGUL_CTYPE_L) {
 	buffer->choseong = ch;
-    } else if (hangul_is_jungseong(ch)) {
+    } else if (type & HANGUL_CTYPE_V) {
 	buffer->jungseong = ch;
-    } else if (hangul_is_jongseong(ch)) {
+    } else if (type & HANGUL_CTYPE_T) {
 	buffer->jongseong = ch;
-    } else {
     }
 
     buffer->stack[++buffer->index] = ch;
+    return true;
 }
 
 static ucschar
@@ -460,17 +578,23 @@ static inline bool
 hangul_ic_push(HangulInputContext *hic, ucschar c)
 {
     ucschar buf[64] = { 0, };
+    unsigned type = hangul_ctype(c);
+
+    /* 스택이 가득 찼으면 더 조합하지 않고 키를 거절한다. */
+    if (hangul_buffer_is_full(&hic->buffer))
+	return false;
+
     if (hic->on_transition != NULL) {
 	ucschar cho, jung, jong;
-	if (hangul_is_choseong(c)) {
+	if (type & HANGUL_CTYPE_L) {
 	    cho  = c;
 	    jung = hic->buffer.jungseong;
 	    jong = hic->buffer.jongseong;
-	} else if (hangul_is_jungseong(c)) {
+	} else if (type & HANGUL_CTYPE_V) {
 	    cho  = hic->buffer.choseong;
 	    jung = c;
 	    jong = hic->buffer.jongseong;
-	} else if (hangul_is_jongseong(c)) {
+	} else if (type & HANGUL_CTYPE_T) {
 	    cho  = hic->buffer.choseong;
 	    jung = hic->buffer.jungseong;
 	    jong = c;
@@ -485,14 +609,13 @@ hangul_ic_push(HangulInputContext *hic, ucschar c)
 	    return false;
 	}
     } else {
-	if (!hangul_is_jamo(c)) {
+	if (!(type & (HANGUL_CTYPE_L | HANGUL_CTYPE_V | HANGUL_CTYPE_T))) {
 	    hangul_ic_flush_internal(hic);
 	    return false;
 	}
     }
 
-    hangul_buffer_push(&hic->buffer, c);
-    return true;
+    return hangul_buffer_push(&hic->buffer, c);
 }
 
 static inline ucschar
@@ -1020,6 +1143,10 @@ hangul_ic_process_romaja(HangulInputContext *hic, int ascii, ucschar ch)
 		if (!hangul_ic_push(hic, ch)) {
 		    return false;
 		}
+	    } else if (combined == hic->buffer.choseong &&
+		       hangul_buffer_is_full(&hic->buffer)) {
+		/* "chh..."처럼 초성이 바뀌지 않는 조합은 스택이 가득 차도
+		 * 키를 받아들이고, backspace 기록만 더 남기지 않는다. */
 	    } else {
 		if (!hangul_ic_push(hic, combined)) {
 		    if (!hangul_ic_push(hic, ch)) {
@@ -1063,56 +1190,9 @@ flush:
     return false;
 }
 
-/**
- * @ingroup hangulic
- * @brief 키 입력을 처리하여 실제로 한글 조합을 하는 함수
- * @param hic @ref HangulInputContext 오브젝트
- * @param ascii 키 이벤트
- * @return @ref HangulInputContext 가 이 키를 사용했으면 true,
- *	     사용하지 않았으면 false
- *
- * ascii 값으로 주어진 키 이벤트를 받아서 내부의 한글 조합 상태를
- * 변화시키고, preedit, commit 스트링을 저장한다.
- *
- * libhangul의 키 이벤트 프로세스는 ASCII 코드 값을 기준으로 처리한다.
- * 이 키 값은 US Qwerty 자판 배열에서의 키 값에 해당한다.
- * 따라서 유럽어 자판을 사용하는 경우에는 해당 키의 ASCII 코드를 직접
- * 전달하면 안되고, 그 키가 US Qwerty 자판이었을 경우에 발생할 수 있는 
- * ASCII 코드 값을 주어야 한다.
- * 또한 ASCII 코드 이므로 Shift 상태는 대문자로 전달이 된다.
- * Capslock이 눌린 경우에는 대소문자를 뒤바꾸어 보내주지 않으면 
- * 마치 Shift가 눌린 것 처럼 동작할 수 있으므로 주의한다.
- * preedit, commit 스트링은 hangul_ic_get_preedit_string(),
- * hangul_ic_get_commit_string() 함수를 이용하여 구할 수 있다.
- * 
- * 이 함수의 사용법에 대한 설명은 @ref hangulicusage 부분을 참조한다.
- *
- * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시킨다.
- */
-bool
-hangul_ic_process(HangulInputContext *hic, int ascii)
+static bool
+hangul_ic_process_char(HangulInputContext *hic, int ascii, ucschar c)
 {
-    ucschar c;
-
-    if (hic == NULL)
-	return false;
-
-    hic->preedit_string[0] = 0;
-    hic->commit_string[0] = 0;
-
-    /* 갈마들이 지원을 위한 동적 키보드 매핑 (갈마들이는 한손 키보드에서만 활성화) */
-    c = hangul_keyboard_get_mapping_galmadeuli(hic->keyboard, ascii, hic);
-    
-    /* 갈마들이에서 조합 완료된 경우 (c=0) 추가 처리 없이 종료 */
-    if (c == 0) { return true; }
-      
-    if (hic->on_translate != NULL)
-	hic->on_translate(hic, ascii, &c, hic->on_translate_data);
-
-    if (ascii == '\b') {
-	return hangul_ic_backspace(hic);
-    }
-
     int type = hangul_keyboard_get_type(hic->keyboard);
     switch (type) {
     case HANGUL_KEYBOARD_TYPE_JASO:
@@ -1126,186 +1206,879 @@ hangul_ic_process(HangulInputContext *hic, int ascii)
     }
 }
 
-/**
- * @ingroup hangulic
- * @brief 현재 상태의 preedit string을 구하는 함수
- * @param hic preedit string을 구하고자하는 입력 상태 object
- * @return UCS4 preedit 스트링, 이 스트링은 @a hic 내부의 데이터이므로 
- *         수정하거나 free해서는 안된다.
- * 
- * 이 함수는  @a hic 내부의 현재 상태의 preedit string을 리턴한다.
- * 따라서 hic가 다른 키 이벤트를 처리하고 나면 그 내용이 바뀔 수 있다.
- * 
- * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시키지 않는다.
- */
-const ucschar*
-hangul_ic_get_preedit_string(HangulInputContext *hic)
+static unsigned
+hangul_ic_get_config(HangulInputContext *hic)
 {
-    if (hic == NULL)
-	return NULL;
-
-    return hic->preedit_string;
+    return hic->option_auto_reorder |
+	   hic->option_combi_on_double_stroke << 1 |
+	   hic->option_non_choseong_combi << 2 |
+	   hic->output_mode << 3;
 }
 
-/**
- * @ingroup hangulic
- * @brief 현재 상태의 commit string을 구하는 함수
- * @param hic commit string을 구하고자하는 입력 상태 object
- * @return UCS4 commit 스트링, 이 스트링은 @a hic 내부의 데이터이므로 
- *         수정하거나 free해서는 안된다.
- * 
- * 이 함수는  @a hic 내부의 현재 상태의 commit string을 리턴한다.
- * 따라서 hic가 다른 키 이벤트를 처리하고 나면 그 내용이 바뀔 수 있다.
- *
- * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시키지 않는다.
- */
-const ucschar*
-hangul_ic_get_commit_string(HangulInputContext *hic)
+static void
+hangul_buffer_canonicalize(HangulBuffer *dest, const HangulBuffer *src)
 {
-    if (hic == NULL)
-	return NULL;
+    int i;
 
-    return hic->commit_string;
+    /* 스택에서 index 위쪽에 남아 있는 값은 조합에 영향을 주지 않는다.
+     * 같은 상태가 같은 키가 되도록 지운다. */
+    *dest = *src;
+    for (i = dest->index + 1; i < N_ELEMENTS(dest->stack); i++)
+	dest->stack[i] = 0;
 }
 
-/**
- * @ingroup hangulic
- * @brief @ref HangulInputContext 를 초기상태로 되돌리는 함수
- * @param hic @ref HangulInputContext 를 가리키는 포인터
- * 
- * 이 함수는 @a hic가 가리키는 @ref HangulInputContext 의 상태를 
- * 처음 상태로 되돌린다. preedit 스트링, commit 스트링, flush 스트링이
- * 없어지고, 입력되었던 키에 대한 기록이 없어진다.
- * 영어 상태로 바뀌는 것이 아니다.
- *
- * 비교: hangul_ic_flush()
- *
- * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시킨다.
- */
-void
-hangul_ic_reset(HangulInputContext *hic)
+static uint32_t
+hangul_buffer_hash(const HangulBuffer *buffer)
 {
-    if (hic == NULL)
-	return;
+    uint32_t h = 2166136261U;
+    int i;
 
-    hic->preedit_string[0] = 0;
-    hic->commit_string[0] = 0;
-    hic->flushed_string[0] = 0;
+    h = (h ^ buffer->choseong) * 16777619U;
+    h = (h ^ buffer->jungseong) * 16777619U;
+    h = (h ^ buffer->jongseong) * 16777619U;
+    for (i = 0; i <= buffer->index && i < N_ELEMENTS(buffer->stack); i++)
+	h = (h ^ buffer->stack[i]) * 16777619U;
+    h = (h ^ (uint32_t)buffer->index) * 16777619U;
 
-    hangul_buffer_clear(&hic->buffer);
+    return h;
 }
 
-/* append current preedit to the commit buffer.
- * this function does not clear previously made commit string. */
 static void
-hangul_ic_flush_internal(HangulInputContext *hic)
+hangul_automaton_delete(HangulAutomaton *automaton)
 {
-    hic->preedit_string[0] = 0;
+    if (automaton == NULL)
+	return;
 
-    hangul_ic_save_commit_string(hic);
-    hangul_buffer_clear(&hic->buffer);
+    free(automaton->states);
+    free(automaton->transitions);
+    free(automaton->hash);
+    free(automaton);
 }
 
-/**
- * @ingroup hangulic
- * @brief @ref HangulInputContext 의 입력 상태를 완료하는 함수
- * @param hic @ref HangulInputContext 를 가리키는 포인터
- * @return 조합 완료된 스트링, 스트링의 길이가 0이면 조합 완료된 스트링이 
- *	  없는 것
- *
- * 이 함수는 @a hic가 가리키는 @ref HangulInputContext 의 입력 상태를 완료한다.
- * 조합중이던 스트링을 완성하여 리턴한다. 그리고 입력 상태가 초기 상태로 
- * 되돌아 간다. 조합중이던 글자를 강제로 commit하고 싶을때 사용하는 함수다.
- * 보통의 경우 입력 framework에서 focus가 나갈때 이 함수를 불러서 마지막 
- * 상태를 완료해야 조합중이던 글자를 잃어버리지 않게 된다.
- *
- * 비교: hangul_ic_reset()
- *
- * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시킨다.
- */
-const ucschar*
-hangul_ic_flush(HangulInputContext *hic)
+static uint32_t
+hangul_automaton_lookup(const HangulAutomaton *automaton,
+			const HangulBuffer *key, unsigned *slot)
 {
-    if (hic == NULL)
-	return NULL;
-
-    // get the remaining string and clear the buffer
-    hic->preedit_string[0] = 0;
-    hic->commit_string[0] = 0;
-    hic->flushed_string[0] = 0;
-
-    if (hic->output_mode == HANGUL_OUTPUT_JAMO) {
-	hangul_buffer_get_jamo_string(&hic->buffer, hic->flushed_string,
-				 N_ELEMENTS(hic->flushed_string));
-    } else {
-	hangul_buffer_get_string(&hic->buffer, hic->flushed_string,
-				 N_ELEMENTS(hic->flushed_string));
+    unsigned mask;
+    unsigned i;
+
+    *slot = 0;
+    if (automaton->hashsize == 0)
+	return HANGUL_AUTOMATON_UNKNOWN;
+
+    mask = automaton->hashsize - 1;
+    i = hangul_buffer_hash(key) & mask;
+    while (automaton->hash[i] != 0) {
+	uint32_t state = automaton->hash[i] - 1;
+	if (memcmp(&automaton->states[state].buffer, key, sizeof(*key)) == 0) {
+	    *slot = i;
+	    return state;
+	}
+	i = (i + 1) & mask;
     }
 
-    hangul_buffer_clear(&hic->buffer);
-
-    return hic->flushed_string;
+    *slot = i;
+    return HANGUL_AUTOMATON_UNKNOWN;
 }
 
-/**
- * @ingroup hangulic
- * @brief @ref HangulInputContext 가 backspace 키를 처리하도록 하는 함수
- * @param hic @ref HangulInputContext 를 가리키는 포인터
- * @return @a hic가 키를 사용했으면 true, 사용하지 않았으면 false
- * 
- * 이 함수는 @a hic가 가리키는 @ref HangulInputContext 의 조합중이던 글자를
- * 뒤에서부터 하나 지우는 기능을 한다. backspace 키를 눌렀을 때 발생하는 
- * 동작을 한다. 따라서 이 함수를 부르고 나면 preedit string이 바뀌므로
- * 반드시 업데이트를 해야 한다.
- *
- * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시킨다.
- */
-bool
-hangul_ic_backspace(HangulInputContext *hic)
+static bool
+hangul_automaton_rehash(HangulAutomaton *automaton, unsigned size)
 {
-    int ret;
+    uint32_t* hash;
+    unsigned mask = size - 1;
+    unsigned i;
 
-    if (hic == NULL)
+    hash = calloc(size, sizeof(uint32_t));
+    if (hash == NULL)
 	return false;
 
-    hic->preedit_string[0] = 0;
-    hic->commit_string[0] = 0;
+    for (i = 0; i < automaton->nstates; i++) {
+	unsigned j = hangul_buffer_hash(&automaton->states[i].buffer) & mask;
+	while (hash[j] != 0)
+	    j = (j + 1) & mask;
+	hash[j] = i + 1;
+    }
 
-    ret = hangul_buffer_backspace(&hic->buffer);
-    if (ret)
-	hangul_ic_save_preedit_string(hic);
-    return ret;
+    free(automaton->hash);
+    automaton->hash = hash;
+    automaton->hashsize = size;
+    return true;
 }
 
-/**
- * @ingroup hangulic
- * @brief @ref HangulInputContext 가 조합중인 글자를 가지고 있는지 확인하는 함수
- * @param hic @ref HangulInputContext 를 가리키는 포인터
- *
- * @ref HangulInputContext 가 조합중인 글자가 있으면 true를 리턴한다.
- *
- * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시키지 않는다.
- */
-bool
-hangul_ic_is_empty(HangulInputContext *hic)
+static bool
+hangul_automaton_resize(HangulAutomaton *automaton, unsigned nalloced)
 {
-    return hangul_buffer_is_empty(&hic->buffer);
+    HangulAutomatonState* states;
+    HangulAutomatonTransition* transitions;
+    unsigned i;
+
+    states = realloc(automaton->states,
+		     sizeof(HangulAutomatonState) * nalloced);
+    if (states == NULL)
+	return false;
+    automaton->states = states;
+
+    transitions = realloc(automaton->transitions,
+	    sizeof(HangulAutomatonTransition) * nalloced * automaton->nclasses);
+    if (transitions == NULL)
+	return false;
+    automaton->transitions = transitions;
+
+    for (i = automaton->nalloced * automaton->nclasses;
+	 i < nalloced * automaton->nclasses; i++) {
+	transitions[i].next = HANGUL_AUTOMATON_NO_NEXT;
+	transitions[i].flags = 0;
+	transitions[i].commit[0] = 0;
+    }
+
+    automaton->nalloced = nalloced;
+    return true;
 }
 
-/**
- * @ingroup hangulic
- * @brief @ref HangulInputContext 가 조합중인 초성을 가지고 있는지 확인하는 함수
- * @param hic @ref HangulInputContext 를 가리키는 포인터
- *
- * @ref HangulInputContext 가 조합중인 글자가 초성이 있으면 true를 리턴한다.
- *
- * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시키지 않는다.
- */
-bool
-hangul_ic_has_choseong(HangulInputContext *hic)
+static uint32_t
+hangul_automaton_add_state(HangulAutomaton *automaton, const HangulBuffer *buffer)
 {
-    return hangul_buffer_has_choseong(&hic->buffer);
-}
+    HangulAutomatonState* state;
+    HangulBuffer key;
+    uint32_t id;
+    unsigned slot;
+
+    hangul_buffer_canonicalize(&key, buffer);
+    id = hangul_automaton_lookup(automaton, &key, &slot);
+    if (id != HANGUL_AUTOMATON_UNKNOWN)
+	return id;
+
+    if (automaton->nstates >= automaton->maxstates)
+	return HANGUL_AUTOMATON_UNKNOWN;
+
+    if (automaton->nstates >= automaton->nalloced) {
+	unsigned nalloced = automaton->nalloced > 0 ? automaton->nalloced * 2 : 64;
+	if (nalloced > automaton->maxstates)
+	    nalloced = automaton->maxstates;
+	if (!hangul_automaton_resize(automaton, nalloced))
+	    return HANGUL_AUTOMATON_UNKNOWN;
+    }
+
+    if ((automaton->nstates + 1) * 2 > automaton->hashsize) {
+	unsigned size = automaton->hashsize > 0 ? automaton->hashsize * 2 : 128;
+	if (!hangul_automaton_rehash(automaton, size))
+	    return HANGUL_AUTOMATON_UNKNOWN;
+	hangul_automaton_lookup(automaton, &key, &slot);
+    }
+
+    id = automaton->nstates;
+    state = &automaton->states[id];
+    state->buffer = key;
+    if ((automaton->config >> 3) == HANGUL_OUTPUT_JAMO) {
+	hangul_buffer_get_jamo_string(&state->buffer, state->preedit,
+				      N_ELEMENTS(state->preedit));
+    } else {
+	hangul_buffer_get_string(&state->buffer, state->preedit,
+				 N_ELEMENTS(state->preedit));
+    }
+
+    automaton->hash[slot] = id + 1;
+    automaton->nstates++;
+
+    return id;
+}
+
+/* hic가 조합 함수로 state @a from 에서 키 @a ascii 를 처리한 결과를
+ * 전이 테이블에 기록한다. 새 state를 리턴한다. */
+static uint32_t
+hangul_automaton_learn(HangulAutomaton *automaton, uint32_t from, int ascii,
+		       HangulInputContext *hic, bool ret)
+{
+    HangulAutomatonTransition* transition;
+    const ucschar* preedit;
+    ucschar ch = automaton->keychar[ascii];
+    uint32_t next;
+    unsigned flags;
+    unsigned len;
+    unsigned i;
+
+    transition = &automaton->transitions[from * automaton->nclasses +
+					 automaton->keyclass[ascii]];
+    if (transition->next != HANGUL_AUTOMATON_NO_NEXT)
+	return transition->next;
+
+    next = hangul_automaton_add_state(automaton, &hic->buffer);
+    if (next == HANGUL_AUTOMATON_UNKNOWN)
+	return HANGUL_AUTOMATON_UNKNOWN;
+
+    /* add_state()가 테이블을 다시 할당했을 수 있다 */
+    transition = &automaton->transitions[from * automaton->nclasses +
+					 automaton->keyclass[ascii]];
+
+    flags = ret ? HANGUL_AUTOMATON_RETURN : 0;
+
+    len = 0;
+    while (hic->commit_string[len] != 0)
+	len++;
+
+    /* 자모가 아닌 글자는 모두 같은 클래스이므로 commit string 끝에 붙은
+     * 글자는 빼고 기록하고, 처리할 때 키의 글자를 붙인다 */
+    if (ch != 0 && !hangul_is_jamo(ch)) {
+	if (len > 0 && hic->commit_string[len - 1] == ch) {
+	    len--;
+	    flags |= HANGUL_AUTOMATON_APPEND;
+	} else {
+	    flags |= HANGUL_AUTOMATON_SLOW;
+	}
+    }
+
+    if (len > N_ELEMENTS(transition->commit))
+	flags |= HANGUL_AUTOMATON_SLOW;
+
+    for (i = 0; i < len && i < N_ELEMENTS(transition->commit); i++) {
+	if (hic->commit_string[i] > UINT16_MAX)
+	    flags |= HANGUL_AUTOMATON_SLOW;
+	transition->commit[i] = hic->commit_string[i];
+    }
+    if (i < N_ELEMENTS(transition->commit))
+	transition->commit[i] = 0;
+
+    preedit = automaton->states[next].preedit;
+    for (i = 0; i < N_ELEMENTS(automaton->states[next].preedit); i++) {
+	if (hic->preedit_string[i] != preedit[i]) {
+	    flags |= HANGUL_AUTOMATON_SLOW;
+	    break;
+	}
+	if (preedit[i] == 0)
+	    break;
+    }
+
+    transition->next = next;
+    transition->flags = flags;
+
+    return next;
+}
+
+static HangulAutomaton*
+hangul_automaton_new(HangulInputContext *hic)
+{
+    HangulAutomaton* automaton;
+    HangulBuffer empty;
+    ucschar classchar[128];
+    unsigned other = UINT_MAX;
+    unsigned k;
+    int i;
+
+    automaton = malloc(sizeof(HangulAutomaton));
+    if (automaton == NULL)
+	return NULL;
+
+    automaton->keyboard = hic->keyboard;
+    automaton->type = hangul_keyboard_get_type(hic->keyboard);
+    automaton->config = hangul_ic_get_config(hic);
+
+    /* 같은 글자로 변환되는 키는 같은 결과를 내므로 한 클래스로 묶는다.
+     * 자모가 아닌 글자는 commit string에 그대로 붙으므로 모두 한 클래스다. */
+    automaton->nclasses = 0;
+    for (i = 0; i < N_ELEMENTS(automaton->keychar); i++) {
+	ucschar c = hangul_keyboard_map_to_char(hic->keyboard, hic->tableid, i);
+	automaton->keychar[i] = c;
+
+	if (c != 0 && !hangul_is_jamo(c)) {
+	    if (other == UINT_MAX) {
+		other = automaton->nclasses++;
+		classchar[other] = c;
+		automaton->classkey[other] = -1;
+	    }
+	    k = other;
+	} else {
+	    for (k = 0; k < automaton->nclasses; k++) {
+		if (k != other && classchar[k] == c)
+		    break;
+	    }
+	    if (k == automaton->nclasses) {
+		automaton->nclasses++;
+		classchar[k] = c;
+		automaton->classkey[k] = -1;
+	    }
+	}
+
+	automaton->keyclass[i] = k;
+	/* backspace는 조합 함수로 처리하지 않는다 */
+	if (automaton->classkey[k] < 0 && i != '\b')
+	    automaton->classkey[k] = i;
+    }
+
+    automaton->states = NULL;
+    automaton->transitions = NULL;
+    automaton->nstates = 0;
+    automaton->nalloced = 0;
+
+    /* state 하나마다 state, 전이, 해시 테이블(최대 state 수의 4배)을 쓴다 */
+    automaton->maxstates = HANGUL_AUTOMATON_MAX_BYTES /
+	(sizeof(HangulAutomatonState) +
+	 sizeof(HangulAutomatonTransition) * automaton->nclasses +
+	 sizeof(uint32_t) * 4);
+    if (automaton->maxstates > HANGUL_AUTOMATON_MAX_STATES)
+	automaton->maxstates = HANGUL_AUTOMATON_MAX_STATES;
+    automaton->hash = NULL;
+    automaton->hashsize = 0;
+
+    /* 0번 state는 빈 버퍼 */
+    hangul_buffer_clear(&empty);
+    if (hangul_automaton_add_state(automaton, &empty) != 0) {
+	hangul_automaton_delete(automaton);
+	return NULL;
+    }
+
+    return automaton;
+}
+
+/* 빈 버퍼에서 시작하여 도달 가능한 state의 전이를 가까운 state부터
+ * 채운다. state 수가 maxstates에 이르면 나머지 전이는 비워 둔다. */
+static void
+hangul_automaton_build(HangulAutomaton *automaton, HangulInputContext *hic)
+{
+    HangulInputContext ctx;
+    uint32_t state;
+    unsigned k;
+
+    /* 콜백이 불리지 않도록 복사본으로 조합 함수를 실행한다 */
+    ctx = *hic;
+    ctx.on_translate = NULL;
+    ctx.on_transition = NULL;
+    ctx.automaton = NULL;
+
+    for (state = 0; state < automaton->nstates; state++) {
+	for (k = 0; k < automaton->nclasses; k++) {
+	    int ascii = automaton->classkey[k];
+	    bool ret;
+
+	    if (ascii < 0)
+		continue;
+
+	    if (automaton->transitions[state * automaton->nclasses + k].next !=
+		HANGUL_AUTOMATON_NO_NEXT)
+		continue;
+
+	    ctx.buffer = automaton->states[state].buffer;
+	    ctx.preedit_string[0] = 0;
+	    ctx.commit_string[0] = 0;
+	    ret = hangul_ic_process_char(&ctx, ascii, automaton->keychar[ascii]);
+	    hangul_automaton_learn(automaton, state, ascii, &ctx, ret);
+	}
+    }
+
+    /* 더 이상 state가 늘어나지 않으므로 남는 메모리를 돌려준다 */
+    hangul_automaton_resize(automaton, automaton->nstates);
+}
+
+static void
+hangul_ic_clear_automata(HangulInputContext *hic)
+{
+    unsigned i;
+
+    for (i = 0; i < N_ELEMENTS(hic->automata); i++) {
+	hangul_automaton_delete(hic->automata[i]);
+	hic->automata[i] = NULL;
+    }
+
+    hic->automaton = NULL;
+    hic->automaton_state = HANGUL_AUTOMATON_UNKNOWN;
+}
+
+/* 현재 옵션과 출력 모드에 맞는 오토마타를 찾는다.
+ * 오토마타는 hangul_ic_compile()로 만든 것만 사용한다. 세벌식 자판의
+ * 오토마타는 키를 처리하면서 필요한 부분만 테이블을 채운다. 가능한 상태가
+ * 너무 많아서 미리 모두 만들어 둘 수는 없다. */
+static HangulAutomaton*
+hangul_ic_get_automaton(HangulInputContext *hic, int ascii)
+{
+    HangulAutomaton* automaton;
+    unsigned config;
+
+    if (ascii < 0 || ascii >= N_ELEMENTS(automaton->keyclass) || ascii == '\b')
+	return NULL;
+
+    if (hic->on_translate != NULL || hic->on_transition != NULL)
+	return NULL;
+
+    config = hangul_ic_get_config(hic);
+    automaton = hic->automata[config];
+    if (automaton == NULL)
+	return NULL;
+
+    if (automaton != hic->automaton) {
+	hic->automaton = automaton;
+	hic->automaton_state = HANGUL_AUTOMATON_UNKNOWN;
+    }
+
+    return automaton;
+}
+
+static uint32_t
+hangul_ic_get_automaton_state(HangulInputContext *hic)
+{
+    if (hic->automaton_state == HANGUL_AUTOMATON_UNKNOWN) {
+	HangulBuffer key;
+	unsigned slot;
+
+	hangul_buffer_canonicalize(&key, &hic->buffer);
+	hic->automaton_state = hangul_automaton_lookup(hic->automaton,
+						       &key, &slot);
+    }
+
+    return hic->automaton_state;
+}
+
+static bool
+hangul_ic_process_automaton(HangulInputContext *hic,
+			    const HangulAutomaton *automaton,
+			    uint32_t state, int ascii, bool *ret)
+{
+    const HangulAutomatonTransition* transition;
+    const HangulAutomatonState* next;
+    unsigned i;
+
+    transition = &automaton->transitions[state * automaton->nclasses +
+					 automaton->keyclass[ascii]];
+    if (transition->next == HANGUL_AUTOMATON_NO_NEXT ||
+	(transition->flags & HANGUL_AUTOMATON_SLOW))
+	return false;
+
+    for (i = 0; i < N_ELEMENTS(transition->commit); i++) {
+	if (transition->commit[i] == 0)
+	    break;
+	hic->commit_string[i] = transition->commit[i];
+    }
+    if (transition->flags & HANGUL_AUTOMATON_APPEND)
+	hic->commit_string[i++] = automaton->keychar[ascii];
+    hic->commit_string[i] = 0;
+
+    next = &automaton->states[transition->next];
+    hic->buffer = next->buffer;
+    memcpy(hic->preedit_string, next->preedit, sizeof(next->preedit));
+    hic->automaton_state = transition->next;
+
+    if (automaton->type == HANGUL_KEYBOARD_TYPE_JASO ||
+	automaton->type == HANGUL_KEYBOARD_TYPE_JASO_YET)
+	hic->prev_ascii = ascii;
+
+    *ret = (transition->flags & HANGUL_AUTOMATON_RETURN) != 0;
+    return true;
+}
+
+/**
+ * @ingroup hangulic
+ * @brief 현재 자판과 조합 옵션으로 조합 오토마타를 만드는 함수
+ * @param hic @ref HangulInputContext 오브젝트
+ * @return 오토마타를 사용할 수 있으면 true, 지원하지 않는 자판이면 false
+ *
+ * 이 함수는 @a hic 의 현재 자판, 조합 옵션, 출력 모드에서 조합 상태와
+ * 키에 대한 전이 테이블을 미리 만들어 둔다. 그 후 hangul_ic_process()는
+ * 테이블에 있는 전이는 테이블로, 없는 전이는 조합 함수로 처리한다.
+ * 처리 결과는 이 함수를 부르지 않았을 때와 같다.
+ *
+ * 테이블 하나는 1MB를 넘지 않으며, 빈 버퍼에서 가까운 상태부터 채운다.
+ * backspace를 위한 입력 순서도 상태에 들어가므로 두벌식 자판도 도달할 수
+ * 있는 상태의 일부만 테이블에 들어간다.
+ *
+ * 테이블은 조합 옵션과 출력 모드의 조합마다 따로 만들고, hangul_ic_process()가
+ * 현재 설정에 맞는 테이블을 고른다. 옵션을 바꾼 후에 미리 만들어 두려면 이
+ * 함수를 다시 부르면 된다. 자판을 바꾸면 만들어 둔 테이블은 버린다.
+ * translate, transition 콜백이 연결되어 있는 동안에는 테이블을 사용하지
+ * 않는다.
+ *
+ * @ref HANGUL_KEYBOARD_TYPE_JASO, @ref HANGUL_KEYBOARD_TYPE_JASO_YET 자판은
+ * 가능한 상태가 너무 많아 미리 만들지 않고 빈 테이블만 만든다. 그 후
+ * hangul_ic_process()가 키를 처리하면서 필요한 부분을 채운다.
+ * 옛한글 두벌식 자판과 로마자 자판은 지원하지 않는다.
+ *
+ * 이 함수를 부르지 않으면 테이블을 만들지 않는다.
+ *
+ * @remarks 이 함수는 @ref HangulInputContext 의 조합 상태를 변화 시키지 않는다.
+ */
+bool
+hangul_ic_compile(HangulInputContext *hic)
+{
+    HangulAutomaton* automaton;
+    unsigned config;
+    int type;
+
+    if (hic == NULL || hic->keyboard == NULL)
+	return false;
+
+    type = hangul_keyboard_get_type(hic->keyboard);
+    if (type != HANGUL_KEYBOARD_TYPE_JAMO &&
+	type != HANGUL_KEYBOARD_TYPE_JASO &&
+	type != HANGUL_KEYBOARD_TYPE_JASO_YET)
+	return false;
+
+    if (is_galmadeuli_keyboard(hic->keyboard))
+	return false;
+
+    config = hangul_ic_get_config(hic);
+    automaton = hic->automata[config];
+    if (automaton == NULL) {
+	automaton = hangul_automaton_new(hic);
+	if (automaton == NULL)
+	    return false;
+	hic->automata[config] = automaton;
+    }
+
+    if (type == HANGUL_KEYBOARD_TYPE_JAMO)
+	hangul_automaton_build(automaton, hic);
+
+    return true;
+}
+
+static int
+hangul_ucs_strlen(const ucschar* str)
+{
+    int n = 0;
+    while (str[n] != 0)
+	n++;
+    return n;
+}
+
+/* preedit-changed 콜백이 연결되어 있으면 상태가 바뀌기 전의 preedit
+ * 스트링을 저장해 둔다. */
+static void
+hangul_ic_save_old_preedit(HangulInputContext *hic, ucschar *buf, int buflen)
+{
+    int i;
+
+    buf[0] = 0;
+    if (hic->on_preedit_changed == NULL)
+	return;
+
+    for (i = 0; i < buflen - 1 && hic->preedit_string[i] != 0; i++)
+	buf[i] = hic->preedit_string[i];
+    buf[i] = 0;
+}
+
+/* commit 스트링이 생겼거나 preedit 스트링이 바뀌었을 때만
+ * 연결된 콜백을 부른다. */
+static void
+hangul_ic_emit_signals(HangulInputContext *hic, const ucschar *old_preedit)
+{
+    if (hic->on_commit != NULL && hic->commit_string[0] != 0) {
+	hic->on_commit(hic, hic->commit_string,
+		       hangul_ucs_strlen(hic->commit_string),
+		       hic->on_commit_data);
+    }
+
+    if (hic->on_preedit_changed != NULL) {
+	int i;
+	for (i = 0; old_preedit[i] != 0; i++) {
+	    if (old_preedit[i] != hic->preedit_string[i])
+		break;
+	}
+
+	if (old_preedit[i] != hic->preedit_string[i]) {
+	    hic->on_preedit_changed(hic, hic->preedit_string,
+				    hangul_ucs_strlen(hic->preedit_string),
+				    hic->on_preedit_changed_data);
+	}
+    }
+}
+
+/**
+ * @ingroup hangulic
+ * @brief 키 입력을 처리하여 실제로 한글 조합을 하는 함수
+ * @param hic @ref HangulInputContext 오브젝트
+ * @param ascii 키 이벤트
+ * @return @ref HangulInputContext 가 이 키를 사용했으면 true,
+ *	     사용하지 않았으면 false
+ *
+ * ascii 값으로 주어진 키 이벤트를 받아서 내부의 한글 조합 상태를
+ * 변화시키고, preedit, commit 스트링을 저장한다.
+ *
+ * libhangul의 키 이벤트 프로세스는 ASCII 코드 값을 기준으로 처리한다.
+ * 이 키 값은 US Qwerty 자판 배열에서의 키 값에 해당한다.
+ * 따라서 유럽어 자판을 사용하는 경우에는 해당 키의 ASCII 코드를 직접
+ * 전달하면 안되고, 그 키가 US Qwerty 자판이었을 경우에 발생할 수 있는 
+ * ASCII 코드 값을 주어야 한다.
+ * 또한 ASCII 코드 이므로 Shift 상태는 대문자로 전달이 된다.
+ * Capslock이 눌린 경우에는 대소문자를 뒤바꾸어 보내주지 않으면 
+ * 마치 Shift가 눌린 것 처럼 동작할 수 있으므로 주의한다.
+ * preedit, commit 스트링은 hangul_ic_get_preedit_string(),
+ * hangul_ic_get_commit_string() 함수를 이용하여 구할 수 있다.
+ * 
+ * 이 함수의 사용법에 대한 설명은 @ref hangulicusage 부분을 참조한다.
+ *
+ * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시킨다.
+ */
+bool
+hangul_ic_process(HangulInputContext *hic, int ascii)
+{
+    ucschar preedit[64];
+    bool ret;
+
+    if (hic == NULL)
+	return false;
+
+    if (hic->on_commit == NULL && hic->on_preedit_changed == NULL)
+	return hangul_ic_process_key(hic, ascii);
+
+    hangul_ic_save_old_preedit(hic, preedit, N_ELEMENTS(preedit));
+    ret = hangul_ic_process_key(hic, ascii);
+    hangul_ic_emit_signals(hic, preedit);
+
+    return ret;
+}
+
+static bool
+hangul_ic_process_key(HangulInputContext *hic, int ascii)
+{
+    HangulAutomaton* automaton;
+    uint32_t state = HANGUL_AUTOMATON_UNKNOWN;
+    ucschar c;
+    bool ret;
+
+    hic->preedit_string[0] = 0;
+    hic->commit_string[0] = 0;
+
+    automaton = hangul_ic_get_automaton(hic, ascii);
+    if (automaton != NULL) {
+	state = hangul_ic_get_automaton_state(hic);
+	if (state != HANGUL_AUTOMATON_UNKNOWN &&
+	    hangul_ic_process_automaton(hic, automaton, state, ascii, &ret))
+	    return ret;
+    }
+    hic->automaton_state = HANGUL_AUTOMATON_UNKNOWN;
+
+    if (is_galmadeuli_keyboard(hic->keyboard)) {
+	/* 갈마들이 지원을 위한 동적 키보드 매핑 (갈마들이는 한손 키보드에서만 활성화) */
+	c = hangul_keyboard_get_mapping_galmadeuli(hic->keyboard, ascii, hic);
+
+	/* 갈마들이에서 조합 완료된 경우 (c=0) 추가 처리 없이 종료 */
+	if (c == 0) { return true; }
+    } else {
+	c = hangul_keyboard_map_to_char(hic->keyboard, hic->tableid, ascii);
+    }
+      
+    if (hic->on_translate != NULL)
+	hic->on_translate(hic, ascii, &c, hic->on_translate_data);
+
+    if (ascii == '\b') {
+	return hangul_ic_backspace_internal(hic);
+    }
+
+    ret = hangul_ic_process_char(hic, ascii, c);
+
+    /* 테이블에 없던 전이는 조합 함수로 처리한 결과를 기록해 둔다 */
+    if (state != HANGUL_AUTOMATON_UNKNOWN) {
+	hic->automaton_state = hangul_automaton_learn(automaton, state,
+						      ascii, hic, ret);
+    }
+
+    return ret;
+}
+
+/**
+ * @ingroup hangulic
+ * @brief 현재 상태의 preedit string을 구하는 함수
+ * @param hic preedit string을 구하고자하는 입력 상태 object
+ * @return UCS4 preedit 스트링, 이 스트링은 @a hic 내부의 데이터이므로 
+ *         수정하거나 free해서는 안된다.
+ * 
+ * 이 함수는  @a hic 내부의 현재 상태의 preedit string을 리턴한다.
+ * 따라서 hic가 다른 키 이벤트를 처리하고 나면 그 내용이 바뀔 수 있다.
+ * 
+ * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시키지 않는다.
+ */
+const ucschar*
+hangul_ic_get_preedit_string(HangulInputContext *hic)
+{
+    if (hic == NULL)
+	return NULL;
+
+    return hic->preedit_string;
+}
+
+/**
+ * @ingroup hangulic
+ * @brief 현재 상태의 commit string을 구하는 함수
+ * @param hic commit string을 구하고자하는 입력 상태 object
+ * @return UCS4 commit 스트링, 이 스트링은 @a hic 내부의 데이터이므로 
+ *         수정하거나 free해서는 안된다.
+ * 
+ * 이 함수는  @a hic 내부의 현재 상태의 commit string을 리턴한다.
+ * 따라서 hic가 다른 키 이벤트를 처리하고 나면 그 내용이 바뀔 수 있다.
+ *
+ * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시키지 않는다.
+ */
+const ucschar*
+hangul_ic_get_commit_string(HangulInputContext *hic)
+{
+    if (hic == NULL)
+	return NULL;
+
+    return hic->commit_string;
+}
+
+/**
+ * @ingroup hangulic
+ * @brief @ref HangulInputContext 를 초기상태로 되돌리는 함수
+ * @param hic @ref HangulInputContext 를 가리키는 포인터
+ * 
+ * 이 함수는 @a hic가 가리키는 @ref HangulInputContext 의 상태를 
+ * 처음 상태로 되돌린다. preedit 스트링, commit 스트링, flush 스트링이
+ * 없어지고, 입력되었던 키에 대한 기록이 없어진다.
+ * 영어 상태로 바뀌는 것이 아니다.
+ *
+ * 비교: hangul_ic_flush()
+ *
+ * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시킨다.
+ */
+void
+hangul_ic_reset(HangulInputContext *hic)
+{
+    ucschar preedit[64];
+
+    if (hic == NULL)
+	return;
+
+    hangul_ic_save_old_preedit(hic, preedit, N_ELEMENTS(preedit));
+
+    hic->preedit_string[0] = 0;
+    hic->commit_string[0] = 0;
+    hic->flushed_string[0] = 0;
+
+    hangul_buffer_clear(&hic->buffer);
+    hic->automaton_state = HANGUL_AUTOMATON_UNKNOWN;
+
+    hangul_ic_emit_signals(hic, preedit);
+}
+
+/* append current preedit to the commit buffer.
+ * this function does not clear previously made commit string. */
+static void
+hangul_ic_flush_internal(HangulInputContext *hic)
+{
+    hic->preedit_string[0] = 0;
+
+    hangul_ic_save_commit_string(hic);
+    hangul_buffer_clear(&hic->buffer);
+}
+
+/**
+ * @ingroup hangulic
+ * @brief @ref HangulInputContext 의 입력 상태를 완료하는 함수
+ * @param hic @ref HangulInputContext 를 가리키는 포인터
+ * @return 조합 완료된 스트링, 스트링의 길이가 0이면 조합 완료된 스트링이 
+ *	  없는 것
+ *
+ * 이 함수는 @a hic가 가리키는 @ref HangulInputContext 의 입력 상태를 완료한다.
+ * 조합중이던 스트링을 완성하여 리턴한다. 그리고 입력 상태가 초기 상태로 
+ * 되돌아 간다. 조합중이던 글자를 강제로 commit하고 싶을때 사용하는 함수다.
+ * 보통의 경우 입력 framework에서 focus가 나갈때 이 함수를 불러서 마지막 
+ * 상태를 완료해야 조합중이던 글자를 잃어버리지 않게 된다.
+ *
+ * 비교: hangul_ic_reset()
+ *
+ * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시킨다.
+ */
+const ucschar*
+hangul_ic_flush(HangulInputContext *hic)
+{
+    ucschar preedit[64];
+
+    if (hic == NULL)
+	return NULL;
+
+    hangul_ic_save_old_preedit(hic, preedit, N_ELEMENTS(preedit));
+
+    // get the remaining string and clear the buffer
+    hic->preedit_string[0] = 0;
+    hic->commit_string[0] = 0;
+    hic->flushed_string[0] = 0;
+
+    if (hic->output_mode == HANGUL_OUTPUT_JAMO) {
+	hangul_buffer_get_jamo_string(&hic->buffer, hic->flushed_string,
+				 N_ELEMENTS(hic->flushed_string));
+    } else {
+	hangul_buffer_get_string(&hic->buffer, hic->flushed_string,
+				 N_ELEMENTS(hic->flushed_string));
+    }
+
+    hangul_buffer_clear(&hic->buffer);
+    hic->automaton_state = HANGUL_AUTOMATON_UNKNOWN;
+
+    hangul_ic_emit_signals(hic, preedit);
+
+    return hic->flushed_string;
+}
+
+/**
+ * @ingroup hangulic
+ * @brief @ref HangulInputContext 가 backspace 키를 처리하도록 하는 함수
+ * @param hic @ref HangulInputContext 를 가리키는 포인터
+ * @return @a hic가 키를 사용했으면 true, 사용하지 않았으면 false
+ * 
+ * 이 함수는 @a hic가 가리키는 @ref HangulInputContext 의 조합중이던 글자를
+ * 뒤에서부터 하나 지우는 기능을 한다. backspace 키를 눌렀을 때 발생하는 
+ * 동작을 한다. 따라서 이 함수를 부르고 나면 preedit string이 바뀌므로
+ * 반드시 업데이트를 해야 한다.
+ *
+ * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시킨다.
+ */
+bool
+hangul_ic_backspace(HangulInputContext *hic)
+{
+    ucschar preedit[64];
+    bool ret;
+
+    if (hic == NULL)
+	return false;
+
+    hangul_ic_save_old_preedit(hic, preedit, N_ELEMENTS(preedit));
+    ret = hangul_ic_backspace_internal(hic);
+    hangul_ic_emit_signals(hic, preedit);
+
+    return ret;
+}
+
+static bool
+hangul_ic_backspace_internal(HangulInputContext *hic)
+{
+    int ret;
+
+    hic->preedit_string[0] = 0;
+    hic->commit_string[0] = 0;
+
+    ret = hangul_buffer_backspace(&hic->buffer);
+    hic->automaton_state = HANGUL_AUTOMATON_UNKNOWN;
+    if (ret)
+	hangul_ic_save_preedit_string(hic);
+    return ret;
+}
+
+/**
+ * @ingroup hangulic
+ * @brief @ref HangulInputContext 가 조합중인 글자를 가지고 있는지 확인하는 함수
+ * @param hic @ref HangulInputContext 를 가리키는 포인터
+ *
+ * @ref HangulInputContext 가 조합중인 글자가 있으면 true를 리턴한다.
+ *
+ * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시키지 않는다.
+ */
+bool
+hangul_ic_is_empty(HangulInputContext *hic)
+{
+    return hangul_buffer_is_empty(&hic->buffer);
+}
+
+/**
+ * @ingroup hangulic
+ * @brief @ref HangulInputContext 가 조합중인 초성을 가지고 있는지 확인하는 함수
+ * @param hic @ref HangulInputContext 를 가리키는 포인터
+ *
+ * @ref HangulInputContext 가 조합중인 글자가 초성이 있으면 true를 리턴한다.
+ *
+ * @remarks 이 함수는 @ref HangulInputContext 의 상태를 변화 시키지 않는다.
+ */
+bool
+hangul_ic_has_choseong(HangulInputContext *hic)
+{
+    return hangul_buffer_has_choseong(&hic->buffer);
+}
 
 /**
  * @ingroup hangulic
@@ -1431,6 +2204,33 @@ hangul_ic_connect_transition(HangulInputContext* hic,
     }
 }
 
+/**
+ * @ingroup hangulic
+ * @brief @ref HangulInputContext 의 이벤트에 콜백 함수를 연결한다.
+ * @param hic @ref HangulInputContext 오브젝트
+ * @param event 콜백을 연결할 이벤트 이름, 아래와 같은 값을 사용할 수 있다.
+ *   @li "translate"  키를 자모로 바꾼 후 조합하기 전에 불린다.
+ *   @li "transition" 버퍼에 자모를 넣기 전에 불린다.
+ *   @li "commit"     hangul_ic_process() 가 commit 스트링을 만들었을 때
+ *	 불린다.
+ *   @li "preedit-changed" hangul_ic_process(), hangul_ic_backspace(),
+ *	 hangul_ic_reset(), hangul_ic_flush() 가 preedit 스트링을 바꾸었을 때
+ *	 불린다.
+ * @param callback 연결할 콜백 함수, NULL이면 연결을 끊는다.
+ * @param user_data 콜백 함수에 전달할 데이터
+ *
+ * "commit" 과 "preedit-changed" 콜백은 다음과 같은 형태로, 스트링과 그
+ * 길이(ucschar 코드 단위)를 받는다. 스트링은 @a hic 내부의 데이터이므로
+ * 콜백 안에서만 사용해야 한다.
+ * @code
+ * void on_commit(HangulInputContext* hic, const ucschar* str, int len,
+ *		  void* user_data);
+ * @endcode
+ * 이 콜백을 사용하면 키를 처리할 때마다 hangul_ic_get_commit_string(),
+ * hangul_ic_get_preedit_string() 으로 바뀐 내용을 확인할 필요가 없다.
+ * hangul_ic_flush() 로 꺼낸 스트링은 리턴값으로만 전달되고 "commit"
+ * 콜백은 불리지 않는다.
+ */
 void hangul_ic_connect_callback(HangulInputContext* hic, const char* event,
 				void* callback, void* user_data)
 {
@@ -1443,6 +2243,12 @@ void hangul_ic_connect_callback(HangulInputContext* hic, const char* event,
     } else if (strcasecmp(event, "transition") == 0) {
         *(void**)(&hic->on_transition) = callback;
 	hic->on_transition_data = user_data;
+    } else if (strcasecmp(event, "commit") == 0) {
+        *(void**)(&hic->on_commit) = callback;
+	hic->on_commit_data = user_data;
+    } else if (strcasecmp(event, "preedit-changed") == 0) {
+        *(void**)(&hic->on_preedit_changed) = callback;
+	hic->on_preedit_changed_data = user_data;
     }
 }
 
@@ -1454,6 +2260,9 @@ hangul_ic_set_keyboard(HangulInputContext *hic, const HangulKeyboard* keyboard)
 
     hic->keyboard = keyboard;
     hic->tableid = 0;
+
+    /* 자판이 바뀌면 만들어 둔 오토마타는 쓸 수 없다 */
+    hangul_ic_clear_automata(hic);
 }
 
 void
@@ -1462,6 +2271,9 @@ hangul_ic_switch_keyboard_table(HangulInputContext *hic, int tableid)
     if (hic == NULL)
         return;
 
+    if (hic->tableid != tableid)
+	hangul_ic_clear_automata(hic);
+
     hic->tableid = tableid;
 }
 
@@ -1509,6 +2321,42 @@ hangul_ic_set_combination(HangulInputContext *hic,
 {
 }
 
+/* hangul_ic_new()로 만든 것과 같은 초기 옵션과 상태로 되돌린다.
+ * 자판과 오토마타는 건드리지 않는다. */
+static void
+hangul_ic_set_defaults(HangulInputContext *hic)
+{
+    hic->preedit_string[0] = 0;
+    hic->commit_string[0] = 0;
+    hic->flushed_string[0] = 0;
+
+    hic->on_translate      = NULL;
+    hic->on_translate_data = NULL;
+
+    hic->on_transition      = NULL;
+    hic->on_transition_data = NULL;
+
+    hic->on_commit      = NULL;
+    hic->on_commit_data = NULL;
+
+    hic->on_preedit_changed      = NULL;
+    hic->on_preedit_changed_data = NULL;
+
+    hic->use_jamo_mode_only = FALSE;
+
+    hic->option_auto_reorder = false;
+    hic->option_combi_on_double_stroke = false;
+    hic->option_non_choseong_combi = true;
+    
+    /* 갈마들이 기능을 위한 초기화 */
+    hic->prev_ascii = 0;
+
+    hangul_ic_set_output_mode(hic, HANGUL_OUTPUT_SYLLABLE);
+
+    hangul_buffer_clear(&hic->buffer);
+    hic->automaton_state = HANGUL_AUTOMATON_UNKNOWN;
+}
+
 /**
  * @ingroup hangulic
  * @brief @ref HangulInputContext 오브젝트를 생성한다.
@@ -1523,8 +2371,29 @@ hangul_ic_set_combination(HangulInputContext *hic,
  */
 HangulInputContext*
 hangul_ic_new(const char* keyboard)
+{
+    if (keyboard == NULL)
+	keyboard = "2";
+
+    return hangul_ic_new_with_keyboard(hangul_keyboard_list_get_keyboard(keyboard));
+}
+
+/**
+ * @ingroup hangulic
+ * @brief 자판 오브젝트로 @ref HangulInputContext 오브젝트를 생성한다.
+ * @param keyboard 사용하고자 하는 @ref HangulKeyboard 오브젝트
+ * @return 새로 생성된 @ref HangulInputContext 에 대한 포인터
+ *
+ * hangul_ic_new() 와 같지만 자판 목록에서 id로 자판을 찾지 않고 주어진
+ * @a keyboard 를 그대로 사용한다. @a keyboard 는 생성된
+ * @ref HangulInputContext 를 삭제할 때까지 유효해야 한다.
+ * 더이상 사용하지 않을 때에는 hangul_ic_delete() 함수로 삭제해야 한다.
+ */
+HangulInputContext*
+hangul_ic_new_with_keyboard(const HangulKeyboard* keyboard)
 {
     HangulInputContext *hic;
+    unsigned i;
 
     hic = malloc(sizeof(HangulInputContext));
     if (hic == NULL)
@@ -1533,29 +2402,13 @@ hangul_ic_new(const char* keyboard)
     hic->keyboard = NULL;
     hic->tableid = 0;
 
-    hic->preedit_string[0] = 0;
-    hic->commit_string[0] = 0;
-    hic->flushed_string[0] = 0;
-
-    hic->on_translate      = NULL;
-    hic->on_translate_data = NULL;
-
-    hic->on_transition      = NULL;
-    hic->on_transition_data = NULL;
-
-    hic->use_jamo_mode_only = FALSE;
-
-    hic->option_auto_reorder = false;
-    hic->option_combi_on_double_stroke = false;
-    hic->option_non_choseong_combi = true;
-    
-    /* 갈마들이 기능을 위한 초기화 */
-    hic->prev_ascii = 0;
-
-    hangul_ic_set_output_mode(hic, HANGUL_OUTPUT_SYLLABLE);
-    hangul_ic_select_keyboard(hic, keyboard);
+    for (i = 0; i < N_ELEMENTS(hic->automata); i++)
+	hic->automata[i] = NULL;
+    hic->automaton = NULL;
+    hic->pool_next = NULL;
 
-    hangul_buffer_clear(&hic->buffer);
+    hangul_ic_set_defaults(hic);
+    hangul_ic_set_keyboard(hic, keyboard);
 
     return hic;
 }
@@ -1577,9 +2430,176 @@ hangul_ic_delete(HangulInputContext *hic)
     if (hic == NULL)
 	return;
 
+    hangul_ic_clear_automata(hic);
     free(hic);
 }
 
+/**
+ * @ingroup hangulic
+ * @brief 쓰레드의 ic 목록에서 @ref HangulInputContext 를 꺼낸다.
+ * @param keyboard 사용하고자 하는 @ref HangulKeyboard 오브젝트
+ * @return @ref HangulInputContext 에 대한 포인터
+ *
+ * 요청마다 ic를 만들고 지우는 프로그램을 위한 함수다.
+ * 이 함수를 부른 쓰레드가 hangul_ic_pool_release() 로 반환해 둔 ic가 있으면
+ * 그것을 다시 사용하고, 없으면 hangul_ic_new_with_keyboard() 로 새로
+ * 만든다. 같은 자판을 쓰던 ic가 있으면 그것을 먼저 꺼낸다. 반환할 때
+ * 조합 오토마타는 지워지므로 어느 ic를 꺼내든 다시 만들어야 한다.
+ *
+ * 꺼낸 ic는 hangul_ic_new() 로 만든 것과 같은 초기 상태이다. 다 사용한
+ * 후에는 hangul_ic_pool_release() 로 반환하거나 hangul_ic_delete() 로
+ * 삭제한다.
+ */
+HangulInputContext*
+hangul_ic_pool_acquire(const HangulKeyboard* keyboard)
+{
+    HangulInputContext** p;
+    HangulInputContext* hic;
+
+    for (p = &hangul_ic_pool; *p != NULL; p = &(*p)->pool_next) {
+	if ((*p)->keyboard == keyboard)
+	    break;
+    }
+
+    /* 같은 자판을 쓰던 ic가 없으면 아무것이나 자판을 바꿔서 쓴다 */
+    if (*p == NULL)
+	p = &hangul_ic_pool;
+
+    hic = *p;
+    if (hic == NULL)
+	return hangul_ic_new_with_keyboard(keyboard);
+
+    *p = hic->pool_next;
+    hic->pool_next = NULL;
+    hangul_ic_pool_size--;
+
+    if (hic->keyboard != keyboard)
+	hangul_ic_set_keyboard(hic, keyboard);
+
+    return hic;
+}
+
+/* 쓰레드가 hangul_ic_pool_clear()를 부르지 않고 끝나도 ic 목록이 남지
+ * 않도록 쓰레드가 끝날 때 목록을 비운다. */
+#ifdef _WIN32
+static INIT_ONCE hangul_ic_pool_once = INIT_ONCE_STATIC_INIT;
+static DWORD hangul_ic_pool_key = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI
+hangul_ic_pool_thread_exit(PVOID data)
+{
+    hangul_ic_pool_clear();
+}
+
+static BOOL CALLBACK
+hangul_ic_pool_key_init(PINIT_ONCE once, PVOID param, PVOID* context)
+{
+    hangul_ic_pool_key = FlsAlloc(hangul_ic_pool_thread_exit);
+    return TRUE;
+}
+
+static void
+hangul_ic_pool_register_thread(void)
+{
+    InitOnceExecuteOnce(&hangul_ic_pool_once, hangul_ic_pool_key_init,
+			NULL, NULL);
+    if (hangul_ic_pool_key != FLS_OUT_OF_INDEXES)
+	FlsSetValue(hangul_ic_pool_key, &hangul_ic_pool_once);
+}
+#elif defined(HAVE_PTHREAD_H)
+static pthread_once_t hangul_ic_pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t hangul_ic_pool_key;
+static bool hangul_ic_pool_key_created = false;
+
+static void
+hangul_ic_pool_thread_exit(void* data)
+{
+    hangul_ic_pool_clear();
+}
+
+static void
+hangul_ic_pool_key_init(void)
+{
+    hangul_ic_pool_key_created =
+	pthread_key_create(&hangul_ic_pool_key, hangul_ic_pool_thread_exit) == 0;
+}
+
+static void
+hangul_ic_pool_register_thread(void)
+{
+    pthread_once(&hangul_ic_pool_once, hangul_ic_pool_key_init);
+    /* 값이 NULL이 아니어야 쓰레드가 끝날 때 destructor가 불린다 */
+    if (hangul_ic_pool_key_created)
+	pthread_setspecific(hangul_ic_pool_key, &hangul_ic_pool_once);
+}
+#else
+static void
+hangul_ic_pool_register_thread(void)
+{
+}
+#endif /* _WIN32 */
+
+/**
+ * @ingroup hangulic
+ * @brief @ref HangulInputContext 를 쓰레드의 ic 목록에 반환한다.
+ * @param hic @ref HangulInputContext 오브젝트
+ *
+ * @a hic 를 초기 상태로 되돌려서 이 함수를 부른 쓰레드의 ic 목록에 넣는다.
+ * 조합중이던 내용과 연결된 콜백, 옵션, 출력 모드는 모두 초기화 되고,
+ * hangul_ic_compile() 로 만든 테이블도 지운다.
+ * 목록이 가득 차 있으면 @a hic 는 바로 삭제된다.
+ * 쓰레드가 끝나면 그 쓰레드의 목록에 남아 있는 ic는 모두 삭제된다.
+ * hangul_ic_new() 나 hangul_ic_new_with_keyboard() 로 만든 ic도 반환할 수
+ * 있다.
+ */
+void
+hangul_ic_pool_release(HangulInputContext *hic)
+{
+    if (hic == NULL)
+	return;
+
+    if (hangul_ic_pool_size >= HANGUL_IC_POOL_MAX) {
+	hangul_ic_delete(hic);
+	return;
+    }
+
+    if (!hangul_ic_pool_registered) {
+	hangul_ic_pool_register_thread();
+	hangul_ic_pool_registered = true;
+    }
+
+    /* 옵션이 초기화 되므로 만들어 둔 오토마타는 다시 쓰기 어렵다.
+     * 목록에 있는 동안 메모리를 차지하지 않도록 지운다. */
+    hangul_ic_switch_keyboard_table(hic, 0);
+    hangul_ic_clear_automata(hic);
+    hangul_ic_set_defaults(hic);
+
+    hic->pool_next = hangul_ic_pool;
+    hangul_ic_pool = hic;
+    hangul_ic_pool_size++;
+}
+
+/**
+ * @ingroup hangulic
+ * @brief 쓰레드의 ic 목록을 비운다.
+ *
+ * 이 함수를 부른 쓰레드의 ic 목록에 남아 있는 @ref HangulInputContext 를
+ * 모두 삭제한다. 쓰레드가 끝날 때에는 자동으로 불린다. 목록의 ic는 자판
+ * 오브젝트를 가리키고 있으므로 자판을 삭제하기 전에는 불러야 한다. hangul_fini() 는 부른 쓰레드의
+ * 목록을 비운다.
+ */
+void
+hangul_ic_pool_clear(void)
+{
+    while (hangul_ic_pool != NULL) {
+	HangulInputContext* hic = hangul_ic_pool;
+	hangul_ic_pool = hic->pool_next;
+	hangul_ic_delete(hic);
+    }
+
+    hangul_ic_pool_size = 0;
+}
+
 /** @deprecated 이 함수 대신 @ref hangul_keyboard_list_get_count 를 사용하라 */
 unsigned int
 hangul_ic_get_n_keyboards()
@@ -1628,6 +2648,233 @@ hangul_ic_is_transliteration(HangulInputContext *hic)
     return false;
 }
 
+/* 로마자 스트링 변환에서 같은 음절을 이어갈 수 있는 글자를 찾는다.
+ * 대문자는 새 음절을 시작하므로 소문자만 이어서 조합한다. */
+static inline ucschar
+hangul_romaja_peek(const HangulKeyboard* keyboard, const char* s, const char* end)
+{
+    if (s >= end || !islower((unsigned char)*s))
+	return 0;
+
+    return hangul_keyboard_map_to_char(keyboard, 0, (unsigned char)*s);
+}
+
+static inline ucschar
+hangul_romaja_choseong_to_jongseong(ucschar cho)
+{
+    ucschar jong = hangul_choseong_to_jongseong(cho);
+    if (hangul_is_jongseong_conjoinable(jong))
+	return jong;
+    return 0;
+}
+
+/* 한 음절을 dest의 *len 위치에 쓰고 *len을 늘린다. 음절을 나누어 쓰지
+ * 않으므로 destlen이 모자라면 아무것도 쓰지 않고 false를 리턴한다.
+ * dest가 NULL이면 길이만 늘린다. */
+static bool
+hangul_romaja_emit(ucschar* dest, int destlen, int* len,
+		   ucschar cho, ucschar jung, ucschar jong)
+{
+    ucschar buf[8];
+    int i, n;
+
+    n = hangul_jaso_to_string(cho, jung, jong, buf, N_ELEMENTS(buf));
+    if (n > destlen - *len)
+	return false;
+
+    if (dest != NULL) {
+	for (i = 0; i < n; i++)
+	    dest[*len + i] = buf[i];
+    }
+    *len += n;
+
+    return true;
+}
+
+/**
+ * @ingroup hangulic
+ * @brief 로마자 스트링을 음절 스트링으로 변환
+ * @param dest 음절형으로 변환된 결과가 저장될 버퍼, NULL이면 필요한 길이만
+ *        구한다
+ * @param destlen 결과를 저장할 버퍼의 길이(ucschar 코드 단위)
+ * @param src 변환할 로마자 스트링(ASCII)
+ * @param srclen 변환할 로마자 스트링의 길이(byte 단위)
+ * @return @a dest 에 저장한 코드의 갯수
+ *
+ * 이 함수는 로마자 자판("ro")의 자판 배열과 조합 규칙을 로마자 표기 테이블로
+ * 사용하여 @a src 를 한 음절씩 잘라 한글 음절로 변환한다.
+ * 초성, 중성, 종성은 각각 조합 가능한 가장 긴 글자열로 묶고, 종성 뒤에
+ * 모음이 오는지를 미리 보아서 마지막 자음을 다음 음절의 초성으로 넘긴다.
+ * 따라서 키마다 버퍼를 고치는 @ref hangul_ic_process() 를 거치지 않고도
+ * 로마자 자판에 같은 키를 차례로 입력하고 @ref hangul_ic_flush() 를 호출한
+ * 것과 같은 결과를 얻는다. 대문자는 새 음절을 시작하고, 한글 자모가 아닌
+ * 글자는 그대로 복사된다. 다만 '\\b'는 backspace로 처리하지 않고 다른
+ * 제어 문자와 같이 그대로 복사한다.
+ *
+ * @a srclen 이 -1이라면 @a src 는 0으로 끝나는 스트링으로 가정한다.
+ * @ref hangul_jamos_to_syllables() 와 같이 결과 스트링은 0으로 끝나지
+ * 않으며, @a destlen 에 지정된 길이 이상 쓰지 않는다. 채움 문자가 들어간
+ * 음절과 같이 여러 코드로 된 음절도 나누어 저장하지 않으므로, @a destlen 이
+ * 모자라면 @ref hangul_syllables_to_jamos() 와 같이 그 음절 앞에서 멈춘다.
+ * @a dest 가 NULL이면 @a destlen 은 무시하고 필요한 길이를 리턴한다.
+ */
+int
+hangul_romaja_to_syllables(ucschar* dest, int destlen,
+			   const char* src, int srclen)
+{
+    const HangulKeyboard* keyboard;
+    const char* s;
+    const char* end;
+    ucschar next;
+    int len;
+
+    if (src == NULL)
+	return 0;
+
+    keyboard = hangul_keyboard_list_get_keyboard("ro");
+    if (keyboard == NULL)
+	return 0;
+
+    if (srclen < 0)
+	srclen = strlen(src);
+
+    s = src;
+    end = src + srclen;
+    /* dest가 NULL이면 길이만 구한다 */
+    if (dest == NULL)
+	destlen = INT_MAX;
+
+    len = 0;
+    next = 0;	/* 앞 음절의 받침에서 넘어온 초성 */
+
+    while (s < end && len < destlen) {
+	ucschar cho, jung, jong;
+	ucschar c, combined;
+
+	cho = next;
+	next = 0;
+	if (cho == 0) {
+	    int ascii = (unsigned char)*s++;
+
+	    c = hangul_keyboard_map_to_char(keyboard, 0, ascii);
+	    if (!hangul_is_jamo(c)) {
+		if (dest != NULL)
+		    dest[len] = c > 0 ? c : ascii;
+		len++;
+		continue;
+	    }
+
+	    if (ascii == 'x' || ascii == 'X')
+		c = 0x110c;
+
+	    if (hangul_is_jungseong(c)) {
+		cho = 0x110b;
+		jung = c;
+	    } else if (hangul_is_choseong(c)) {
+		cho = c;
+		for (;;) {
+		    c = hangul_romaja_peek(keyboard, s, end);
+		    if (!hangul_is_choseong(c))
+			break;
+		    combined = hangul_keyboard_combine(keyboard, 0, cho, c);
+		    if (!hangul_is_choseong(combined))
+			break;
+		    cho = combined;
+		    s++;
+		}
+
+		if (hangul_is_jungseong(c)) {
+		    jung = c;
+		    s++;
+		} else {
+		    /* 모음 없이 자음이 이어지면 'ㅡ'를 넣어 음절을 만들고,
+		     * 그 외에는 초성만 내보낸다. */
+		    jung = 0;
+		    if (hangul_is_choseong(c) || hangul_is_jongseong(c))
+			jung = 0x1173;
+		    if (!hangul_romaja_emit(dest, destlen, &len, cho, jung, 0))
+			break;
+		    continue;
+		}
+	    } else {
+		if (!hangul_romaja_emit(dest, destlen, &len, 0, 0, c))
+		    break;
+		continue;
+	    }
+	} else {
+	    jung = hangul_keyboard_map_to_char(keyboard, 0, (unsigned char)*s++);
+	}
+
+	for (;;) {
+	    c = hangul_romaja_peek(keyboard, s, end);
+	    if (!hangul_is_jungseong(c))
+		break;
+	    combined = hangul_keyboard_combine(keyboard, 0, jung, c);
+	    if (!hangul_is_jungseong(combined))
+		break;
+	    jung = combined;
+	    s++;
+	}
+
+	jong = 0;
+	c = hangul_romaja_peek(keyboard, s, end);
+	if (hangul_is_jongseong(c))
+	    jong = c;
+	else if (hangul_is_choseong(c))
+	    jong = hangul_romaja_choseong_to_jongseong(c);
+
+	if (jong != 0) {
+	    bool is_combined = false;
+
+	    s++;
+	    for (;;) {
+		ucschar second;
+
+		/* 받침 뒤의 'x'는 새 음절의 초성 'ㅈ'이다 */
+		if (s < end && *s == 'x')
+		    break;
+
+		c = hangul_romaja_peek(keyboard, s, end);
+		if (hangul_is_jongseong(c))
+		    second = c;
+		else if (hangul_is_choseong(c))
+		    second = hangul_romaja_choseong_to_jongseong(c);
+		else
+		    break;
+
+		combined = hangul_keyboard_combine(keyboard, 0, jong, second);
+		if (!hangul_is_jongseong(combined))
+		    break;
+		jong = combined;
+		is_combined = true;
+		s++;
+	    }
+
+	    /* 받침 뒤에 모음이 오면 마지막 자음을 다음 음절로 넘긴다.
+	     * 'ng'로 만든 'ㅇ'은 받침으로 남기고 다음 음절은 'ㅇ'으로
+	     * 시작한다. */
+	    if (hangul_is_jungseong(hangul_romaja_peek(keyboard, s, end))) {
+		if (jong == 0x11bc) {
+		    next = 0x110b;
+		} else if (is_combined) {
+		    hangul_jongseong_decompose(jong, &jong, &next);
+		} else if (jong == 0x11aa) {
+		    jong = 0x11a8;
+		    next = 0x1109;
+		} else {
+		    next = hangul_jongseong_to_choseong(jong);
+		    jong = 0;
+		}
+	    }
+	}
+
+	if (!hangul_romaja_emit(dest, destlen, &len, cho, jung, jong))
+	    break;
+    }
+
+    return len;
+}
+
 /**
  * @ingroup hangulic
  * @brief libhangul을 초기화 하는 함수.
@@ -1641,7 +2888,27 @@ int
 hangul_init(const char* user_defined_keyboard_path)
 {
     int res;
-    res = hangul_keyboard_list_init(user_defined_keyboard_path);
+    res = hangul_keyboard_list_init(user_defined_keyboard_path, 1);
+    return res;
+}
+
+/**
+ * @ingroup hangulic
+ * @brief 자판 파일을 여러 쓰레드로 나누어 읽으며 libhangul을 초기화 하는 함수.
+ * @param user_defined_keyboard_path hangul_init()과 같다.
+ * @param n_threads 자판 파일을 읽을 쓰레드의 수. 0을 주면 CPU 수만큼
+ *        사용한다.
+ *
+ * 자판 파일이 많을 때 hangul_init() 대신 사용하면 초기화 시간을 줄일 수
+ * 있다. 자판은 파일을 읽은 순서와 관계없이 파일 이름 순서로 등록되므로
+ * 결과는 hangul_init()과 같다.
+ */
+int
+hangul_init_with_threads(const char* user_defined_keyboard_path,
+			 unsigned int n_threads)
+{
+    int res;
+    res = hangul_keyboard_list_init(user_defined_keyboard_path, n_threads);
     return res;
 }
 
@@ -1655,50 +2922,16 @@ int
 hangul_fini()
 {
     int res;
+    hangul_ic_pool_clear();
     res = hangul_keyboard_list_fini();
     return res;
 }
 
-/* 초성 전용 키 정의 */
-static const char* left_hand_choseong_keys = "yuhjnmikl";  /* 왼손 9개 */
-static const char* right_hand_choseong_keys = "ertdfgcvb"; /* 오른손 9개 */
-
-static bool is_right_hand_keyboard(const HangulKeyboard* keyboard) {
-    /* 오른손 키보드 확인: r, e 키가 초성값을 가지는지 */
-    ucschar r_char = hangul_keyboard_map_to_char(keyboard, 0, 'r');
-    ucschar e_char = hangul_keyboard_map_to_char(keyboard, 0, 'e');
-    
-    /* 호환 자모를 유니코드 자모로 변환 후 체크 */
-    ucschar unicode_r = (r_char >= 0x3131 && r_char <= 0x318F) ? r_char - 0x3131 + 0x1100 : r_char;
-    ucschar unicode_e = (e_char >= 0x3131 && e_char <= 0x318F) ? e_char - 0x3131 + 0x1100 : e_char;
-    
-    return (hangul_is_choseong(unicode_r) && hangul_is_choseong(unicode_e));
-}
-
-static bool is_left_hand_keyboard(const HangulKeyboard* keyboard) {
-    /* 왼손 키보드 확인: u, i 키가 초성값을 가지는지 */
-    ucschar u_char = hangul_keyboard_map_to_char(keyboard, 0, 'u');
-    ucschar i_char = hangul_keyboard_map_to_char(keyboard, 0, 'i');
-    
-    /* 호환 자모를 유니코드 자모로 변환 후 체크 */
-    ucschar unicode_u = (u_char >= 0x3131 && u_char <= 0x318F) ? u_char - 0x3131 + 0x1100 : u_char;
-    ucschar unicode_i = (i_char >= 0x3131 && i_char <= 0x318F) ? i_char - 0x3131 + 0x1100 : i_char;
-    
-    return (hangul_is_choseong(unicode_u) && hangul_is_choseong(unicode_i));
-}
-
-static bool is_choseong_only_key(const HangulKeyboard* keyboard, int ascii) {
-    if (keyboard == NULL || ascii < 'a' || ascii > 'z') return false;
-    
-    /* 오른손 키보드 */
-    if (is_right_hand_keyboard(keyboard)) {
-        return strchr(right_hand_choseong_keys, ascii) != NULL;
-    }
-    /* 왼손 키보드 */
-    else if (is_left_hand_keyboard(keyboard)) {
-        return strchr(left_hand_choseong_keys, ascii) != NULL;
-    }
-    return false;
+static bool
+is_galmadeuli_keyboard(const HangulKeyboard* keyboard)
+{
+    /* 갈마들이 분류는 자판마다 한번만 계산해 둔다 */
+    return hangul_keyboard_get_galmadeuli(keyboard) != HANGUL_GALMADEULI_NONE;
 }
 
 /* 키보드 매핑 함수 - 갈마들이 지원 */
@@ -1716,8 +2949,11 @@ ucschar hangul_keyboard_get_mapping_galmadeuli(const HangulKeyboard* keyboard, i
     bool has_jungseong = (hic->buffer.jungseong != 0);
     bool has_jongseong = (hic->buffer.jongseong != 0);
     
+    bool is_right_hand =
+	hangul_keyboard_get_galmadeuli(keyboard) == HANGUL_GALMADEULI_RIGHT;
+
     /* 초성 전용 키 체크 - 강제로 새 글자 시작 */
-    bool is_force_choseong = is_choseong_only_key(keyboard, ascii);
+    bool is_force_choseong = hangul_keyboard_is_choseong_only_key(keyboard, ascii);
     
     /* 중성 입력 위치라면 캡스락 테이블 사용 (모음용) */
     if (!is_force_choseong && has_choseong && !has_jungseong && !has_jongseong) { table_id = 1; }
@@ -1764,7 +3000,7 @@ ucschar hangul_keyboard_get_mapping_galmadeuli(const HangulKeyboard* keyboard, i
         
         /* 입력된 문자가 자음이면 캡스락 테이블에서 모음 찾기 */
         bool is_consonant = false;
-        if (is_right_hand_keyboard(keyboard)) {
+        if (is_right_hand) {
             /* 오른손: 초성 또는 종성 */
             is_consonant = hangul_is_choseong(unicode_test) || hangul_is_jongseong(unicode_test);
         } else {
@@ -1787,7 +3023,7 @@ ucschar hangul_keyboard_get_mapping_galmadeuli(const HangulKeyboard* keyboard, i
             
             /* 조합 실패시 모음으로 변환 시도 */
             char lookup_ascii = ascii;
-            if (is_right_hand_keyboard(keyboard)) {
+            if (is_right_hand) {
                 /* 오른손: 대문자로 변환 */
                 lookup_ascii = ascii - 'a' + 'A';
             }
@@ -1809,7 +3045,7 @@ ucschar hangul_keyboard_get_mapping_galmadeuli(const HangulKeyboard* keyboard, i
     if (has_choseong && has_jungseong && !has_jongseong && ascii >= 'a' && ascii <= 'z') {
         /* 입력된 키를 중성으로 변환 시도 */
         char lookup_ascii = ascii;
-        if (is_right_hand_keyboard(keyboard)) {
+        if (is_right_hand) {
             lookup_ascii = ascii - 'a' + 'A';  /* 오른손: 대문자로 변환 */
         }
         
@@ -23,21 +23,70 @@
 #define countof(array) (sizeof (array) / sizeof ((array)[0]))
 #endif
 
+/* hangul_ctype()이 리턴하는 글자 분류 bit.
+ * 초성, 중성 채움 문자는 각각 L, V와 FILLER bit를 같이 가진다. */
+enum {
+    HANGUL_CTYPE_L      = 1 << 0,   /* 초성 */
+    HANGUL_CTYPE_V      = 1 << 1,   /* 중성 */
+    HANGUL_CTYPE_T      = 1 << 2,   /* 종성 */
+    HANGUL_CTYPE_LV     = 1 << 3,   /* 종성이 없는 음절 */
+    HANGUL_CTYPE_LVT    = 1 << 4,   /* 종성이 있는 음절 */
+    HANGUL_CTYPE_FILLER = 1 << 5,   /* 초성, 중성 채움 문자 */
+    HANGUL_CTYPE_CJAMO  = 1 << 6,   /* 호환 자모 */
+    HANGUL_CTYPE_MARK   = 1 << 7    /* 결합 문자, 방점 */
+};
+
+/* 라이브러리 안에서만 쓰는 데이터는 ELF에서 export하지 않는다.
+ * Windows DLL은 지정하지 않은 심볼을 export하지 않으므로 그대로 둔다. */
+#if defined(__GNUC__) && !defined(_WIN32) && !defined(__CYGWIN__)
+#define HANGUL_INTERNAL __attribute__((visibility("hidden")))
+#else
+#define HANGUL_INTERNAL
+#endif
+
+extern HANGUL_INTERNAL const unsigned char hangul_ctype_index[256];
+extern HANGUL_INTERNAL const unsigned char hangul_ctype_pages[][256];
+
+/* c의 HANGUL_CTYPE_* bit를 분기 없이 표에서 읽는다.
+ * BMP 밖의 글자는 0번 페이지(분류 없음)를 본다. */
+static inline unsigned
+hangul_ctype(ucschar c)
+{
+    unsigned page = hangul_ctype_index[(c >> 8) & 0xff] &
+		    -(unsigned)(c <= 0xffff);
+    return hangul_ctype_pages[page][c & 0xff];
+}
+
 ucschar hangul_jongseong_get_diff(ucschar prevjong, ucschar jong);
 
 ucschar hangul_choseong_to_jongseong(ucschar ch);
 ucschar hangul_jongseong_to_choseong(ucschar ch);
 void    hangul_jongseong_decompose(ucschar ch, ucschar* jong, ucschar* cho);
 
+enum {
+    HANGUL_GALMADEULI_NONE,
+    HANGUL_GALMADEULI_RIGHT,
+    HANGUL_GALMADEULI_LEFT
+};
+
 int     hangul_keyboard_get_type(const HangulKeyboard *keyboard);
 ucschar hangul_keyboard_combine(const HangulKeyboard* keyboard,
 	    unsigned id, ucschar first, ucschar second);
 ucschar hangul_keyboard_map_to_char(const HangulKeyboard* keyboard,
 	    int tableid, unsigned key);
+bool    hangul_keyboard_has_table(const HangulKeyboard* keyboard, int tableid);
+const ucschar* hangul_keyboard_get_table(const HangulKeyboard* keyboard,
+	    int tableid);
+const HangulCombination* hangul_keyboard_get_combination(
+	    const HangulKeyboard* keyboard, unsigned id);
+int     hangul_keyboard_get_galmadeuli(const HangulKeyboard* keyboard);
+bool    hangul_keyboard_is_choseong_only_key(const HangulKeyboard* keyboard,
+	    int ascii);
 
 ucschar hangul_keyboard_get_mapping_galmadeuli(const HangulKeyboard* keyboard, int ascii, HangulInputContext* hic);
 		
-int hangul_keyboard_list_init(const char* user_defined_keyboard_path);
+int hangul_keyboard_list_init(const char* user_defined_keyboard_path,
+			      unsigned n_threads);
 int hangul_keyboard_list_fini();
 
 const HangulKeyboard* hangul_keyboard_list_get_keyboard(const char* id);
@@ -23,15 +23,32 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <stddef.h>
 
 #if ENABLE_EXTERNAL_KEYBOARDS
 #include <locale.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #ifdef HAVE_GLOB_H
 #include <glob.h>
 #endif /* HAVE_GLOB_H */
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif /* HAVE_PTHREAD_H */
+#endif /* _WIN32 */
 #include <expat.h>
 #endif /* ENABLE_EXTERNAL_KEYBOARDS */
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HANGUL_KEYBOARD_USE_SSE2 1
+#endif
+
 #include "hangul-gettext.h"
 #include "hangul.h"
 #include "hangulinternals.h"
@@ -43,6 +60,51 @@
 #define strdup _strdup
 #endif /* _WIN32 */
 
+#if defined(_MSC_VER)
+#define hangul_atomic_load_ptr(p) \
+    ((void*)InterlockedCompareExchangePointer((PVOID volatile*)(p), NULL, NULL))
+static inline bool
+hangul_atomic_cas_ptr_impl(void* volatile* p, void** expected, void* desired)
+{
+    void* prev = InterlockedCompareExchangePointer(p, desired, *expected);
+    if (prev == *expected)
+	return true;
+    *expected = prev;
+    return false;
+}
+#define hangul_atomic_cas_ptr(p, expected, desired) \
+    hangul_atomic_cas_ptr_impl((void* volatile*)(p), (void**)(expected), (desired))
+#define hangul_atomic_exchange_ptr(p, v) \
+    InterlockedExchangePointer((PVOID volatile*)(p), (v))
+#define hangul_atomic_inc(p) InterlockedIncrement((LONG volatile*)(p))
+#define hangul_atomic_dec(p) InterlockedDecrement((LONG volatile*)(p))
+#define hangul_atomic_load_long(p) \
+    InterlockedCompareExchange((LONG volatile*)(p), 0, 0)
+#define hangul_atomic_try_lock(p) \
+    (InterlockedCompareExchange((LONG volatile*)(p), 1, 0) == 0)
+#define hangul_atomic_unlock(p) InterlockedExchange((LONG volatile*)(p), 0)
+#else
+#define hangul_atomic_load_ptr(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define hangul_atomic_cas_ptr(p, expected, desired) \
+    __atomic_compare_exchange_n((p), (expected), (desired), false, \
+				__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define hangul_atomic_exchange_ptr(p, v) \
+    __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define hangul_atomic_inc(p) __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define hangul_atomic_dec(p) __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define hangul_atomic_load_long(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define hangul_atomic_try_lock(p) \
+    (__atomic_exchange_n((p), 1, __ATOMIC_ACQUIRE) == 0)
+#define hangul_atomic_unlock(p) __atomic_store_n((p), 0, __ATOMIC_RELEASE)
+#endif
+
+#ifdef _WIN32
+#define hangul_thread_yield() SwitchToThread()
+#else
+#include <sched.h>
+#define hangul_thread_yield() sched_yield()
+#endif
+
 /**
  * @file hangulkeyboard.c
  */
@@ -59,10 +121,10 @@
  *
  * 키보드 파일의 로딩 순서는 시스템 파일을 먼저 로딩하고 사용자 파일을
  * 로딩한다. 따라서 한글 키보드 목록을 이터레이션하면 사용자 추가 자판은
- * 마지막에 나오게 된다. 사용자 자판 선택 알고리듬이 처음 나온 자판을
- * 인식하는 방식이므로 동일한 id를 가진 자판을 등록하면 먼저 등록된 자판만
- * 인식되므로 주의가 필요하다. 다시 말해서 시스템 자판과 같은 id를 가진
- * 자판은 등록하여 사용할 수 없다.
+ * 마지막에 나오게 된다. 동일한 id를 가진 자판이 여럿 있으면 마지막에
+ * 등록된 자판이 인식되므로, 시스템 자판과 같은 id를 가진 사용자 자판을
+ * 설치하면 사용자 자판이 시스템 자판을 대신한다. 두 자판 모두 목록에는
+ * 남아 있으므로 이터레이션하면 둘 다 나온다.
  */
 
 #define LIBHANGUL_KEYBOARD_DIR LIBHANGUL_DATA_DIR "/keyboards"
@@ -76,14 +138,48 @@ struct _HangulCombinationItem {
     ucschar code;
 };
 
+/* 조합 테이블의 perfect hash 인덱스
+ * 키는 hash로 먼저 bucket을 고르고, bucket마다 정해 둔 displacement로
+ * slot을 찾는다. 한 slot에는 한 키만 있으므로 한번만 비교하면 된다.
+ * slot에 키와 결과를 바로 두어서 테이블을 거치지 않고 한번에 읽는다. */
+typedef struct _HangulCombinationIndex {
+    uint32_t seed;
+    uint32_t bucket_mask;
+    uint32_t slot_mask;
+    uint32_t* keys;	    /* 0이면 빈 slot */
+    ucschar* codes;
+    uint16_t* displacement;
+} HangulCombinationIndex;
+
 struct _HangulCombination {
     size_t size;
     size_t size_alloced;
     HangulCombinationItem *table;
 
     bool is_static;
+
+    /* 내장 테이블은 처음 사용할 때 만들고, 파일에서 읽은 테이블은
+     * 읽기를 마칠 때 만든다 */
+    HangulCombinationIndex* index;
+
+    /* 여러 자판이 함께 쓰는 테이블이면 참조 수, 아니면 0 */
+    long refcount;
+    uint32_t hash;
+    HangulCombination* shared_next;
 };
 
+/* 키 입력마다 참조하는 자판 데이터를 한 블럭에 모아 둔 읽기 전용 배치.
+ * 자판 배열과 갈마들이 정보를 연속된 메모리에 두어 키 하나를 처리할 때
+ * 몇 개의 cache line만 읽도록 한다. 조합 테이블 인덱스는 복사하지 않고
+ * 조합 테이블의 것을 가리키므로, 같은 조합 테이블을 쓰는 자판들은 인덱스도
+ * 함께 쓴다. 자판 배열의 모든 코드가 BMP 안에 있을 때만 만들 수 있다. */
+typedef struct _HangulKeyboardLayout {
+    int galmadeuli;
+    uint32_t choseong_only_keys[4];
+    const uint16_t* table[4];	    /* NULL이면 없는 테이블 */
+    const HangulCombinationIndex* combination[4];  /* NULL이면 조합 테이블이 없음 */
+} HangulKeyboardLayout;
+
 struct _HangulKeyboard {
     char* id;
     char* name;
@@ -92,45 +188,87 @@ struct _HangulKeyboard {
 
     int type;
     bool is_static;
+
+    /* 갈마들이 한손 자판 여부와 초성 전용 키의 128bit mask.
+     * 자판 배열이 바뀔 때 다시 계산하여 키 입력마다 판단하지 않도록 한다. */
+    int galmadeuli;
+    uint32_t choseong_only_keys[4];
+
+    /* 처음 사용할 때 만들고, 자판 배열이 바뀌면 버린다 */
+    HangulKeyboardLayout* layout;
+
+    /* id와 이름만 읽어 둔 자판의 xml 파일. 처음 선택할 때 나머지를 읽고
+     * NULL로 바꾼다. */
+    char* path;
+
+    /* 다른 자판과 함께 쓰는 공유 테이블인 table의 bit mask */
+    unsigned shared_tables;
 };
 
-typedef struct _HangulKeyboardList {
+/* 초성 전용 키 mask의 해당 키 bit */
+#define HANGUL_KEY_MASK(key) (1u << ((key) & 0x1f))
+
+/* 자판 id로 자판을 찾는 hash 인덱스.
+ * open addressing을 사용하고, 같은 id가 여러번 들어오면 마지막에 넣은
+ * 자판으로 바꾼다. */
+typedef struct _HangulKeyboardIndex {
+    size_t n;
+    size_t size;		    /* 2의 거듭제곱, 0이면 빈 인덱스 */
+    const HangulKeyboard** slots;
+} HangulKeyboardIndex;
+
+/* 등록된 자판 목록.
+ * 한번 공개한 목록은 바꾸지 않고, 자판을 등록하거나 삭제할 때에는 새
+ * 목록을 만들어 바꾼다(copy-on-write). 따라서 읽는 쪽은 잠금 없이 목록을
+ * 읽을 수 있다. 이전 목록은 그 목록을 읽었을 수 있는 쓰레드가 모두
+ * 끝나면 해제한다. */
+typedef struct _HangulKeyboardList HangulKeyboardList;
+
+struct _HangulKeyboardList {
     size_t n;
     size_t nalloced;
     HangulKeyboard** keyboards;
-} HangulKeyboardList;
+    HangulKeyboardIndex index;
+
+    HangulKeyboardList* retired_next;
+    long retired_generation;	/* 이 목록을 바꿀 때의 세대 */
+};
 
 #include "hangulkeyboard.h"
 
-static const HangulCombination hangul_combination_default = {
+static HangulCombination hangul_combination_default = {
     countof(hangul_combination_table_default),
     countof(hangul_combination_table_default),
     (HangulCombinationItem*)hangul_combination_table_default,
-    true
+    true,
+    NULL
 };
 
-static const HangulCombination hangul_combination_romaja = {
+static HangulCombination hangul_combination_romaja = {
     countof(hangul_combination_table_romaja),
     countof(hangul_combination_table_romaja),
     (HangulCombinationItem*)hangul_combination_table_romaja,
-    true
+    true,
+    NULL
 };
 
-static const HangulCombination hangul_combination_full = {
+static HangulCombination hangul_combination_full = {
     countof(hangul_combination_table_full),
     countof(hangul_combination_table_full),
     (HangulCombinationItem*)hangul_combination_table_full,
-    true
+    true,
+    NULL
 };
 
-static const HangulCombination hangul_combination_ahn = {
+static HangulCombination hangul_combination_ahn = {
     countof(hangul_combination_table_ahn),
     countof(hangul_combination_table_ahn),
     (HangulCombinationItem*)hangul_combination_table_ahn,
-    true
+    true,
+    NULL
 };
 
-static const HangulKeyboard hangul_keyboard_2 = {
+static HangulKeyboard hangul_keyboard_2 = {
     (char*)"2",
     (char*)N_("Dubeolsik"),
     { (ucschar*)hangul_keyboard_table_2, NULL, NULL, NULL },
@@ -139,7 +277,7 @@ static const HangulKeyboard hangul_keyboard_2 = {
     true
 };
 
-static const HangulKeyboard hangul_keyboard_2y = {
+static HangulKeyboard hangul_keyboard_2y = {
     (char*)"2y",
     (char*)N_("Dubeolsik Yetgeul"),
     { (ucschar*)hangul_keyboard_table_2y, NULL, NULL, NULL },
@@ -148,7 +286,7 @@ static const HangulKeyboard hangul_keyboard_2y = {
     true
 };
 
-static const HangulKeyboard hangul_keyboard_32 = {
+static HangulKeyboard hangul_keyboard_32 = {
     (char*)"32",
     (char*)N_("Sebeolsik Dubeol Layout"),
     { (ucschar*)hangul_keyboard_table_32, NULL, NULL, NULL },
@@ -157,7 +295,7 @@ static const HangulKeyboard hangul_keyboard_32 = {
     true
 };
 
-static const HangulKeyboard hangul_keyboard_390 = {
+static HangulKeyboard hangul_keyboard_390 = {
     (char*)"39",
     (char*)N_("Sebeolsik 390"),
     { (ucschar*)hangul_keyboard_table_390, NULL, NULL, NULL },
@@ -166,7 +304,7 @@ static const HangulKeyboard hangul_keyboard_390 = {
     true
 };
 
-static const HangulKeyboard hangul_keyboard_3final = {
+static HangulKeyboard hangul_keyboard_3final = {
     (char*)"3f",
     (char*)N_("Sebeolsik Final"),
     { (ucschar*)hangul_keyboard_table_3final, NULL, NULL, NULL },
@@ -175,7 +313,7 @@ static const HangulKeyboard hangul_keyboard_3final = {
     true
 };
 
-static const HangulKeyboard hangul_keyboard_3sun = {
+static HangulKeyboard hangul_keyboard_3sun = {
     (char*)"3s",
     (char*)N_("Sebeolsik Noshift"),
     { (ucschar*)hangul_keyboard_table_3sun, NULL, NULL, NULL },
@@ -184,7 +322,7 @@ static const HangulKeyboard hangul_keyboard_3sun = {
     true
 };
 
-static const HangulKeyboard hangul_keyboard_3yet = {
+static HangulKeyboard hangul_keyboard_3yet = {
     (char*)"3y",
     (char*)N_("Sebeolsik Yetgeul"),
     { (ucschar*)hangul_keyboard_table_3yet, NULL, NULL, NULL },
@@ -193,7 +331,7 @@ static const HangulKeyboard hangul_keyboard_3yet = {
     true
 };
 
-static const HangulKeyboard hangul_keyboard_romaja = {
+static HangulKeyboard hangul_keyboard_romaja = {
     (char*)"ro",
     (char*)N_("Romaja"),
     { (ucschar*)hangul_keyboard_table_romaja, NULL, NULL, NULL },
@@ -202,7 +340,7 @@ static const HangulKeyboard hangul_keyboard_romaja = {
     true
 };
 
-static const HangulKeyboard hangul_keyboard_ahn = {
+static HangulKeyboard hangul_keyboard_ahn = {
     (char*)"ahn",
     (char*)N_("Ahnmatae"),
     { (ucschar*)hangul_keyboard_table_ahn, NULL, NULL, NULL },
@@ -211,29 +349,38 @@ static const HangulKeyboard hangul_keyboard_ahn = {
     true
 };
 
-static const HangulCombination hangul_combination_1hand = {
+static HangulCombination hangul_combination_1hand = {
     countof(hangul_combination_table_1hand),
     countof(hangul_combination_table_1hand),
     (HangulCombinationItem*)hangul_combination_table_1hand,
-    true
+    true,
+    NULL
 };
 
-static const HangulKeyboard hangul_keyboard_1hand_l = {
+static HangulKeyboard hangul_keyboard_1hand_l = {
     (char*)"1hand-left",
     (char*)N_("One Hand Left"),
     { (ucschar*)hangul_keyboard_1hand_l_table, (ucschar*)hangul_keyboard_table_capslock_l_layout, NULL, NULL },
     { (HangulCombination*)&hangul_combination_1hand, NULL, NULL, NULL },
     HANGUL_KEYBOARD_TYPE_JASO,
-    true
+    true,
+    HANGUL_GALMADEULI_LEFT,
+    { 0, 0, 0, HANGUL_KEY_MASK('y') | HANGUL_KEY_MASK('u') | HANGUL_KEY_MASK('h') |
+	       HANGUL_KEY_MASK('j') | HANGUL_KEY_MASK('n') | HANGUL_KEY_MASK('m') |
+	       HANGUL_KEY_MASK('i') | HANGUL_KEY_MASK('k') | HANGUL_KEY_MASK('l') }
 };
 
-static const HangulKeyboard hangul_keyboard_1hand_r = {
+static HangulKeyboard hangul_keyboard_1hand_r = {
     (char*)"1hand-right",
     (char*)N_("One Hand Right"),
     { (ucschar*)hangul_keyboard_1hand_r_table, (ucschar*)hangul_keyboard_table_capslock_r_layout, NULL, NULL },
     { (HangulCombination*)&hangul_combination_1hand, NULL, NULL, NULL },
     HANGUL_KEYBOARD_TYPE_JASO,
-    true
+    true,
+    HANGUL_GALMADEULI_RIGHT,
+    { 0, 0, 0, HANGUL_KEY_MASK('e') | HANGUL_KEY_MASK('r') | HANGUL_KEY_MASK('t') |
+	       HANGUL_KEY_MASK('d') | HANGUL_KEY_MASK('f') | HANGUL_KEY_MASK('g') |
+	       HANGUL_KEY_MASK('c') | HANGUL_KEY_MASK('v') | HANGUL_KEY_MASK('b') }
 };
 
 static const HangulKeyboard* hangul_builtin_keyboards[] = {
@@ -251,7 +398,74 @@ static const HangulKeyboard* hangul_builtin_keyboards[] = {
 };
 static const unsigned int hangul_builtin_keyboard_count = countof(hangul_builtin_keyboards);
 
-static HangulKeyboardList hangul_keyboards = { 0, 0, NULL };
+#if ENABLE_EXTERNAL_KEYBOARDS
+#define HANGUL_KEYBOARD_BUNDLE_FILE	    "hangul-keyboards.bin"
+#define HANGUL_KEYBOARD_BUNDLE_VERSION	    1
+#define HANGUL_KEYBOARD_BUNDLE_BYTE_ORDER   0x01020304
+
+/* 키보드 번들 파일 포맷
+ * 키보드 디렉토리의 xml 파일들을 미리 읽어서 하나로 만든 파일이다.
+ * 모든 값은 만든 시스템의 byte order를 따르는 uint32_t이고 offset은 파일
+ * 처음부터의 위치다. 자판 배열과 정렬된 조합 테이블은 메모리에서 사용하는
+ * 형태 그대로 저장하므로 파일을 mmap한 후 바로 사용한다.
+ *
+ *   header | entry[n_keyboards] | 자판 배열, 조합 테이블 | 문자열
+ */
+typedef struct _HangulKeyboardBundleHeader {
+    char     magic[4];		/* "HKBD" */
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t size;		/* 파일 크기 */
+    uint32_t n_keyboards;
+    uint32_t n_sources;		/* 번들을 만들 때 디렉토리에 있던 xml 파일 수 */
+} HangulKeyboardBundleHeader;
+
+typedef struct _HangulKeyboardBundleEntry {
+    uint32_t id;		/* 문자열 offset */
+    uint32_t name;		/* 문자열 offset, 0이면 이름이 없음 */
+    uint32_t type;
+    uint32_t table[4];		/* ucschar[0x80]의 offset, 0이면 없는 테이블 */
+    uint32_t combination[4];	/* HangulCombinationItem 배열의 offset */
+    uint32_t combination_size[4];
+} HangulKeyboardBundleEntry;
+
+/* 번들에서 읽은 자판들. 자판의 배열과 조합 테이블은 번들의 메모리를
+ * 그대로 가리키므로 자판은 is_static으로 두고 hangul_fini()에서 번들과
+ * 함께 해제한다. */
+typedef struct _HangulKeyboardBundle HangulKeyboardBundle;
+
+struct _HangulKeyboardBundle {
+    void* data;
+    size_t size;
+    bool is_mapped;
+    unsigned n;
+    HangulKeyboard* keyboards;
+    HangulCombination* combinations;
+    HangulKeyboardBundle* next;
+};
+
+/* 읽어 둔 번들 목록, 쓰는 쪽 잠금으로 보호한다 */
+static HangulKeyboardBundle* hangul_keyboard_bundles = NULL;
+
+static void hangul_keyboard_bundle_delete(HangulKeyboardBundle* bundle);
+#endif /* ENABLE_EXTERNAL_KEYBOARDS */
+
+/* 현재 공개된 자판 목록, NULL이면 등록된 자판이 없다 */
+static HangulKeyboardList* hangul_keyboards = NULL;
+/* 바꾼 후 아직 해제하지 못한 이전 목록들과 그 수, 쓰는 쪽 잠금으로
+ * 보호한다. 수가 이보다 많아지면 해제할 수 있을 때까지 기다린다. */
+#define HANGUL_KEYBOARD_LIST_MAX_RETIRED 8
+static HangulKeyboardList* hangul_keyboard_list_retired = NULL;
+static unsigned hangul_keyboard_list_n_retired = 0;
+/* 목록을 읽는 쓰레드는 읽기 시작할 때의 세대에 등록한다. 세대마다 홀짝으로
+ * 나누어 읽고 있는 쓰레드의 수를 센다. */
+static long hangul_keyboard_list_generation = 0;
+static long hangul_keyboard_list_readers[2] = { 0, 0 };
+/* 목록을 바꾸는 쓰레드들 사이의 잠금 */
+static long hangul_keyboard_list_writer_lock = 0;
+
+/* 내장 자판의 인덱스는 처음 찾을 때 만든다 */
+static HangulKeyboardIndex* hangul_builtin_keyboard_index = NULL;
 
 typedef struct _HangulKeyboardLoadContext {
     const char* path_stack[64];
@@ -260,12 +474,236 @@ typedef struct _HangulKeyboardLoadContext {
     int current_id;
     const char* current_element;
     bool save_name;
+    bool scan_only;	    /* id, type, 이름만 읽는다 */
+    void* parser;
 } HangulKeyboardLoadContext;
 
 #if ENABLE_EXTERNAL_KEYBOARDS
 static void    hangul_keyboard_parse_file(const char* path, HangulKeyboardLoadContext* context);
 #endif // ENABLE_EXTERNAL_KEYBOARDS
-static bool    hangul_keyboard_list_append(HangulKeyboard* keyboard);
+static bool    hangul_keyboard_list_append(HangulKeyboardList* list,
+					    HangulKeyboard* keyboard);
+static bool    hangul_keyboard_shared_combination_release(HangulCombination* combination);
+static HangulKeyboardList* hangul_keyboard_list_new();
+static void    hangul_keyboard_list_delete(HangulKeyboardList* list);
+
+static inline uint32_t
+hangul_combination_hash(uint32_t key, uint32_t seed)
+{
+    key ^= seed;
+    key ^= key >> 16;
+    key *= 0x7feb352d;
+    key ^= key >> 15;
+    key *= 0x846ca68b;
+    key ^= key >> 16;
+    return key;
+}
+
+static inline uint32_t
+hangul_combination_slot(uint32_t key, uint32_t seed, uint32_t displacement)
+{
+    uint32_t h = hangul_combination_hash(key, ~seed);
+    return h + displacement * ((h >> 16) | 1);
+}
+
+static inline ucschar
+hangul_combination_index_lookup(const HangulCombinationIndex* index,
+				uint32_t key)
+{
+    uint32_t h = hangul_combination_hash(key, index->seed);
+    uint32_t d = index->displacement[h & index->bucket_mask];
+    uint32_t slot = hangul_combination_slot(key, index->seed, d) &
+		    index->slot_mask;
+
+    if (index->keys[slot] == key)
+	return index->codes[slot];
+
+    return 0;
+}
+
+static bool
+hangul_combination_index_try(HangulCombinationIndex* index,
+			     const HangulCombination* combination,
+			     uint32_t* order, uint32_t* bucket_start)
+{
+    uint32_t nbuckets = index->bucket_mask + 1;
+    uint32_t nslots = index->slot_mask + 1;
+    uint32_t* bucket_size = bucket_start + nbuckets + 1;
+    uint32_t* slot_of = bucket_size + nbuckets;
+    uint32_t* sorted = slot_of + combination->size;
+    uint32_t i, j, b, n;
+
+    memset(index->displacement, 0, sizeof(uint16_t) * nbuckets);
+    memset(index->keys, 0, sizeof(uint32_t) * nslots);
+    memset(index->codes, 0, sizeof(ucschar) * nslots);
+
+    /* 키를 bucket 별로 모은다 */
+    memset(bucket_start, 0, sizeof(uint32_t) * (nbuckets + 1));
+    for (i = 0; i < combination->size; i++) {
+	b = hangul_combination_hash(combination->table[i].key, index->seed) &
+	    index->bucket_mask;
+	bucket_start[b + 1]++;
+    }
+    for (b = 0; b < nbuckets; b++) {
+	bucket_start[b + 1] += bucket_start[b];
+	bucket_size[b] = 0;
+    }
+    for (i = 0; i < combination->size; i++) {
+	b = hangul_combination_hash(combination->table[i].key, index->seed) &
+	    index->bucket_mask;
+	order[bucket_start[b] + bucket_size[b]++] = i;
+    }
+
+    /* 큰 bucket부터 자리를 잡는다 */
+    j = 0;
+    for (b = 0; b < nbuckets; b++) {
+	if (bucket_size[b] > j)
+	    j = bucket_size[b];
+    }
+    for (n = 0; j > 0; j--) {
+	for (b = 0; b < nbuckets; b++) {
+	    if (bucket_size[b] == j)
+		sorted[n++] = b;
+	}
+    }
+    nbuckets = n;
+
+    for (n = 0; n < nbuckets; n++) {
+	uint32_t* items;
+	uint32_t size;
+	uint32_t d, n2;
+
+	b = sorted[n];
+	size = bucket_size[b];
+
+	/* 같은 키가 여러번 있으면 처음 것만 사용한다 */
+	items = order + bucket_start[b];
+	for (i = 0, n2 = 0; i < size; i++) {
+	    for (j = 0; j < n2; j++) {
+		if (combination->table[items[i]].key ==
+		    combination->table[items[j]].key)
+		    break;
+	    }
+	    if (j == n2)
+		items[n2++] = items[i];
+	}
+	size = n2;
+
+	for (d = 0; d <= UINT16_MAX; d++) {
+	    for (i = 0; i < size; i++) {
+		uint32_t slot;
+		slot = hangul_combination_slot(combination->table[items[i]].key,
+					       index->seed, d) & index->slot_mask;
+		if (index->keys[slot] != 0)
+		    break;
+		for (j = 0; j < i; j++) {
+		    if (slot_of[j] == slot)
+			break;
+		}
+		if (j < i)
+		    break;
+		slot_of[i] = slot;
+	    }
+
+	    if (i == size)
+		break;
+	}
+
+	if (d > UINT16_MAX)
+	    return false;
+
+	index->displacement[b] = d;
+	for (i = 0; i < size; i++) {
+	    index->keys[slot_of[i]] = combination->table[items[i]].key;
+	    index->codes[slot_of[i]] = combination->table[items[i]].code;
+	}
+    }
+
+    return true;
+}
+
+/* 조합 테이블의 perfect hash 인덱스를 만든다. 만들 수 없으면 NULL을
+ * 리턴하고, 이때는 bsearch로 찾는다. 키가 0이면 빈 slot과 구별할 수 없으므로
+ * 인덱스를 만들지 않는다. */
+static HangulCombinationIndex*
+hangul_combination_index_new(const HangulCombination* combination)
+{
+    HangulCombinationIndex* index;
+    uint32_t nbuckets;
+    uint32_t nslots;
+    uint32_t* work;
+    uint32_t seed;
+    size_t i;
+
+    if (combination == NULL || combination->size == 0 ||
+	combination->size >= UINT16_MAX / 2)
+	return NULL;
+
+    for (i = 0; i < combination->size; i++) {
+	if (combination->table[i].key == 0)
+	    return NULL;
+    }
+
+    nslots = 8;
+    while (nslots < combination->size * 2)
+	nslots <<= 1;
+    nbuckets = nslots / 4;
+
+    index = malloc(sizeof(HangulCombinationIndex) +
+		   (sizeof(uint32_t) + sizeof(ucschar)) * nslots +
+		   sizeof(uint16_t) * nbuckets);
+    if (index == NULL)
+	return NULL;
+
+    work = malloc(sizeof(uint32_t) * (combination->size * 2 + nbuckets * 3 + 1));
+    if (work == NULL) {
+	free(index);
+	return NULL;
+    }
+
+    index->bucket_mask = nbuckets - 1;
+    index->slot_mask = nslots - 1;
+    index->keys = (uint32_t*)(index + 1);
+    index->codes = (ucschar*)(index->keys + nslots);
+    index->displacement = (uint16_t*)(index->codes + nslots);
+
+    for (seed = 0; seed < 16; seed++) {
+	index->seed = seed * 0x9e3779b9;
+	if (hangul_combination_index_try(index, combination,
+					 work, work + combination->size)) {
+	    free(work);
+	    return index;
+	}
+    }
+
+    free(work);
+    free(index);
+    return NULL;
+}
+
+/* 내장 테이블의 인덱스는 처음 사용할 때 만든다. 여러 쓰레드에서
+ * 동시에 만들면 먼저 등록한 것을 사용한다. */
+static const HangulCombinationIndex*
+hangul_combination_get_index(HangulCombination* combination)
+{
+    HangulCombinationIndex* index;
+    HangulCombinationIndex* expected = NULL;
+
+    index = hangul_atomic_load_ptr(&combination->index);
+    if (index != NULL || !combination->is_static)
+	return index;
+
+    index = hangul_combination_index_new(combination);
+    if (index == NULL)
+	return NULL;
+
+    if (!hangul_atomic_cas_ptr(&combination->index, &expected, index)) {
+	free(index);
+	index = expected;
+    }
+
+    return index;
+}
 
 HangulCombination*
 hangul_combination_new()
@@ -276,6 +714,10 @@ hangul_combination_new()
 	combination->size_alloced = 0;
 	combination->table = NULL;
 	combination->is_static = false;
+	combination->index = NULL;
+	combination->refcount = 0;
+	combination->hash = 0;
+	combination->shared_next = NULL;
 	return combination;
     }
 
@@ -291,9 +733,15 @@ hangul_combination_delete(HangulCombination *combination)
     if (combination->is_static)
 	return;
 
+    /* 공유 테이블은 마지막으로 쓰던 자판이 지울 때 해제한다 */
+    if (combination->refcount > 0 &&
+	!hangul_keyboard_shared_combination_release(combination))
+	return;
+
     if (combination->table != NULL)
 	free(combination->table);
 
+    free(combination->index);
     free(combination);
 }
 
@@ -323,6 +771,9 @@ hangul_combination_set_data(HangulCombination* combination,
 	    combination->table[i].key = hangul_combination_make_key(first[i], second[i]);
 	    combination->table[i].code = result[i];
 	}
+
+	free(combination->index);
+	combination->index = hangul_combination_index_new(combination);
 	return true;
     }
 
@@ -340,6 +791,10 @@ hangul_combination_add_item(HangulCombination* combination,
     if (combination->is_static)
 	return false;
 
+    /* 테이블이 바뀌면 인덱스는 읽기를 마친 후 다시 만든다 */
+    free(combination->index);
+    combination->index = NULL;
+
     if (combination->size >= combination->size_alloced) {
 	size_t size_need = combination->size_alloced * 2;
 	if (size_need == 0) {
@@ -393,13 +848,17 @@ hangul_combination_sort(HangulCombination* combination)
 
     qsort(combination->table, combination->size,
 	sizeof(combination->table[0]), hangul_combination_cmp);
+
+    free(combination->index);
+    combination->index = hangul_combination_index_new(combination);
 }
 #endif // ENABLE_EXTERNAL_KEYBOARDS
 
 static ucschar
-hangul_combination_combine(const HangulCombination* combination,
+hangul_combination_combine(HangulCombination* combination,
 			   ucschar first, ucschar second)
 {
+    const HangulCombinationIndex* index;
     HangulCombinationItem *res;
     HangulCombinationItem key;
 
@@ -407,6 +866,11 @@ hangul_combination_combine(const HangulCombination* combination,
 	return 0;
 
     key.key = hangul_combination_make_key(first, second);
+
+    index = hangul_combination_get_index(combination);
+    if (index != NULL)
+	return hangul_combination_index_lookup(index, key.key);
+
     res = bsearch(&key, combination->table, combination->size,
 	          sizeof(combination->table[0]), hangul_combination_cmp);
     if (res != NULL)
@@ -415,6 +879,356 @@ hangul_combination_combine(const HangulCombination* combination,
     return 0;
 }
 
+/* 자판 배열의 코드를 16bit로 줄여서 한 블럭에 복사한다. 16bit에 들어가지
+ * 않는 코드가 있거나 조합 테이블의 인덱스를 만들 수 없으면 NULL을 리턴하고,
+ * 이때는 원래의 테이블을 그대로 사용한다. */
+static HangulKeyboardLayout*
+hangul_keyboard_layout_new(const HangulKeyboard* keyboard)
+{
+    HangulKeyboardLayout* layout;
+    size_t n16 = 0;
+    uint16_t* p16;
+    unsigned i, j;
+
+    for (i = 0; i < countof(keyboard->table); ++i) {
+	const ucschar* table = keyboard->table[i];
+	if (table == NULL)
+	    continue;
+
+	for (j = 0; j < HANGUL_KEYBOARD_TABLE_SIZE; ++j) {
+	    if (table[j] > UINT16_MAX)
+		return NULL;
+	}
+	n16 += HANGUL_KEYBOARD_TABLE_SIZE;
+    }
+
+    layout = malloc(sizeof(HangulKeyboardLayout) + sizeof(uint16_t) * n16);
+    if (layout == NULL)
+	return NULL;
+
+    for (i = 0; i < countof(keyboard->combination); ++i) {
+	HangulCombination* combination = keyboard->combination[i];
+	if (combination == NULL || combination->size == 0) {
+	    layout->combination[i] = NULL;
+	    continue;
+	}
+
+	layout->combination[i] = hangul_combination_get_index(combination);
+	if (layout->combination[i] == NULL) {
+	    free(layout);
+	    return NULL;
+	}
+    }
+
+    p16 = (uint16_t*)(layout + 1);
+
+    layout->galmadeuli = keyboard->galmadeuli;
+    memcpy(layout->choseong_only_keys, keyboard->choseong_only_keys,
+	   sizeof(layout->choseong_only_keys));
+
+    for (i = 0; i < countof(keyboard->table); ++i) {
+	const ucschar* table = keyboard->table[i];
+	if (table == NULL) {
+	    layout->table[i] = NULL;
+	    continue;
+	}
+
+	for (j = 0; j < HANGUL_KEYBOARD_TABLE_SIZE; ++j) {
+	    p16[j] = table[j];
+	}
+	layout->table[i] = p16;
+	p16 += HANGUL_KEYBOARD_TABLE_SIZE;
+    }
+
+    return layout;
+}
+
+/* 16bit로 줄일 수 없는 자판은 이 값을 기록해 두어 다시 만들지 않는다. */
+static HangulKeyboardLayout hangul_keyboard_layout_none;
+
+static void
+hangul_keyboard_layout_delete(HangulKeyboardLayout* layout)
+{
+    if (layout != &hangul_keyboard_layout_none)
+	free(layout);
+}
+
+/* 자판의 배치는 처음 사용할 때 만든다. 여러 쓰레드에서 동시에 만들면
+ * 먼저 등록한 것을 사용한다. */
+static const HangulKeyboardLayout*
+hangul_keyboard_get_layout(const HangulKeyboard* keyboard)
+{
+    HangulKeyboard* mutable_keyboard = (HangulKeyboard*)keyboard;
+    HangulKeyboardLayout* layout;
+    HangulKeyboardLayout* expected = NULL;
+
+    layout = hangul_atomic_load_ptr(&mutable_keyboard->layout);
+    if (layout == NULL) {
+	layout = hangul_keyboard_layout_new(keyboard);
+	if (layout == NULL)
+	    layout = &hangul_keyboard_layout_none;
+
+	if (!hangul_atomic_cas_ptr(&mutable_keyboard->layout, &expected, layout)) {
+	    hangul_keyboard_layout_delete(layout);
+	    layout = expected;
+	}
+    }
+
+    if (layout == &hangul_keyboard_layout_none)
+	return NULL;
+
+    return layout;
+}
+
+/* 자판 배열이나 조합 테이블이 바뀌면 배치를 버리고 다음에 다시 만든다. */
+static void
+hangul_keyboard_clear_layout(HangulKeyboard* keyboard)
+{
+    hangul_keyboard_layout_delete(keyboard->layout);
+    keyboard->layout = NULL;
+}
+
+static inline ucschar
+hangul_keyboard_layout_combine(const HangulCombinationIndex* index,
+			       ucschar first, ucschar second)
+{
+    if (index == NULL)
+	return 0;
+
+    return hangul_combination_index_lookup(index,
+		hangul_combination_make_key(first, second));
+}
+
+/* 내용이 같은 자판 배열과 조합 테이블은 한번만 저장해 두고 여러 자판이
+ * 참조 수를 세어 함께 쓴다. 파일에서 읽는 자판은 몇 개의 키만 다르거나
+ * 같은 조합 테이블을 쓰는 경우가 많으므로, 자판을 많이 읽을 때 메모리를
+ * 줄일 수 있다. 공유 테이블은 바꾸지 않으며, 바꿔야 하면 먼저 복사한다. */
+typedef struct _HangulKeyboardSharedTable HangulKeyboardSharedTable;
+
+struct _HangulKeyboardSharedTable {
+    HangulKeyboardSharedTable* next;
+    uint32_t hash;
+    long refcount;
+    ucschar table[HANGUL_KEYBOARD_TABLE_SIZE];
+};
+
+#define HANGUL_KEYBOARD_SHARED_BUCKETS 64
+
+static HangulKeyboardSharedTable* hangul_keyboard_shared_tables[HANGUL_KEYBOARD_SHARED_BUCKETS];
+static HangulCombination* hangul_keyboard_shared_combinations[HANGUL_KEYBOARD_SHARED_BUCKETS];
+/* 공유 테이블을 얻는 것은 자판 목록의 writer lock 안에서만 일어나지만,
+ * 놓는 것은 그렇지 않다. hangul_keyboard_list_unregister_keyboard()로 뺀
+ * 자판은 호출한 쪽이 lock 없이 hangul_keyboard_delete()나
+ * hangul_keyboard_set_value()를 부르므로, 다른 쓰레드가 자판을 읽으면서
+ * 공유 테이블을 얻는 것과 동시에 참조 수와 버킷이 바뀔 수 있다.
+ * 그래서 목록의 lock과 따로 잠근다. */
+static long hangul_keyboard_shared_lock = 0;
+
+static void
+hangul_keyboard_shared_lock_acquire()
+{
+    while (!hangul_atomic_try_lock(&hangul_keyboard_shared_lock))
+	hangul_thread_yield();
+}
+
+static void
+hangul_keyboard_shared_lock_release()
+{
+    hangul_atomic_unlock(&hangul_keyboard_shared_lock);
+}
+
+static HangulKeyboardSharedTable*
+hangul_keyboard_shared_table_from(ucschar* table)
+{
+    return (HangulKeyboardSharedTable*)
+	((char*)table - offsetof(HangulKeyboardSharedTable, table));
+}
+
+static void
+hangul_keyboard_shared_table_release(ucschar* table)
+{
+    HangulKeyboardSharedTable* shared = hangul_keyboard_shared_table_from(table);
+    HangulKeyboardSharedTable** p;
+
+    hangul_keyboard_shared_lock_acquire();
+    shared->refcount--;
+    if (shared->refcount > 0) {
+	hangul_keyboard_shared_lock_release();
+	return;
+    }
+
+    p = &hangul_keyboard_shared_tables[shared->hash % HANGUL_KEYBOARD_SHARED_BUCKETS];
+    while (*p != shared)
+	p = &(*p)->next;
+    *p = shared->next;
+    hangul_keyboard_shared_lock_release();
+
+    free(shared);
+}
+
+/* 참조 수를 줄이고, 더 이상 쓰는 자판이 없으면 공유 목록에서 빼고
+ * true를 리턴한다. 이때는 부르는 쪽에서 테이블을 해제한다. */
+static bool
+hangul_keyboard_shared_combination_release(HangulCombination* combination)
+{
+    HangulCombination** p;
+
+    hangul_keyboard_shared_lock_acquire();
+    combination->refcount--;
+    if (combination->refcount > 0) {
+	hangul_keyboard_shared_lock_release();
+	return false;
+    }
+
+    p = &hangul_keyboard_shared_combinations[combination->hash % HANGUL_KEYBOARD_SHARED_BUCKETS];
+    while (*p != combination)
+	p = &(*p)->shared_next;
+    *p = combination->shared_next;
+    hangul_keyboard_shared_lock_release();
+
+    return true;
+}
+
+#if ENABLE_EXTERNAL_KEYBOARDS
+static uint32_t
+hangul_keyboard_data_hash(const void* data, size_t size)
+{
+    /* FNV-1a */
+    const unsigned char* p = data;
+    uint32_t h = 2166136261u;
+    size_t i;
+    for (i = 0; i < size; ++i) {
+	h ^= p[i];
+	h *= 16777619u;
+    }
+    return h;
+}
+
+/* table과 내용이 같은 공유 테이블을 찾거나 새로 만들어 리턴한다 */
+static ucschar*
+hangul_keyboard_shared_table_get(const ucschar* table)
+{
+    const size_t size = sizeof(ucschar) * HANGUL_KEYBOARD_TABLE_SIZE;
+    uint32_t hash = hangul_keyboard_data_hash(table, size);
+    HangulKeyboardSharedTable** bucket;
+    HangulKeyboardSharedTable* shared;
+
+    bucket = &hangul_keyboard_shared_tables[hash % HANGUL_KEYBOARD_SHARED_BUCKETS];
+
+    hangul_keyboard_shared_lock_acquire();
+    for (shared = *bucket; shared != NULL; shared = shared->next) {
+	if (shared->hash == hash && memcmp(shared->table, table, size) == 0)
+	    break;
+    }
+
+    if (shared == NULL) {
+	shared = malloc(sizeof(HangulKeyboardSharedTable));
+	if (shared == NULL) {
+	    hangul_keyboard_shared_lock_release();
+	    return NULL;
+	}
+	memcpy(shared->table, table, size);
+	shared->hash = hash;
+	shared->refcount = 0;
+	shared->next = *bucket;
+	*bucket = shared;
+    }
+
+    shared->refcount++;
+    hangul_keyboard_shared_lock_release();
+
+    return shared->table;
+}
+
+/* combination과 내용이 같은 공유 조합 테이블이 있으면 combination을
+ * 지우고 그것을 리턴한다. 없으면 combination을 공유 목록에 넣는다.
+ * combination은 정렬을 마친 것이어야 한다. */
+static HangulCombination*
+hangul_keyboard_shared_combination_get(HangulCombination* combination)
+{
+    HangulCombination** bucket;
+    HangulCombination* shared;
+    size_t size;
+    uint32_t hash;
+
+    if (combination->is_static || combination->refcount > 0)
+	return combination;
+
+    size = sizeof(combination->table[0]) * combination->size;
+    hash = hangul_keyboard_data_hash(combination->table, size);
+    bucket = &hangul_keyboard_shared_combinations[hash % HANGUL_KEYBOARD_SHARED_BUCKETS];
+
+    hangul_keyboard_shared_lock_acquire();
+    for (shared = *bucket; shared != NULL; shared = shared->shared_next) {
+	if (shared->hash == hash && shared->size == combination->size &&
+	    memcmp(shared->table, combination->table, size) == 0)
+	    break;
+    }
+
+    if (shared != NULL) {
+	shared->refcount++;
+	hangul_keyboard_shared_lock_release();
+	hangul_combination_delete(combination);
+	return shared;
+    }
+
+    /* 더 늘어나지 않으므로 남는 공간은 돌려준다 */
+    if (combination->size > 0 && combination->size < combination->size_alloced) {
+	HangulCombinationItem* table = realloc(combination->table, size);
+	if (table != NULL) {
+	    combination->table = table;
+	    combination->size_alloced = combination->size;
+	}
+    }
+
+    combination->hash = hash;
+    combination->refcount = 1;
+    combination->shared_next = *bucket;
+    *bucket = combination;
+    hangul_keyboard_shared_lock_release();
+
+    return combination;
+}
+
+/* 파일에서 읽은 자판의 테이블을 공유 테이블로 바꾼다.
+ * 파서 쓰레드가 아니라 hangul_keyboard_list_load_files()에서 쓰레드를 join한
+ * 후에, 또는 hangul_keyboard_load()에서 writer lock을 잡은 채로 부르며,
+ * 자판을 다른 쓰레드에 공개하기 전에 불러야 한다. */
+static void
+hangul_keyboard_share_tables(HangulKeyboard* keyboard)
+{
+    unsigned i;
+
+    if (keyboard->is_static)
+	return;
+
+    /* 배치는 조합 테이블의 인덱스를 가리키므로 테이블을 바꾸기 전에 버린다 */
+    hangul_keyboard_clear_layout(keyboard);
+
+    for (i = 0; i < countof(keyboard->table); ++i) {
+	if (keyboard->table[i] == NULL ||
+	    (keyboard->shared_tables & (1u << i)) != 0)
+	    continue;
+
+	ucschar* shared = hangul_keyboard_shared_table_get(keyboard->table[i]);
+	if (shared == NULL)
+	    continue;
+
+	free(keyboard->table[i]);
+	keyboard->table[i] = shared;
+	keyboard->shared_tables |= 1u << i;
+    }
+
+    for (i = 0; i < countof(keyboard->combination); ++i) {
+	if (keyboard->combination[i] == NULL)
+	    continue;
+
+	keyboard->combination[i] =
+	    hangul_keyboard_shared_combination_get(keyboard->combination[i]);
+    }
+}
+#endif /* ENABLE_EXTERNAL_KEYBOARDS */
+
 HangulKeyboard*
 hangul_keyboard_new()
 {
@@ -438,6 +1252,12 @@ hangul_keyboard_new()
     keyboard->type = HANGUL_KEYBOARD_TYPE_JAMO;
     keyboard->is_static = false;
 
+    keyboard->galmadeuli = HANGUL_GALMADEULI_NONE;
+    memset(keyboard->choseong_only_keys, 0, sizeof(keyboard->choseong_only_keys));
+    keyboard->layout = NULL;
+    keyboard->path = NULL;
+    keyboard->shared_tables = 0;
+
     return keyboard;
 }
 
@@ -479,13 +1299,251 @@ hangul_keyboard_map_to_char(const HangulKeyboard* keyboard, int tableid, unsigne
     if (key >= HANGUL_KEYBOARD_TABLE_SIZE)
 	return 0;
 
-    ucschar* table = keyboard->table[tableid];
+    const HangulKeyboardLayout* layout = hangul_keyboard_get_layout(keyboard);
+    if (layout != NULL) {
+	const uint16_t* table = layout->table[tableid];
+	return table != NULL ? table[key] : 0;
+    }
+
+    ucschar* table = keyboard->table[tableid];
     if (table == NULL)
 	return 0;
 
     return table[key];
 }
 
+#ifdef HANGUL_KEYBOARD_USE_SSE2
+/* 16개의 키를 한번에 변환한다. 모두 ASCII인지 한번에 확인하고,
+ * 16bit 테이블에서 읽은 값 중 0인 것은 키 값으로 바꾼 후 32bit로 넓혀서
+ * 저장한다. ASCII가 아닌 키가 있으면 false를 리턴한다. */
+static bool
+hangul_keyboard_map_block_sse2(const uint16_t* table, ucschar* dest,
+			       const unsigned char* src)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i keys = _mm_loadu_si128((const __m128i*)src);
+    if (_mm_movemask_epi8(keys) != 0)
+	return false;
+
+    __m128i lo = _mm_setr_epi16(table[src[0]], table[src[1]],
+				table[src[2]], table[src[3]],
+				table[src[4]], table[src[5]],
+				table[src[6]], table[src[7]]);
+    __m128i hi = _mm_setr_epi16(table[src[8]], table[src[9]],
+				table[src[10]], table[src[11]],
+				table[src[12]], table[src[13]],
+				table[src[14]], table[src[15]]);
+
+    lo = _mm_or_si128(lo, _mm_and_si128(_mm_cmpeq_epi16(lo, zero),
+					_mm_unpacklo_epi8(keys, zero)));
+    hi = _mm_or_si128(hi, _mm_and_si128(_mm_cmpeq_epi16(hi, zero),
+					_mm_unpackhi_epi8(keys, zero)));
+
+    _mm_storeu_si128((__m128i*)(dest + 0), _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128((__m128i*)(dest + 4), _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128((__m128i*)(dest + 8), _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128((__m128i*)(dest + 12), _mm_unpackhi_epi16(hi, zero));
+    return true;
+}
+#endif /* HANGUL_KEYBOARD_USE_SSE2 */
+
+static void
+hangul_keyboard_map_keys_16(const uint16_t* table, ucschar* dest,
+			    const unsigned char* src, int n)
+{
+    int i = 0;
+
+#ifdef HANGUL_KEYBOARD_USE_SSE2
+    for (; i + 16 <= n; i += 16) {
+	if (hangul_keyboard_map_block_sse2(table, dest + i, src + i))
+	    continue;
+
+	int j;
+	for (j = i; j < i + 16; ++j) {
+	    ucschar c = src[j] < HANGUL_KEYBOARD_TABLE_SIZE ? table[src[j]] : 0;
+	    dest[j] = c != 0 ? c : src[j];
+	}
+    }
+#endif /* HANGUL_KEYBOARD_USE_SSE2 */
+
+    for (; i < n; ++i) {
+	ucschar c = src[i] < HANGUL_KEYBOARD_TABLE_SIZE ? table[src[i]] : 0;
+	dest[i] = c != 0 ? c : src[i];
+    }
+}
+
+/**
+ * @ingroup hangulkeyboards
+ * @brief 키 입력 스트링을 자판 배열에 따라 한꺼번에 문자로 바꾸는 함수
+ * @param keyboard 사용할 자판
+ * @param tableid 사용할 자판 배열 테이블, 보통은 0
+ * @param dest 변환된 문자를 저장할 버퍼
+ * @param destlen @a dest 의 길이(ucschar 코드 단위)
+ * @param src 변환할 키 입력 스트링
+ * @param srclen @a src 의 길이, -1이면 0으로 끝나는 스트링으로 본다
+ * @return @a dest 에 저장한 코드의 갯수
+ *
+ * 키마다 hangul_keyboard_map_to_char()를 부르는 것과 같지만, 자판 배열에
+ * 없는 키는 0 대신 키를 그대로 복사한다. ASCII가 아닌 바이트도 그대로
+ * 복사한다. 세벌식 자판처럼 키가 바로 초성, 중성, 종성이 되는 자판은
+ * 결과를 hangul_jamos_to_syllables()로 음절로 바꿀 수 있다. 조합 규칙이나
+ * 갈마들이는 적용하지 않는다.
+ */
+int
+hangul_keyboard_map_keys(const HangulKeyboard* keyboard, int tableid,
+			 ucschar* dest, int destlen,
+			 const char* src, int srclen)
+{
+    const unsigned char* s = (const unsigned char*)src;
+    int n;
+    int i;
+
+    if (keyboard == NULL || dest == NULL || src == NULL)
+	return 0;
+
+    if (srclen < 0)
+	srclen = strlen(src);
+
+    n = srclen < destlen ? srclen : destlen;
+    if (n <= 0)
+	return 0;
+
+    if (tableid >= 0 && tableid < countof(keyboard->table)) {
+	const HangulKeyboardLayout* layout = hangul_keyboard_get_layout(keyboard);
+	if (layout != NULL) {
+	    if (layout->table[tableid] != NULL) {
+		hangul_keyboard_map_keys_16(layout->table[tableid], dest, s, n);
+		return n;
+	    }
+	} else if (keyboard->table[tableid] != NULL) {
+	    const ucschar* table = keyboard->table[tableid];
+	    for (i = 0; i < n; ++i) {
+		ucschar c = s[i] < HANGUL_KEYBOARD_TABLE_SIZE ? table[s[i]] : 0;
+		dest[i] = c != 0 ? c : s[i];
+	    }
+	    return n;
+	}
+    }
+
+    for (i = 0; i < n; ++i) {
+	dest[i] = s[i];
+    }
+    return n;
+}
+
+/* 갈마들이 한손 자판의 종류를 HANGUL_GALMADEULI_* 값으로 반환한다. */
+int
+hangul_keyboard_get_galmadeuli(const HangulKeyboard* keyboard)
+{
+    if (keyboard == NULL)
+	return HANGUL_GALMADEULI_NONE;
+
+    const HangulKeyboardLayout* layout = hangul_keyboard_get_layout(keyboard);
+    if (layout != NULL)
+	return layout->galmadeuli;
+
+    return keyboard->galmadeuli;
+}
+
+/* 갈마들이 자판에서 항상 새 글자의 초성으로 입력되는 키인지 확인한다. */
+bool
+hangul_keyboard_is_choseong_only_key(const HangulKeyboard* keyboard, int ascii)
+{
+    if (keyboard == NULL || ascii < 0 || ascii >= 128)
+	return false;
+
+    const HangulKeyboardLayout* layout = hangul_keyboard_get_layout(keyboard);
+    const uint32_t* mask = layout != NULL ? layout->choseong_only_keys
+					  : keyboard->choseong_only_keys;
+
+    return (mask[ascii >> 5] & HANGUL_KEY_MASK(ascii)) != 0;
+}
+
+bool
+hangul_keyboard_has_table(const HangulKeyboard* keyboard, int tableid)
+{
+    if (keyboard == NULL)
+	return false;
+
+    if (tableid < 0 || tableid >= countof(keyboard->table))
+	return false;
+
+    return keyboard->table[tableid] != NULL;
+}
+
+/* 자판 배열 테이블을 그대로 돌려준다. 공유 테이블이면 다른 자판과 같은
+ * 포인터가 된다. */
+const ucschar*
+hangul_keyboard_get_table(const HangulKeyboard* keyboard, int tableid)
+{
+    if (keyboard == NULL)
+	return NULL;
+
+    if (tableid < 0 || tableid >= countof(keyboard->table))
+	return NULL;
+
+    return keyboard->table[tableid];
+}
+
+const HangulCombination*
+hangul_keyboard_get_combination(const HangulKeyboard* keyboard, unsigned id)
+{
+    if (keyboard == NULL)
+	return NULL;
+
+    if (id >= countof(keyboard->combination))
+	return NULL;
+
+    return keyboard->combination[id];
+}
+
+static bool
+hangul_keyboard_is_choseong_key(const HangulKeyboard* keyboard, unsigned key)
+{
+    /* 자판 배열을 바꾸는 중에 불리므로 배치를 거치지 않고 읽는다 */
+    ucschar c = keyboard->table[0] != NULL ? keyboard->table[0][key] : 0;
+
+    /* 호환 자모를 유니코드 자모로 변환 후 체크 */
+    if (c >= 0x3131 && c <= 0x318F)
+	c = c - 0x3131 + 0x1100;
+
+    return hangul_is_choseong(c);
+}
+
+/* 갈마들이 자판은 모음을 위한 두번째 테이블을 가진 한손 자판이다.
+ * 오른손 자판은 r, e 키가, 왼손 자판은 u, i 키가 초성값을 가진다.
+ * 두벌식도 r, e 키가 초성이므로 테이블을 먼저 확인해야 한다. */
+static void
+hangul_keyboard_update_galmadeuli(HangulKeyboard* keyboard)
+{
+    static const char left_hand_choseong_keys[] = "yuhjnmikl";  /* 왼손 9개 */
+    static const char right_hand_choseong_keys[] = "ertdfgcvb"; /* 오른손 9개 */
+    const char* keys = NULL;
+
+    keyboard->galmadeuli = HANGUL_GALMADEULI_NONE;
+    memset(keyboard->choseong_only_keys, 0, sizeof(keyboard->choseong_only_keys));
+
+    if (keyboard->table[1] == NULL)
+	return;
+
+    if (hangul_keyboard_is_choseong_key(keyboard, 'r') &&
+	hangul_keyboard_is_choseong_key(keyboard, 'e')) {
+	keyboard->galmadeuli = HANGUL_GALMADEULI_RIGHT;
+	keys = right_hand_choseong_keys;
+    } else if (hangul_keyboard_is_choseong_key(keyboard, 'u') &&
+	       hangul_keyboard_is_choseong_key(keyboard, 'i')) {
+	keyboard->galmadeuli = HANGUL_GALMADEULI_LEFT;
+	keys = left_hand_choseong_keys;
+    } else {
+	return;
+    }
+
+    for (; *keys != '\0'; ++keys) {
+	unsigned key = (unsigned char)*keys;
+	keyboard->choseong_only_keys[key >> 5] |= HANGUL_KEY_MASK(key);
+    }
+}
+
 static void
 hangul_keyboard_set_mapping(HangulKeyboard *keyboard, int tableid, unsigned key, ucschar value)
 {
@@ -508,10 +1566,24 @@ hangul_keyboard_set_mapping(HangulKeyboard *keyboard, int tableid, unsigned key,
 	    new_table[i] = 0;
 	}
 	keyboard->table[tableid] = new_table;
+    } else if ((keyboard->shared_tables & (1u << tableid)) != 0) {
+	/* 다른 자판과 함께 쓰는 테이블은 복사해서 바꾼다 */
+	ucschar* new_table = malloc(sizeof(ucschar) * HANGUL_KEYBOARD_TABLE_SIZE);
+	if (new_table == NULL)
+	    return;
+
+	memcpy(new_table, keyboard->table[tableid],
+	       sizeof(ucschar) * HANGUL_KEYBOARD_TABLE_SIZE);
+	hangul_keyboard_shared_table_release(keyboard->table[tableid]);
+	keyboard->table[tableid] = new_table;
+	keyboard->shared_tables &= ~(1u << tableid);
     }
 
     ucschar* table = keyboard->table[tableid];
     table[key] = value;
+
+    hangul_keyboard_update_galmadeuli(keyboard);
+    hangul_keyboard_clear_layout(keyboard);
 }
 
 void
@@ -549,12 +1621,18 @@ hangul_keyboard_delete(HangulKeyboard *keyboard)
 
     free(keyboard->id);
     free(keyboard->name);
+    free(keyboard->path);
+    hangul_keyboard_layout_delete(keyboard->layout);
 
     unsigned i;
     for (i = 0; i < countof(keyboard->table); ++i) {
-	if (keyboard->table[i] != NULL) {
+	if (keyboard->table[i] == NULL)
+	    continue;
+
+	if ((keyboard->shared_tables & (1u << i)) != 0)
+	    hangul_keyboard_shared_table_release(keyboard->table[i]);
+	else
 	    free(keyboard->table[i]);
-	}
     }
 
     for (i = 0; i < countof(keyboard->combination); ++i) {
@@ -576,6 +1654,11 @@ hangul_keyboard_combine(const HangulKeyboard* keyboard,
     if (id >= countof(keyboard->combination))
 	return 0;
 
+    const HangulKeyboardLayout* layout = hangul_keyboard_get_layout(keyboard);
+    if (layout != NULL)
+	return hangul_keyboard_layout_combine(layout->combination[id],
+					      first, second);
+
     HangulCombination* combination = keyboard->combination[id];
     ucschar res = hangul_combination_combine(combination, first, second);
     return res;
@@ -638,6 +1721,11 @@ on_element_start(void* data, const XML_Char* element, const XML_Char** attr)
 	}
 
 	hangul_keyboard_set_type(context->keyboard, type);
+    } else if (context->scan_only && strcmp(element, "name") != 0) {
+	/* 자판 파일은 이름이 배열보다 먼저 나오므로, 이름을 읽었으면
+	 * 나머지는 읽지 않는다. */
+	if (context->keyboard != NULL && context->keyboard->name != NULL)
+	    XML_StopParser((XML_Parser)context->parser, XML_FALSE);
     } else if (strcmp(element, "name") == 0) {
 	if (context->keyboard == NULL)
 	    return;
@@ -671,6 +1759,7 @@ on_element_start(void* data, const XML_Char* element, const XML_Char** attr)
 	    if (context->keyboard->combination[id] != NULL) {
 		hangul_combination_delete(context->keyboard->combination[id]);
 	    }
+	    hangul_keyboard_clear_layout(context->keyboard);
 
 	    context->current_id = id;
 	    context->current_element = "combination";
@@ -782,6 +1871,7 @@ hangul_keyboard_parse_file(const char* path, HangulKeyboardLoadContext* context)
 
     XML_SetUserData(parser, context);
     XML_SetElementHandler(parser, on_element_start, on_element_end);
+    context->parser = parser;
     XML_SetCharacterDataHandler(parser, on_char_data);
 
     FILE* file = fopen(path, "r");
@@ -819,21 +1909,30 @@ hangul_keyboard_new_from_file(const char* path)
 
     hangul_keyboard_parse_file(path, &context);
 
+    /* 읽기를 마친 자판은 바로 배치를 만들어 둔다 */
+    if (context.keyboard != NULL) {
+	hangul_keyboard_clear_layout(context.keyboard);
+	hangul_keyboard_get_layout(context.keyboard);
+    }
+
     return context.keyboard;
 }
 
-static unsigned
-hangul_keyboard_list_load_dir(const char* path)
+/* path 디렉토리의 xml 파일마다 func를 부른다. */
+static void
+hangul_keyboard_dir_foreach(const char* path,
+			    void (*func)(const char* file, void* data),
+			    void* data)
 {
     if (path == NULL) {
-        return 0;
+        return;
     }
 
     const char* subpattern = "/*.xml";
     size_t len = strlen(path) + strlen(subpattern) + 1;
     char* pattern = (char*)malloc(len);
     if (pattern == NULL) {
-        return 0;
+        return;
     }
 
     snprintf(pattern, len, "%s%s", path, subpattern);
@@ -843,15 +1942,12 @@ hangul_keyboard_list_load_dir(const char* path)
     int res = glob(pattern, GLOB_ERR, NULL, &result);
     if (res != 0) {
         free(pattern);
-	return 0;
+	return;
     }
 
     size_t i;
     for (i = 0; i < result.gl_pathc; ++i) {
-	HangulKeyboard* keyboard = hangul_keyboard_new_from_file(result.gl_pathv[i]);
-	if (keyboard == NULL)
-	    continue;
-	hangul_keyboard_list_append(keyboard);
+	func(result.gl_pathv[i], data);
     }
 
     globfree(&result);
@@ -864,7 +1960,7 @@ hangul_keyboard_list_load_dir(const char* path)
     LPWSTR wpattern = (LPWSTR)malloc(n);
     if (wpattern == NULL) {
 	free(pattern);
-	return 0;
+	return;
     }
 
     MultiByteToWideChar(CP_ACP, 0, pattern, -1, wpattern, n);
@@ -873,7 +1969,7 @@ hangul_keyboard_list_load_dir(const char* path)
     if (hFind == INVALID_HANDLE_VALUE) {
 	free(wpattern);
 	free(pattern);
-	return 0;
+	return;
     }
 
     do {
@@ -892,145 +1988,1184 @@ hangul_keyboard_list_load_dir(const char* path)
 	char* pfile = &file[path_len + 1];
 	WideCharToMultiByte(CP_ACP, 0, findFileData.cFileName, -1, pfile, n, NULL, NULL);
 
-	HangulKeyboard* keyboard = hangul_keyboard_new_from_file(file);
+	func(file, data);
 	free(file);
-
-	if (keyboard == NULL)
-	    continue;
-	hangul_keyboard_list_append(keyboard);
     } while(FindNextFileW(hFind, &findFileData));
 
     FindClose(hFind);
     free(wpattern);
     free(pattern);
 #endif /* HAVE_GLOB_H */
+}
 
-    return hangul_keyboards.n;
+/* 자판 목록에 필요한 id, type, 이름만 읽은 자판을 만든다.
+ * 나머지는 hangul_keyboard_load()에서 읽는다. */
+static HangulKeyboard*
+hangul_keyboard_new_from_file_header(const char* path)
+{
+    HangulKeyboardLoadContext context;
+    memset(&context, 0, sizeof(context));
+    context.path_stack_top = -1;
+    context.scan_only = true;
+
+    hangul_keyboard_parse_file(path, &context);
+
+    if (context.keyboard != NULL) {
+	context.keyboard->path = strdup(path);
+	if (context.keyboard->path == NULL) {
+	    hangul_keyboard_delete(context.keyboard);
+	    return NULL;
+	}
+    }
+
+    return context.keyboard;
 }
-#endif /* ENABLE_EXTERNAL_KEYBOARDS */
 
+/* id와 이름만 읽어 둔 자판이면 파일의 나머지를 읽는다.
+ * 쓰는 쪽 잠금을 가지고 불러야 한다. */
 static void
-hangul_keyboard_list_clear()
+hangul_keyboard_load(HangulKeyboard* keyboard)
 {
-    size_t i;
-    for (i = 0; i < hangul_keyboards.n; ++i) {
-	hangul_keyboard_delete(hangul_keyboards.keyboards[i]);
-    }
+    HangulKeyboard* loaded;
+    char* path = keyboard->path;
+    unsigned i;
 
-    free(hangul_keyboards.keyboards);
+    if (path == NULL)
+	return;
+
+    loaded = hangul_keyboard_new_from_file(path);
+    if (loaded != NULL) {
+	hangul_keyboard_clear_layout(keyboard);
+	for (i = 0; i < countof(keyboard->table); ++i) {
+	    keyboard->table[i] = loaded->table[i];
+	    loaded->table[i] = NULL;
+	}
+	for (i = 0; i < countof(keyboard->combination); ++i) {
+	    keyboard->combination[i] = loaded->combination[i];
+	    loaded->combination[i] = NULL;
+	}
+	keyboard->type = loaded->type;
+	keyboard->galmadeuli = loaded->galmadeuli;
+	memcpy(keyboard->choseong_only_keys, loaded->choseong_only_keys,
+	       sizeof(keyboard->choseong_only_keys));
+	keyboard->layout = loaded->layout;
+	loaded->layout = NULL;
+	hangul_keyboard_delete(loaded);
+
+	hangul_keyboard_share_tables(keyboard);
+    }
 
-    hangul_keyboards.n = 0;
-    hangul_keyboards.nalloced = 0;
-    hangul_keyboards.keyboards = NULL;
+    /* 다른 쓰레드는 path가 NULL인 것을 보고 나서 자판을 사용하므로
+     * 자판을 모두 채운 후에 바꾼다. 읽지 못했으면 빈 자판으로 둔다. */
+    (void)hangul_atomic_exchange_ptr(&keyboard->path, NULL);
+    free(path);
 }
 
-#if ENABLE_EXTERNAL_KEYBOARDS
-static char*
-hangul_keyboard_get_default_keyboard_path()
+/* 디렉토리에서 찾은 자판 파일 목록 */
+typedef struct _HangulKeyboardFileList {
+    size_t n;
+    size_t nalloced;
+    char** files;
+} HangulKeyboardFileList;
+
+/* 여러 쓰레드가 나누어 읽는 자판 파일들.
+ * 각 쓰레드는 next를 하나씩 늘려 가며 아직 읽지 않은 파일을 가져간다. */
+typedef struct _HangulKeyboardLoadJob {
+    char** files;
+    HangulKeyboard** keyboards;
+    long n;
+    long next;
+    HangulKeyboard* (*parse)(const char* path);
+} HangulKeyboardLoadJob;
+
+/* 자판 파일을 읽는 쓰레드는 이보다 많이 만들지 않는다 */
+#define HANGUL_KEYBOARD_LOAD_MAX_THREADS 16
+
+static void
+hangul_keyboard_file_list_append(const char* file, void* data)
 {
-    char* keyboard_path = NULL;
-    size_t keyboard_path_len = 1;
+    HangulKeyboardFileList* list = (HangulKeyboardFileList*)data;
 
-    /* default LIBHANGUL_KEYBOARD_PATH is
-     * SYSTEM_KEYBOARD_DIR:USER_KEYBOARD_DIR */
+    if (list->n >= list->nalloced) {
+	size_t n = list->nalloced * 2;
+	if (n == 0) {
+	    n = 16;
+	}
+	char** files = realloc(list->files, n * sizeof(files[0]));
+	if (files == NULL)
+	    return;
 
-#ifdef _WIN32
-    /* system default dir */
-    char* system_dir = NULL;
-    const char* data_dir = getenv("APPDATA");
-    if (data_dir != NULL) {
-        const char* subdir = "/libhangul/keyboards";
-        size_t system_dir_len = strlen(data_dir) + strlen(subdir) + 1;
-        system_dir = (char*)malloc(system_dir_len);
-        if (system_dir != NULL) {
-            snprintf(system_dir, system_dir_len, "%s%s", data_dir, subdir);
-            keyboard_path_len += strlen(system_dir);
-        }
-    }
-    /* user default dir */
-    char* home_dir = getenv("USERPROFILE");
-    if (home_dir == NULL) {
-        /* no user data dir */
-        return system_dir;
-    } else {
-        const char* subdir = "/.libhangul/keyboards";
-        keyboard_path_len += strlen(home_dir) + strlen(subdir);
-        keyboard_path = (char*)malloc(keyboard_path_len);
-        if (keyboard_path != NULL) {
-            if (system_dir != NULL) {
-                keyboard_path_len++;
-                snprintf(keyboard_path, keyboard_path_len, "%s;%s%s", system_dir, home_dir, subdir);
-	    } else {
-                snprintf(keyboard_path, keyboard_path_len, "%s%s", home_dir, subdir);
-	    }
-        }
+	list->nalloced = n;
+	list->files = files;
     }
-#else
-    /* system default dir */
-    const char* system_dir = LIBHANGUL_KEYBOARD_DIR;
-    keyboard_path_len += strlen(system_dir);
 
-    /* user default dir */
-    char* xdg_data_home = getenv("XDG_DATA_HOME");
-    if (xdg_data_home == NULL) {
-        char* home_dir = getenv("HOME");
-        if (home_dir == NULL) {
-            /* no user data dir */
-            keyboard_path = (char*)malloc(keyboard_path_len);
-            if (keyboard_path != NULL) {
-                snprintf(keyboard_path, keyboard_path_len, "%s", system_dir);
-            }
-        } else {
-            const char* subdir = "/.local/share/libhangul/keyboards";
-            keyboard_path_len += 1 + strlen(home_dir) + strlen(subdir);
-            keyboard_path = (char*)malloc(keyboard_path_len);
-            if (keyboard_path != NULL) {
-                snprintf(keyboard_path, keyboard_path_len, "%s:%s%s", system_dir, home_dir, subdir);
-            }
-        }
-    } else {
-        const char* subdir = "/libhangul/keyboards";
-        keyboard_path_len += 1 + strlen(xdg_data_home) + strlen(subdir);
-        keyboard_path = (char*)malloc(keyboard_path_len);
-        if (keyboard_path != NULL) {
-            snprintf(keyboard_path, keyboard_path_len, "%s:%s%s", system_dir, xdg_data_home, subdir);
-        }
-    }
-#endif /* _WIN32 */
+    char* copy = strdup(file);
+    if (copy == NULL)
+	return;
 
-    return keyboard_path;
+    list->files[list->n] = copy;
+    list->n++;
 }
 
-static char*
-hangul_keyboard_get_keyboard_path()
+static int
+hangul_keyboard_file_cmp(const void* p1, const void* p2)
 {
-    char* keyboard_path = getenv("LIBHANGUL_KEYBOARD_PATH");
-    if (keyboard_path == NULL) {
-        keyboard_path = hangul_keyboard_get_default_keyboard_path();
-    } else {
-        keyboard_path = strdup(keyboard_path);
-    }
-
-    return keyboard_path;
+    const char* file1 = *(const char* const*)p1;
+    const char* file2 = *(const char* const*)p2;
+    return strcmp(file1, file2);
 }
-#endif /* ENABLE_EXTERNAL_KEYBOARDS */
 
-int
-hangul_keyboard_list_init(const char* user_defined_keyboard_path)
+static void
+hangul_keyboard_load_job_run(HangulKeyboardLoadJob* job)
 {
-#if ENABLE_EXTERNAL_KEYBOARDS
-    /* 이 함수를 중복 호출할 경우에 대한 처리
-     * 이미 등록된 자판이 있다면 중복 호출된 것으로 보고
-     * 함수를 종료한다. */
-    if (hangul_keyboards.n > 0)
-	return 2;
+    long i;
 
-    /* libhangul data dir에서 keyboard 로딩 */
-    char* libhangul_keyboard_path = NULL;
-    if (user_defined_keyboard_path == NULL) {
-        libhangul_keyboard_path = hangul_keyboard_get_keyboard_path();
-    } else {
-        libhangul_keyboard_path = strdup(user_defined_keyboard_path);
+    while ((i = hangul_atomic_inc(&job->next) - 1) < job->n) {
+	job->keyboards[i] = job->parse(job->files[i]);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI
+hangul_keyboard_load_thread(LPVOID data)
+{
+    hangul_keyboard_load_job_run((HangulKeyboardLoadJob*)data);
+    return 0;
+}
+#elif defined(HAVE_PTHREAD_H)
+static void*
+hangul_keyboard_load_thread(void* data)
+{
+    hangul_keyboard_load_job_run((HangulKeyboardLoadJob*)data);
+    return NULL;
+}
+#endif /* _WIN32 */
+
+static unsigned
+hangul_keyboard_get_cpu_count()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1;
+#else
+    return 1;
+#endif /* _WIN32 */
+}
+
+/* job의 파일들을 n_threads개의 쓰레드로 나누어 읽는다.
+ * 부르는 쓰레드도 같이 읽으므로, 쓰레드를 만들지 못하더라도
+ * 모든 파일을 읽게 된다. */
+static void
+hangul_keyboard_load_job_start(HangulKeyboardLoadJob* job, unsigned n_threads)
+{
+    unsigned n_started = 0;
+    unsigned i;
+
+    if (n_threads == 0)
+	n_threads = hangul_keyboard_get_cpu_count();
+    if (n_threads > HANGUL_KEYBOARD_LOAD_MAX_THREADS)
+	n_threads = HANGUL_KEYBOARD_LOAD_MAX_THREADS;
+    if (n_threads > job->n)
+	n_threads = job->n;
+
+#ifdef _WIN32
+    HANDLE threads[HANGUL_KEYBOARD_LOAD_MAX_THREADS];
+    for (i = 1; i < n_threads; ++i) {
+	threads[n_started] = CreateThread(NULL, 0,
+		hangul_keyboard_load_thread, job, 0, NULL);
+	if (threads[n_started] != NULL)
+	    n_started++;
+    }
+#elif defined(HAVE_PTHREAD_H)
+    pthread_t threads[HANGUL_KEYBOARD_LOAD_MAX_THREADS];
+    for (i = 1; i < n_threads; ++i) {
+	if (pthread_create(&threads[n_started], NULL,
+			   hangul_keyboard_load_thread, job) == 0)
+	    n_started++;
+    }
+#endif /* _WIN32 */
+
+    hangul_keyboard_load_job_run(job);
+
+    for (i = 0; i < n_started; ++i) {
+#ifdef _WIN32
+	WaitForSingleObject(threads[i], INFINITE);
+	CloseHandle(threads[i]);
+#elif defined(HAVE_PTHREAD_H)
+	pthread_join(threads[i], NULL);
+#endif /* _WIN32 */
+    }
+}
+
+/* path 디렉토리의 자판 파일을 parse로 읽어서 list에 추가한다.
+ * 파일은 여러 쓰레드에서 동시에 읽지만, 목록에는 읽은 순서와 관계없이
+ * 파일 이름 순서로 추가하므로 같은 id의 자판 중 어느 것이 선택될지는
+ * 항상 같다. */
+static unsigned
+hangul_keyboard_list_load_files(HangulKeyboardList* list, const char* path,
+				HangulKeyboard* (*parse)(const char* path),
+				unsigned n_threads)
+{
+    HangulKeyboardFileList files = { 0, 0, NULL };
+    HangulKeyboardLoadJob job;
+    size_t i;
+
+    hangul_keyboard_dir_foreach(path, hangul_keyboard_file_list_append, &files);
+    if (files.n == 0)
+	return list->n;
+
+    qsort(files.files, files.n, sizeof(files.files[0]),
+	  hangul_keyboard_file_cmp);
+
+    job.files = files.files;
+    job.keyboards = calloc(files.n, sizeof(job.keyboards[0]));
+    job.n = files.n;
+    job.next = 0;
+    job.parse = parse;
+    if (job.keyboards != NULL) {
+	hangul_keyboard_load_job_start(&job, n_threads);
+
+	for (i = 0; i < files.n; ++i) {
+	    HangulKeyboard* keyboard = job.keyboards[i];
+	    if (keyboard == NULL)
+		continue;
+	    hangul_keyboard_share_tables(keyboard);
+	    if (!hangul_keyboard_list_append(list, keyboard))
+		hangul_keyboard_delete(keyboard);
+	}
+	free(job.keyboards);
+    }
+
+    for (i = 0; i < files.n; ++i) {
+	free(files.files[i]);
+    }
+    free(files.files);
+
+    return list->n;
+}
+
+static unsigned
+hangul_keyboard_list_load_dir(HangulKeyboardList* list, const char* path)
+{
+    return hangul_keyboard_list_load_files(list, path,
+	    hangul_keyboard_new_from_file, 1);
+}
+
+/* 자판의 id와 이름만 읽어 두고, 나머지는 자판을 처음 찾을 때 읽는다 */
+static unsigned
+hangul_keyboard_list_scan_dir(HangulKeyboardList* list, const char* path,
+			      unsigned n_threads)
+{
+    return hangul_keyboard_list_load_files(list, path,
+	    hangul_keyboard_new_from_file_header, n_threads);
+}
+
+static void
+hangul_keyboard_count_file(const char* file, void* data)
+{
+    (*(uint32_t*)data)++;
+}
+
+/* 번들 파일을 만든다. 실패하면 -1, 성공하면 자판 수를 리턴한다. */
+static int
+hangul_keyboard_bundle_write(const HangulKeyboardList* list,
+			     uint32_t n_sources, const char* bundle_path)
+{
+    HangulKeyboardBundleHeader header;
+    HangulKeyboardBundleEntry* entries;
+    size_t offset;
+    uint32_t n = 0;
+    size_t i;
+    unsigned j;
+    FILE* file;
+    bool res = true;
+
+    entries = calloc(list->n + 1, sizeof(HangulKeyboardBundleEntry));
+    if (entries == NULL)
+	return -1;
+
+    /* id가 없는 자판은 선택할 수 없으므로 뺀다 */
+    for (i = 0; i < list->n; ++i) {
+	if (list->keyboards[i]->id != NULL)
+	    n++;
+    }
+
+    offset = sizeof(header) + sizeof(entries[0]) * n;
+    for (i = 0, n = 0; i < list->n; ++i) {
+	const HangulKeyboard* keyboard = list->keyboards[i];
+	HangulKeyboardBundleEntry* entry = &entries[n];
+	if (keyboard->id == NULL)
+	    continue;
+
+	entry->type = keyboard->type;
+	for (j = 0; j < countof(keyboard->table); ++j) {
+	    if (keyboard->table[j] == NULL)
+		continue;
+	    entry->table[j] = offset;
+	    offset += sizeof(ucschar) * HANGUL_KEYBOARD_TABLE_SIZE;
+	}
+	for (j = 0; j < countof(keyboard->combination); ++j) {
+	    const HangulCombination* combination = keyboard->combination[j];
+	    if (combination == NULL || combination->size == 0)
+		continue;
+	    entry->combination[j] = offset;
+	    entry->combination_size[j] = combination->size;
+	    offset += sizeof(HangulCombinationItem) * combination->size;
+	}
+	n++;
+    }
+
+    for (i = 0, n = 0; i < list->n; ++i) {
+	const HangulKeyboard* keyboard = list->keyboards[i];
+	HangulKeyboardBundleEntry* entry = &entries[n];
+	if (keyboard->id == NULL)
+	    continue;
+
+	entry->id = offset;
+	offset += strlen(keyboard->id) + 1;
+	if (keyboard->name != NULL) {
+	    entry->name = offset;
+	    offset += strlen(keyboard->name) + 1;
+	}
+	n++;
+    }
+
+    if (offset > UINT32_MAX) {
+	free(entries);
+	return -1;
+    }
+
+    memcpy(header.magic, "HKBD", sizeof(header.magic));
+    header.version = HANGUL_KEYBOARD_BUNDLE_VERSION;
+    header.byte_order = HANGUL_KEYBOARD_BUNDLE_BYTE_ORDER;
+    header.size = offset;
+    header.n_keyboards = n;
+    header.n_sources = n_sources;
+
+    file = fopen(bundle_path, "wb");
+    if (file == NULL) {
+	free(entries);
+	return -1;
+    }
+
+    res = res && fwrite(&header, sizeof(header), 1, file) == 1;
+    res = res && fwrite(entries, sizeof(entries[0]), n, file) == n;
+    for (i = 0; res && i < list->n; ++i) {
+	const HangulKeyboard* keyboard = list->keyboards[i];
+	if (keyboard->id == NULL)
+	    continue;
+
+	for (j = 0; res && j < countof(keyboard->table); ++j) {
+	    if (keyboard->table[j] == NULL)
+		continue;
+	    res = fwrite(keyboard->table[j], sizeof(ucschar),
+			 HANGUL_KEYBOARD_TABLE_SIZE, file) ==
+		  HANGUL_KEYBOARD_TABLE_SIZE;
+	}
+	for (j = 0; res && j < countof(keyboard->combination); ++j) {
+	    const HangulCombination* combination = keyboard->combination[j];
+	    if (combination == NULL || combination->size == 0)
+		continue;
+	    res = fwrite(combination->table, sizeof(HangulCombinationItem),
+			 combination->size, file) == combination->size;
+	}
+    }
+    for (i = 0; res && i < list->n; ++i) {
+	const HangulKeyboard* keyboard = list->keyboards[i];
+	if (keyboard->id == NULL)
+	    continue;
+
+	res = fwrite(keyboard->id, strlen(keyboard->id) + 1, 1, file) == 1;
+	if (res && keyboard->name != NULL)
+	    res = fwrite(keyboard->name, strlen(keyboard->name) + 1, 1, file) == 1;
+    }
+
+    if (fclose(file) != 0)
+	res = false;
+
+    free(entries);
+
+    if (!res) {
+	remove(bundle_path);
+	return -1;
+    }
+
+    return n;
+}
+
+/**
+ * @ingroup hangulkeyboards
+ * @brief 키보드 디렉토리의 xml 파일들로 키보드 번들 파일을 만드는 함수
+ * @param keyboard_dir 자판 xml 파일이 있는 디렉토리
+ * @param bundle_path 만들 번들 파일의 경로
+ * @return 번들에 저장한 자판의 수, 실패하면 -1
+ *
+ * 번들 파일은 자판 xml 파일들을 미리 읽어서 하나로 만든 바이너리 파일이다.
+ * @a keyboard_dir 에 hangul-keyboards.bin 이라는 이름으로 두면 hangul_init()
+ * 에서 xml 파일을 읽지 않고 번들 파일을 읽는다. xml 파일이 번들 파일보다
+ * 새로우면 번들 파일은 무시되고 xml 파일을 읽는다.
+ * 번들 파일은 만든 시스템의 byte order를 따르므로 다른 시스템에서는 다시
+ * 만들어야 한다.
+ */
+int
+hangul_keyboard_bundle_compile(const char* keyboard_dir, const char* bundle_path)
+{
+    HangulKeyboardList* list;
+    uint32_t n_sources = 0;
+    int res;
+    size_t i;
+
+    if (keyboard_dir == NULL || bundle_path == NULL)
+	return -1;
+
+    list = hangul_keyboard_list_new();
+    if (list == NULL)
+	return -1;
+
+    hangul_keyboard_dir_foreach(keyboard_dir, hangul_keyboard_count_file, &n_sources);
+    hangul_keyboard_list_load_dir(list, keyboard_dir);
+
+    res = hangul_keyboard_bundle_write(list, n_sources, bundle_path);
+
+    for (i = 0; i < list->n; ++i) {
+	hangul_keyboard_delete(list->keyboards[i]);
+    }
+    hangul_keyboard_list_delete(list);
+
+    return res;
+}
+
+typedef struct _HangulKeyboardBundleSources {
+    uint32_t n;
+    time_t mtime;
+    bool is_stale;
+} HangulKeyboardBundleSources;
+
+static void
+hangul_keyboard_check_source(const char* file, void* data)
+{
+    HangulKeyboardBundleSources* sources = (HangulKeyboardBundleSources*)data;
+    struct stat st;
+
+    sources->n++;
+    if (stat(file, &st) != 0 || st.st_mtime > sources->mtime)
+	sources->is_stale = true;
+}
+
+static bool
+hangul_keyboard_bundle_check_range(const HangulKeyboardBundle* bundle,
+				   uint32_t offset, size_t size)
+{
+    if (offset < sizeof(HangulKeyboardBundleHeader) || offset % 4 != 0)
+	return false;
+
+    return size <= bundle->size && offset <= bundle->size - size;
+}
+
+static const char*
+hangul_keyboard_bundle_get_string(const HangulKeyboardBundle* bundle,
+				  uint32_t offset)
+{
+    const char* data = (const char*)bundle->data;
+
+    if (offset < sizeof(HangulKeyboardBundleHeader) || offset >= bundle->size)
+	return NULL;
+
+    if (memchr(data + offset, '\0', bundle->size - offset) == NULL)
+	return NULL;
+
+    return data + offset;
+}
+
+/* 번들의 내용을 확인하고 자판을 만든다. 잘못된 번들이면 false를 리턴한다. */
+static bool
+hangul_keyboard_bundle_init_keyboards(HangulKeyboardBundle* bundle)
+{
+    const HangulKeyboardBundleHeader* header = bundle->data;
+    const HangulKeyboardBundleEntry* entries;
+    char* data = (char*)bundle->data;
+    unsigned i, j;
+
+    if (bundle->size < sizeof(*header) ||
+	memcmp(header->magic, "HKBD", sizeof(header->magic)) != 0 ||
+	header->version != HANGUL_KEYBOARD_BUNDLE_VERSION ||
+	header->byte_order != HANGUL_KEYBOARD_BUNDLE_BYTE_ORDER ||
+	header->size != bundle->size ||
+	header->n_keyboards == 0 ||
+	!hangul_keyboard_bundle_check_range(bundle, sizeof(*header),
+		sizeof(HangulKeyboardBundleEntry) * (size_t)header->n_keyboards))
+	return false;
+
+    bundle->n = header->n_keyboards;
+    bundle->keyboards = calloc(bundle->n, sizeof(HangulKeyboard));
+    bundle->combinations = calloc(bundle->n * countof(bundle->keyboards->combination),
+				  sizeof(HangulCombination));
+    if (bundle->keyboards == NULL || bundle->combinations == NULL)
+	return false;
+
+    entries = (const HangulKeyboardBundleEntry*)(header + 1);
+    for (i = 0; i < bundle->n; ++i) {
+	const HangulKeyboardBundleEntry* entry = &entries[i];
+	HangulKeyboard* keyboard = &bundle->keyboards[i];
+
+	keyboard->id = (char*)hangul_keyboard_bundle_get_string(bundle, entry->id);
+	if (keyboard->id == NULL)
+	    return false;
+
+	if (entry->name != 0) {
+	    keyboard->name = (char*)hangul_keyboard_bundle_get_string(bundle, entry->name);
+	    if (keyboard->name == NULL)
+		return false;
+	}
+
+	for (j = 0; j < countof(keyboard->table); ++j) {
+	    if (entry->table[j] == 0)
+		continue;
+
+	    if (!hangul_keyboard_bundle_check_range(bundle, entry->table[j],
+			sizeof(ucschar) * HANGUL_KEYBOARD_TABLE_SIZE))
+		return false;
+	    keyboard->table[j] = (ucschar*)(data + entry->table[j]);
+	}
+
+	for (j = 0; j < countof(keyboard->combination); ++j) {
+	    HangulCombination* combination;
+	    const HangulCombinationItem* items;
+	    uint32_t size = entry->combination_size[j];
+	    uint32_t k;
+
+	    if (entry->combination[j] == 0)
+		continue;
+
+	    if (!hangul_keyboard_bundle_check_range(bundle, entry->combination[j],
+			sizeof(HangulCombinationItem) * (size_t)size))
+		return false;
+
+	    /* bsearch를 위해 정렬되어 있어야 한다 */
+	    items = (const HangulCombinationItem*)(data + entry->combination[j]);
+	    for (k = 1; k < size; ++k) {
+		if (items[k - 1].key > items[k].key)
+		    return false;
+	    }
+
+	    combination = &bundle->combinations[i * countof(keyboard->combination) + j];
+	    combination->size = size;
+	    combination->size_alloced = size;
+	    combination->table = (HangulCombinationItem*)items;
+	    combination->is_static = true;
+	    combination->index = NULL;
+	    keyboard->combination[j] = combination;
+	}
+
+	keyboard->type = entry->type;
+	keyboard->is_static = true;
+	keyboard->layout = NULL;
+	hangul_keyboard_update_galmadeuli(keyboard);
+    }
+
+    return true;
+}
+
+static void
+hangul_keyboard_bundle_delete(HangulKeyboardBundle* bundle)
+{
+    unsigned i;
+
+    if (bundle == NULL)
+	return;
+
+    if (bundle->keyboards != NULL) {
+	for (i = 0; i < bundle->n; ++i) {
+	    hangul_keyboard_layout_delete(bundle->keyboards[i].layout);
+	}
+	free(bundle->keyboards);
+    }
+
+    if (bundle->combinations != NULL) {
+	for (i = 0; i < bundle->n * countof(bundle->keyboards->combination); ++i) {
+	    free(bundle->combinations[i].index);
+	}
+	free(bundle->combinations);
+    }
+
+#ifndef _WIN32
+    if (bundle->is_mapped) {
+	munmap(bundle->data, bundle->size);
+    } else
+#endif /* _WIN32 */
+    {
+	free(bundle->data);
+    }
+
+    free(bundle);
+}
+
+/* 번들의 자판을 힙에 복사한다. 번들의 자판은 읽기 전용인 번들 메모리를
+ * 가리키고 hangul_fini()에서 해제되므로, 목록에서 빼내 사용자에게 넘길
+ * 때에는 이 복사본을 넘긴다. */
+static HangulKeyboard*
+hangul_keyboard_bundle_copy_keyboard(const HangulKeyboard* keyboard)
+{
+    HangulKeyboard* copy;
+    unsigned i;
+
+    copy = hangul_keyboard_new();
+    if (copy == NULL)
+	return NULL;
+
+    copy->id = strdup(keyboard->id);
+    if (copy->id == NULL)
+	goto fail;
+
+    if (keyboard->name != NULL) {
+	copy->name = strdup(keyboard->name);
+	if (copy->name == NULL)
+	    goto fail;
+    }
+
+    for (i = 0; i < countof(keyboard->table); ++i) {
+	if (keyboard->table[i] == NULL)
+	    continue;
+
+	copy->table[i] = malloc(sizeof(ucschar) * HANGUL_KEYBOARD_TABLE_SIZE);
+	if (copy->table[i] == NULL)
+	    goto fail;
+	memcpy(copy->table[i], keyboard->table[i],
+	       sizeof(ucschar) * HANGUL_KEYBOARD_TABLE_SIZE);
+    }
+
+    for (i = 0; i < countof(keyboard->combination); ++i) {
+	const HangulCombination* combination = keyboard->combination[i];
+	HangulCombination* c;
+
+	if (combination == NULL)
+	    continue;
+
+	c = hangul_combination_new();
+	if (c == NULL)
+	    goto fail;
+	copy->combination[i] = c;
+
+	c->table = malloc(sizeof(HangulCombinationItem) * combination->size);
+	if (c->table == NULL)
+	    goto fail;
+	memcpy(c->table, combination->table,
+	       sizeof(HangulCombinationItem) * combination->size);
+	c->size = combination->size;
+	c->size_alloced = combination->size;
+	c->index = hangul_combination_index_new(c);
+    }
+
+    copy->type = keyboard->type;
+    hangul_keyboard_update_galmadeuli(copy);
+    return copy;
+
+fail:
+    hangul_keyboard_delete(copy);
+    return NULL;
+}
+
+static HangulKeyboardBundle*
+hangul_keyboard_bundle_load(const char* path, size_t size)
+{
+    HangulKeyboardBundle* bundle = calloc(1, sizeof(HangulKeyboardBundle));
+    if (bundle == NULL)
+	return NULL;
+
+    bundle->size = size;
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+	free(bundle);
+	return NULL;
+    }
+
+    bundle->data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (bundle->data == MAP_FAILED) {
+	free(bundle);
+	return NULL;
+    }
+    bundle->is_mapped = true;
+#else
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+	free(bundle);
+	return NULL;
+    }
+
+    bundle->data = malloc(size);
+    if (bundle->data == NULL || fread(bundle->data, 1, size, file) != size) {
+	fclose(file);
+	free(bundle->data);
+	free(bundle);
+	return NULL;
+    }
+    fclose(file);
+#endif /* _WIN32 */
+
+    if (!hangul_keyboard_bundle_init_keyboards(bundle)) {
+	hangul_keyboard_bundle_delete(bundle);
+	return NULL;
+    }
+
+    return bundle;
+}
+
+/* path 디렉토리에 번들 파일이 있으면 번들에서 자판을 읽는다.
+ * 번들이 없거나, 번들을 만든 후에 xml 파일이 바뀌었거나, 잘못된 번들이면
+ * 0을 리턴하고 이때에는 xml 파일을 읽어야 한다. 쓰는 쪽 잠금을 가지고
+ * 불러야 한다. */
+static unsigned
+hangul_keyboard_list_load_bundle(HangulKeyboardList* list, const char* path)
+{
+    HangulKeyboardBundleSources sources;
+    HangulKeyboardBundle* bundle;
+    const HangulKeyboardBundleHeader* header;
+    struct stat st;
+    unsigned i;
+
+    if (path == NULL)
+	return 0;
+
+    size_t len = strlen(path) + strlen(HANGUL_KEYBOARD_BUNDLE_FILE) + 2;
+    char* file = malloc(len);
+    if (file == NULL)
+	return 0;
+
+    snprintf(file, len, "%s/%s", path, HANGUL_KEYBOARD_BUNDLE_FILE);
+    if (stat(file, &st) != 0 || st.st_size < sizeof(HangulKeyboardBundleHeader) ||
+	st.st_size > UINT32_MAX) {
+	free(file);
+	return 0;
+    }
+
+    bundle = hangul_keyboard_bundle_load(file, st.st_size);
+    free(file);
+    if (bundle == NULL)
+	return 0;
+
+    /* xml 파일이 추가, 삭제되었거나 번들보다 새로우면 번들을 쓰지 않는다 */
+    header = bundle->data;
+    sources.n = 0;
+    sources.mtime = st.st_mtime;
+    sources.is_stale = false;
+    hangul_keyboard_dir_foreach(path, hangul_keyboard_check_source, &sources);
+    if (sources.is_stale || sources.n != header->n_sources) {
+	hangul_keyboard_bundle_delete(bundle);
+	return 0;
+    }
+
+    for (i = 0; i < bundle->n; ++i) {
+	if (!hangul_keyboard_list_append(list, &bundle->keyboards[i]))
+	    break;
+    }
+
+    if (i == 0) {
+	hangul_keyboard_bundle_delete(bundle);
+	return 0;
+    }
+
+    /* 목록에 넣은 자판이 번들의 메모리를 가리키므로 일부만 넣었더라도
+     * 번들은 hangul_fini()까지 남겨 둔다 */
+    bundle->next = hangul_keyboard_bundles;
+    hangul_keyboard_bundles = bundle;
+
+    return i;
+}
+#endif /* ENABLE_EXTERNAL_KEYBOARDS */
+
+static uint32_t
+hangul_keyboard_id_hash(const char* id)
+{
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    while (*id != '\0') {
+	h ^= (unsigned char)*id++;
+	h *= 16777619u;
+    }
+    return h;
+}
+
+static const HangulKeyboard*
+hangul_keyboard_index_lookup(const HangulKeyboardIndex* index, const char* id)
+{
+    size_t mask;
+    size_t i;
+
+    if (index == NULL || index->size == 0)
+	return NULL;
+
+    mask = index->size - 1;
+    i = hangul_keyboard_id_hash(id) & mask;
+    while (index->slots[i] != NULL) {
+	if (strcmp(id, index->slots[i]->id) == 0)
+	    return index->slots[i];
+	i = (i + 1) & mask;
+    }
+
+    return NULL;
+}
+
+/* slots에 자리가 있다고 보고 자판을 넣는다. 같은 id가 있으면 바꾼다. */
+static void
+hangul_keyboard_index_put(const HangulKeyboard** slots, size_t size,
+			  const HangulKeyboard* keyboard, size_t* n)
+{
+    size_t mask = size - 1;
+    size_t i = hangul_keyboard_id_hash(keyboard->id) & mask;
+
+    while (slots[i] != NULL) {
+	if (strcmp(keyboard->id, slots[i]->id) == 0) {
+	    slots[i] = keyboard;
+	    return;
+	}
+	i = (i + 1) & mask;
+    }
+
+    slots[i] = keyboard;
+    (*n)++;
+}
+
+static bool
+hangul_keyboard_index_insert(HangulKeyboardIndex* index,
+			     const HangulKeyboard* keyboard)
+{
+    if (keyboard->id == NULL)
+	return true;
+
+    /* load factor가 1/2을 넘지 않도록 늘린다 */
+    if ((index->n + 1) * 2 > index->size) {
+	size_t size = index->size == 0 ? 32 : index->size * 2;
+	const HangulKeyboard** slots = calloc(size, sizeof(slots[0]));
+	size_t n = 0;
+	size_t i;
+
+	if (slots == NULL)
+	    return false;
+
+	for (i = 0; i < index->size; ++i) {
+	    if (index->slots[i] != NULL)
+		hangul_keyboard_index_put(slots, size, index->slots[i], &n);
+	}
+
+	free(index->slots);
+	index->slots = slots;
+	index->size = size;
+	index->n = n;
+    }
+
+    hangul_keyboard_index_put(index->slots, index->size, keyboard, &index->n);
+    return true;
+}
+
+static void
+hangul_keyboard_index_clear(HangulKeyboardIndex* index)
+{
+    free(index->slots);
+    index->n = 0;
+    index->size = 0;
+    index->slots = NULL;
+}
+
+static HangulKeyboardList*
+hangul_keyboard_list_new()
+{
+    HangulKeyboardList* list = malloc(sizeof(HangulKeyboardList));
+    if (list == NULL)
+	return NULL;
+
+    list->n = 0;
+    list->nalloced = 0;
+    list->keyboards = NULL;
+    list->index.n = 0;
+    list->index.size = 0;
+    list->index.slots = NULL;
+    list->retired_next = NULL;
+    list->retired_generation = 0;
+    return list;
+}
+
+/* 목록만 해제한다. 목록에 있는 자판은 해제하지 않는다. */
+static void
+hangul_keyboard_list_delete(HangulKeyboardList* list)
+{
+    if (list == NULL)
+	return;
+
+    free(list->keyboards);
+    hangul_keyboard_index_clear(&list->index);
+    free(list);
+}
+
+/* 목록에서 skip 번째 자판을 뺀 복사본을 만든다. 빼지 않으려면
+ * skip에 list->n 보다 큰 값을 준다. */
+static HangulKeyboardList*
+hangul_keyboard_list_copy(const HangulKeyboardList* list, size_t skip)
+{
+    HangulKeyboardList* copy = hangul_keyboard_list_new();
+    size_t i;
+
+    if (copy == NULL || list == NULL)
+	return copy;
+
+    for (i = 0; i < list->n; ++i) {
+	if (i == skip)
+	    continue;
+
+	if (!hangul_keyboard_list_append(copy, list->keyboards[i])) {
+	    hangul_keyboard_list_delete(copy);
+	    return NULL;
+	}
+    }
+
+    return copy;
+}
+
+static void
+hangul_keyboard_list_lock()
+{
+    while (!hangul_atomic_try_lock(&hangul_keyboard_list_writer_lock))
+	hangul_thread_yield();
+}
+
+static void
+hangul_keyboard_list_unlock()
+{
+    hangul_atomic_unlock(&hangul_keyboard_list_writer_lock);
+}
+
+/* 읽는 쪽은 잠금 없이 현재 목록을 얻는다. 목록을 다 사용하면
+ * generation에 받은 값으로 hangul_keyboard_list_read_end()를 불러야 한다. */
+static const HangulKeyboardList*
+hangul_keyboard_list_read_begin(long* generation)
+{
+    long g;
+
+    /* 등록하는 사이에 세대가 바뀌었으면 새 세대에 다시 등록한다 */
+    for (;;) {
+	g = hangul_atomic_load_long(&hangul_keyboard_list_generation);
+	hangul_atomic_inc(&hangul_keyboard_list_readers[g & 1]);
+	if (hangul_atomic_load_long(&hangul_keyboard_list_generation) == g)
+	    break;
+	hangul_atomic_dec(&hangul_keyboard_list_readers[g & 1]);
+    }
+
+    *generation = g;
+    return hangul_atomic_load_ptr(&hangul_keyboards);
+}
+
+static void
+hangul_keyboard_list_read_end(long generation)
+{
+    hangul_atomic_dec(&hangul_keyboard_list_readers[generation & 1]);
+}
+
+/* 새 목록을 공개하고 이전 목록은 지금 세대를 붙여 해제 대기 목록에 넣는다.
+ * 어떤 목록을 읽고 있는 쓰레드는 그 목록이 바뀌기 전이나 바뀐 세대에
+ * 등록했다. 세대는 이전 세대에 등록한 쓰레드가 모두 끝났을 때에만 다음
+ * 세대로 넘어가므로, 지금 세대가 g일 때 g - 1 세대의 쓰레드가 없으면
+ * g - 1 세대까지 바뀐 목록은 읽는 쓰레드가 없다. 그 목록들을 해제하고
+ * 세대를 넘긴다. 읽는 쓰레드가 계속 있어도 각 쓰레드는 곧 끝나므로
+ * 전역적으로 읽는 쓰레드가 없는 순간을 기다리지 않아도 해제할 수 있다.
+ * 읽는 쓰레드가 오래 멈춰 있어서 해제 대기 목록이
+ * HANGUL_KEYBOARD_LIST_MAX_RETIRED 개를 넘으면 이전 세대의 쓰레드가
+ * 끝날 때까지 기다린다. 목록을 읽는 동안에는 잠금이나 콜백이 없으므로
+ * 오래 걸리지 않는다.
+ * 쓰는 쪽 잠금을 가지고 불러야 한다. */
+static void
+hangul_keyboard_list_publish(HangulKeyboardList* list)
+{
+    HangulKeyboardList* old = hangul_atomic_exchange_ptr(&hangul_keyboards, list);
+    HangulKeyboardList** p;
+    long g;
+    int i;
+
+    g = hangul_atomic_load_long(&hangul_keyboard_list_generation);
+    if (old != NULL) {
+	old->retired_generation = g;
+	old->retired_next = hangul_keyboard_list_retired;
+	hangul_keyboard_list_retired = old;
+	hangul_keyboard_list_n_retired++;
+    }
+
+    /* 읽는 쓰레드가 없으면 두 번 넘겨서 방금 바꾼 목록까지 해제한다 */
+    for (i = 0; i < 2; i++) {
+	g = hangul_atomic_load_long(&hangul_keyboard_list_generation);
+	while (hangul_atomic_load_long(&hangul_keyboard_list_readers[(g + 1) & 1]) != 0) {
+	    if (hangul_keyboard_list_n_retired <= HANGUL_KEYBOARD_LIST_MAX_RETIRED)
+		return;
+	    hangul_thread_yield();
+	}
+
+	p = &hangul_keyboard_list_retired;
+	while (*p != NULL) {
+	    old = *p;
+	    if (old->retired_generation < g) {
+		*p = old->retired_next;
+		hangul_keyboard_list_delete(old);
+		hangul_keyboard_list_n_retired--;
+	    } else {
+		p = &old->retired_next;
+	    }
+	}
+
+	hangul_atomic_inc(&hangul_keyboard_list_generation);
+    }
+}
+
+static void
+hangul_keyboard_list_clear()
+{
+    HangulKeyboardList* list;
+    size_t i;
+
+    hangul_keyboard_list_lock();
+
+    list = hangul_atomic_load_ptr(&hangul_keyboards);
+    if (list != NULL) {
+	for (i = 0; i < list->n; ++i) {
+	    hangul_keyboard_delete(list->keyboards[i]);
+	}
+    }
+    hangul_keyboard_list_publish(NULL);
+
+#if ENABLE_EXTERNAL_KEYBOARDS
+    while (hangul_keyboard_bundles != NULL) {
+	HangulKeyboardBundle* bundle = hangul_keyboard_bundles;
+	hangul_keyboard_bundles = bundle->next;
+	hangul_keyboard_bundle_delete(bundle);
+    }
+#endif /* ENABLE_EXTERNAL_KEYBOARDS */
+
+    hangul_keyboard_list_unlock();
+}
+
+#if ENABLE_EXTERNAL_KEYBOARDS
+static char*
+hangul_keyboard_get_default_keyboard_path()
+{
+    char* keyboard_path = NULL;
+    size_t keyboard_path_len = 1;
+
+    /* default LIBHANGUL_KEYBOARD_PATH is
+     * SYSTEM_KEYBOARD_DIR:USER_KEYBOARD_DIR */
+
+#ifdef _WIN32
+    /* system default dir */
+    char* system_dir = NULL;
+    const char* data_dir = getenv("APPDATA");
+    if (data_dir != NULL) {
+        const char* subdir = "/libhangul/keyboards";
+        size_t system_dir_len = strlen(data_dir) + strlen(subdir) + 1;
+        system_dir = (char*)malloc(system_dir_len);
+        if (system_dir != NULL) {
+            snprintf(system_dir, system_dir_len, "%s%s", data_dir, subdir);
+            keyboard_path_len += strlen(system_dir);
+        }
+    }
+    /* user default dir */
+    char* home_dir = getenv("USERPROFILE");
+    if (home_dir == NULL) {
+        /* no user data dir */
+        return system_dir;
+    } else {
+        const char* subdir = "/.libhangul/keyboards";
+        keyboard_path_len += strlen(home_dir) + strlen(subdir);
+        keyboard_path = (char*)malloc(keyboard_path_len);
+        if (keyboard_path != NULL) {
+            if (system_dir != NULL) {
+                keyboard_path_len++;
+                snprintf(keyboard_path, keyboard_path_len, "%s;%s%s", system_dir, home_dir, subdir);
+	    } else {
+                snprintf(keyboard_path, keyboard_path_len, "%s%s", home_dir, subdir);
+	    }
+        }
+    }
+#else
+    /* system default dir */
+    const char* system_dir = LIBHANGUL_KEYBOARD_DIR;
+    keyboard_path_len += strlen(system_dir);
+
+    /* user default dir */
+    char* xdg_data_home = getenv("XDG_DATA_HOME");
+    if (xdg_data_home == NULL) {
+        char* home_dir = getenv("HOME");
+        if (home_dir == NULL) {
+            /* no user data dir */
+            keyboard_path = (char*)malloc(keyboard_path_len);
+            if (keyboard_path != NULL) {
+                snprintf(keyboard_path, keyboard_path_len, "%s", system_dir);
+            }
+        } else {
+            const char* subdir = "/.local/share/libhangul/keyboards";
+            keyboard_path_len += 1 + strlen(home_dir) + strlen(subdir);
+            keyboard_path = (char*)malloc(keyboard_path_len);
+            if (keyboard_path != NULL) {
+                snprintf(keyboard_path, keyboard_path_len, "%s:%s%s", system_dir, home_dir, subdir);
+            }
+        }
+    } else {
+        const char* subdir = "/libhangul/keyboards";
+        keyboard_path_len += 1 + strlen(xdg_data_home) + strlen(subdir);
+        keyboard_path = (char*)malloc(keyboard_path_len);
+        if (keyboard_path != NULL) {
+            snprintf(keyboard_path, keyboard_path_len, "%s:%s%s", system_dir, xdg_data_home, subdir);
+        }
+    }
+#endif /* _WIN32 */
+
+    return keyboard_path;
+}
+
+static char*
+hangul_keyboard_get_keyboard_path()
+{
+    char* keyboard_path = getenv("LIBHANGUL_KEYBOARD_PATH");
+    if (keyboard_path == NULL) {
+        keyboard_path = hangul_keyboard_get_default_keyboard_path();
+    } else {
+        keyboard_path = strdup(keyboard_path);
+    }
+
+    return keyboard_path;
+}
+#endif /* ENABLE_EXTERNAL_KEYBOARDS */
+
+int
+hangul_keyboard_list_init(const char* user_defined_keyboard_path,
+			  unsigned n_threads)
+{
+#if ENABLE_EXTERNAL_KEYBOARDS
+    hangul_keyboard_list_lock();
+
+    /* 이 함수를 중복 호출할 경우에 대한 처리
+     * 이미 등록된 자판이 있다면 중복 호출된 것으로 보고
+     * 함수를 종료한다. */
+    HangulKeyboardList* list = hangul_atomic_load_ptr(&hangul_keyboards);
+    if (list != NULL && list->n > 0) {
+	hangul_keyboard_list_unlock();
+	return 2;
+    }
+
+    /* 다 읽은 후에 한번에 공개한다 */
+    list = hangul_keyboard_list_copy(list, SIZE_MAX);
+    if (list == NULL) {
+	hangul_keyboard_list_unlock();
+	return 1;
+    }
+
+    /* libhangul data dir에서 keyboard 로딩 */
+    char* libhangul_keyboard_path = NULL;
+    if (user_defined_keyboard_path == NULL) {
+        libhangul_keyboard_path = hangul_keyboard_get_keyboard_path();
+    } else {
+        libhangul_keyboard_path = strdup(user_defined_keyboard_path);
     }
 
     unsigned n = 0;
@@ -1048,12 +3183,25 @@ hangul_keyboard_list_init(const char* user_defined_keyboard_path)
             ++next;
         }
 
-        n += hangul_keyboard_list_load_dir(dir);
+        /* 번들 파일이 있으면 xml 파일 대신 번들을 읽는다 */
+        unsigned loaded = hangul_keyboard_list_load_bundle(list, dir);
+        if (loaded == 0)
+            loaded = hangul_keyboard_list_scan_dir(list, dir, n_threads);
+
+        n += loaded;
         dir = next;
     }
 
     free(libhangul_keyboard_path);
 
+    if (list->n > 0) {
+	hangul_keyboard_list_publish(list);
+    } else {
+	hangul_keyboard_list_delete(list);
+    }
+
+    hangul_keyboard_list_unlock();
+
     if (n == 0)
 	return 1;
 
@@ -1103,9 +3251,49 @@ hangul_builtin_keyboard_list_get_keyboard_name(unsigned index_)
     return _(keyboard->name);
 }
 
+/* 여러 쓰레드에서 동시에 만들면 먼저 등록한 것을 사용한다. */
+static const HangulKeyboardIndex*
+hangul_builtin_keyboard_list_get_index()
+{
+    HangulKeyboardIndex* index;
+    HangulKeyboardIndex* expected = NULL;
+    size_t i;
+
+    index = hangul_atomic_load_ptr(&hangul_builtin_keyboard_index);
+    if (index != NULL)
+	return index;
+
+    index = malloc(sizeof(HangulKeyboardIndex));
+    if (index == NULL)
+	return NULL;
+
+    index->n = 0;
+    index->size = 0;
+    index->slots = NULL;
+    for (i = 0; i < hangul_builtin_keyboard_count; ++i) {
+	if (!hangul_keyboard_index_insert(index, hangul_builtin_keyboards[i])) {
+	    hangul_keyboard_index_clear(index);
+	    free(index);
+	    return NULL;
+	}
+    }
+
+    if (!hangul_atomic_cas_ptr(&hangul_builtin_keyboard_index, &expected, index)) {
+	hangul_keyboard_index_clear(index);
+	free(index);
+	index = expected;
+    }
+
+    return index;
+}
+
 static const HangulKeyboard*
 hangul_builtin_keyboard_list_get_keyboard(const char* id)
 {
+    const HangulKeyboardIndex* index = hangul_builtin_keyboard_list_get_index();
+    if (index != NULL)
+	return hangul_keyboard_index_lookup(index, id);
+
     size_t i;
     for (i = hangul_builtin_keyboard_count; i > 0; --i) {
         const HangulKeyboard* keyboard = hangul_builtin_keyboards[i - 1];
@@ -1128,7 +3316,12 @@ unsigned int
 hangul_keyboard_list_get_count()
 {
     unsigned int n = hangul_builtin_keyboard_count;
-    n += hangul_keyboards.n;
+
+    long generation;
+    const HangulKeyboardList* list = hangul_keyboard_list_read_begin(&generation);
+    if (list != NULL)
+	n += list->n;
+    hangul_keyboard_list_read_end(generation);
 
     return n;
 }
@@ -1150,10 +3343,14 @@ hangul_keyboard_list_get_keyboard_id(unsigned index_)
     }
 
     index_ -= hangul_builtin_keyboard_count;
-    if (index_ >= hangul_keyboards.n)
-	return NULL;
 
-    HangulKeyboard* keyboard = hangul_keyboards.keyboards[index_];
+    const HangulKeyboard* keyboard = NULL;
+    long generation;
+    const HangulKeyboardList* list = hangul_keyboard_list_read_begin(&generation);
+    if (list != NULL && index_ < list->n)
+	keyboard = list->keyboards[index_];
+    hangul_keyboard_list_read_end(generation);
+
     if (keyboard == NULL)
 	return NULL;
 
@@ -1177,10 +3374,14 @@ hangul_keyboard_list_get_keyboard_name(unsigned index_)
     }
 
     index_ -= hangul_builtin_keyboard_count;
-    if (index_ >= hangul_keyboards.n)
-	return NULL;
 
-    HangulKeyboard* keyboard = hangul_keyboards.keyboards[index_];
+    const HangulKeyboard* keyboard = NULL;
+    long generation;
+    const HangulKeyboardList* list = hangul_keyboard_list_read_begin(&generation);
+    if (list != NULL && index_ < list->n)
+	keyboard = list->keyboards[index_];
+    hangul_keyboard_list_read_end(generation);
+
     if (keyboard == NULL)
 	return NULL;
 
@@ -1198,13 +3399,27 @@ hangul_keyboard_list_get_keyboard(const char* id)
 {
     const HangulKeyboard* keyboard = NULL;
 
-    /* 키보드 목록에서 역순으로 검색을 하여 마지막에 등록된 자판이
-     * 먼저 인식 된다. */
-    for (size_t i = hangul_keyboards.n; i > 0; --i) {
-        keyboard = hangul_keyboards.keyboards[i - 1];
-        if (strcmp(id, keyboard->id) == 0) {
-            return keyboard;
-        }
+    if (id == NULL)
+	return NULL;
+
+    /* 인덱스는 같은 id의 자판 중 마지막에 등록된 자판을 가리키므로
+     * 마지막에 등록된 자판이 먼저 인식 된다. */
+    long generation;
+    const HangulKeyboardList* list = hangul_keyboard_list_read_begin(&generation);
+    if (list != NULL)
+	keyboard = hangul_keyboard_index_lookup(&list->index, id);
+    hangul_keyboard_list_read_end(generation);
+
+    if (keyboard != NULL) {
+#if ENABLE_EXTERNAL_KEYBOARDS
+	/* 처음 찾는 자판이면 xml 파일의 나머지를 읽는다 */
+	if (hangul_atomic_load_ptr(&((HangulKeyboard*)keyboard)->path) != NULL) {
+	    hangul_keyboard_list_lock();
+	    hangul_keyboard_load((HangulKeyboard*)keyboard);
+	    hangul_keyboard_list_unlock();
+	}
+#endif /* ENABLE_EXTERNAL_KEYBOARDS */
+	return keyboard;
     }
 
     /* 등록된 자판 중에 없으면 builtin 자판을 찾아본다. */
@@ -1212,26 +3427,30 @@ hangul_keyboard_list_get_keyboard(const char* id)
     return keyboard;
 }
 
+/* 아직 공개하지 않은 목록에 자판을 추가한다. */
 static bool
-hangul_keyboard_list_append(HangulKeyboard* keyboard)
+hangul_keyboard_list_append(HangulKeyboardList* list, HangulKeyboard* keyboard)
 {
-    if (hangul_keyboards.n >= hangul_keyboards.nalloced) {
-	size_t n = hangul_keyboards.nalloced * 2;
+    if (list->n >= list->nalloced) {
+	size_t n = list->nalloced * 2;
 	if (n == 0) {
 	    n = 16;
 	}
-	HangulKeyboard** keyboards = hangul_keyboards.keyboards;
+	HangulKeyboard** keyboards = list->keyboards;
 	keyboards = realloc(keyboards, n * sizeof(keyboards[0]));
 	if (keyboards == NULL)
 	    return false;
 
-	hangul_keyboards.nalloced = n;
-	hangul_keyboards.keyboards = keyboards;
+	list->nalloced = n;
+	list->keyboards = keyboards;
     }
 
-    size_t i = hangul_keyboards.n;
-    hangul_keyboards.keyboards[i] = keyboard;
-    hangul_keyboards.n = i + 1;
+    if (!hangul_keyboard_index_insert(&list->index, keyboard))
+	return false;
+
+    size_t i = list->n;
+    list->keyboards[i] = keyboard;
+    list->n = i + 1;
 
     return true;
 }
@@ -1243,6 +3462,9 @@ hangul_keyboard_list_append(HangulKeyboard* keyboard)
  * @return keyboard 의 id, 키보드를 선택하거나 unregister할때 사용하는 id다.
  *
  * 여기에 등록된 키보드는 hangul_ic_select()를 통해서 선택될 수 있게 된다.
+ * 같은 id의 키보드가 이미 있으면 @a keyboard 가 대신 선택되고,
+ * hangul_keyboard_list_unregister_keyboard()로 빼면 먼저 등록된 키보드가
+ * 다시 선택된다.
  * 이후 @a keyboard 는 libhangul이 관리하므로 사용자가 임의로 삭제해서는 안된다.
  * hangul_fini() 함수 안에서 삭제될 것이다.
  */
@@ -1252,11 +3474,20 @@ hangul_keyboard_list_register_keyboard(HangulKeyboard* keyboard)
     if (keyboard == NULL)
         return NULL;
 
-    bool res = hangul_keyboard_list_append(keyboard);
-    if (!res) {
+    hangul_keyboard_list_lock();
+
+    HangulKeyboardList* list;
+    list = hangul_keyboard_list_copy(hangul_atomic_load_ptr(&hangul_keyboards),
+				     SIZE_MAX);
+    if (list == NULL || !hangul_keyboard_list_append(list, keyboard)) {
+	hangul_keyboard_list_delete(list);
+	hangul_keyboard_list_unlock();
         return NULL;
     }
 
+    hangul_keyboard_list_publish(list);
+    hangul_keyboard_list_unlock();
+
     return keyboard->id;
 }
 
@@ -1266,30 +3497,69 @@ hangul_keyboard_list_register_keyboard(HangulKeyboard* keyboard)
  * @param id 삭제할 키보드 id
  * @return 리스트에서 삭제된 HangulKeyboard 의 포인터, 이 포인터는 더이상 libhangul에서
  *         관리하지 않으므로 사용자가 hangul_keyboard_delete() 함수로 삭제해야 한다.
+ *
+ * 같은 id의 키보드가 여럿이면 지금 선택되는 키보드, 즉 마지막에 등록된
+ * 키보드를 삭제한다.
+ * hangul-keyboards.bin 번들에서 읽은 자판은 번들의 메모리를 그대로 쓰므로,
+ * 목록에서 빼낸 자판 대신 그 복사본을 돌려 준다.
  */
 HangulKeyboard*
 hangul_keyboard_list_unregister_keyboard(const char* id)
 {
     HangulKeyboard* keyboard = NULL;
 
+    if (id == NULL)
+	return NULL;
+
+    hangul_keyboard_list_lock();
+
+    const HangulKeyboardList* old = hangul_atomic_load_ptr(&hangul_keyboards);
+    size_t n = old != NULL ? old->n : 0;
     size_t i;
-    for (i = 0; i < hangul_keyboards.n; ++i) {
-        keyboard = hangul_keyboards.keyboards[i];
-        if (strcmp(id, keyboard->id) == 0) {
+    /* 인덱스가 찾아 주는 자판, 즉 같은 id로 마지막에 등록된 자판을 뺀다 */
+    for (i = n; i > 0; --i) {
+        if (strcmp(id, old->keyboards[i - 1]->id) == 0) {
+            keyboard = old->keyboards[i - 1];
             break;
         }
     }
 
     if (keyboard == NULL) {
+	hangul_keyboard_list_unlock();
         return NULL;
     }
 
-    for (++i; i < hangul_keyboards.n; ++i) {
-        hangul_keyboards.keyboards[i - 1] = hangul_keyboards.keyboards[i];
+#if ENABLE_EXTERNAL_KEYBOARDS
+    /* 돌려 준 자판은 바로 사용할 수 있어야 한다 */
+    hangul_keyboard_load(keyboard);
+
+    /* 번들의 자판은 목록에서 빼도 번들이 계속 가지고 있으므로,
+     * 사용자가 고치고 지울 수 있는 복사본을 돌려 준다. */
+    HangulKeyboard* bundle_keyboard = NULL;
+    if (keyboard->is_static) {
+	bundle_keyboard = keyboard;
+	keyboard = hangul_keyboard_bundle_copy_keyboard(bundle_keyboard);
+	if (keyboard == NULL) {
+	    hangul_keyboard_list_unlock();
+	    return NULL;
+	}
+    }
+#endif /* ENABLE_EXTERNAL_KEYBOARDS */
+
+    /* 새 목록의 인덱스는 남은 자판을 등록 순서대로 넣어 만들므로
+     * 같은 id로 먼저 등록된 자판이 다시 인식된다. */
+    HangulKeyboardList* list = hangul_keyboard_list_copy(old, i - 1);
+    if (list == NULL) {
+#if ENABLE_EXTERNAL_KEYBOARDS
+	if (bundle_keyboard != NULL)
+	    hangul_keyboard_delete(keyboard);
+#endif /* ENABLE_EXTERNAL_KEYBOARDS */
+	hangul_keyboard_list_unlock();
+	return NULL;
     }
 
-    hangul_keyboards.keyboards[i - 1] = NULL;
-    hangul_keyboards.n--;
+    hangul_keyboard_list_publish(list);
+    hangul_keyboard_list_unlock();
 
     return keyboard;
 }
@@ -152,6 +152,8 @@
  */
 
 typedef struct _HanjaIndex     HanjaIndex;
+typedef struct _HanjaChoseongKey HanjaChoseongKey;
+typedef struct _HanjaKeyIndex  HanjaKeyIndex;
 
 typedef struct _HanjaPair      HanjaPair;
 typedef struct _HanjaPairArray HanjaPairArray;
@@ -174,11 +176,31 @@ struct _HanjaIndex {
     char     key[8];
 };
 
+/* 초성 검색 키. signature는 키의 초성을 hanja_choseong_signature()로 만든
+ * 것이고, offset은 그 키가 시작하는 줄의 위치다. 정렬을 빠르게 하기 위해서
+ * signature의 앞 8 byte를 prefix에 정수로 가지고 있다. */
+struct _HanjaChoseongKey {
+    uint64_t    prefix;
+    const char* signature;
+    unsigned    offset;
+};
+
+/* 초성 검색과 근사 검색에 쓰는 인덱스. 사전의 키를 모두 메모리에 읽어야
+ * 하므로 처음 검색할 때 만든다.
+ * strings는 같은 키마다 "키\0초성\0"을 사전의 순서로 모은 것이고,
+ * choseong_keys는 그 초성을 정렬한 것이다. */
+struct _HanjaKeyIndex {
+    HanjaChoseongKey* choseong_keys;
+    unsigned          n;
+    char*             strings;
+};
+
 struct _HanjaTable {
     HanjaIndex*    keytable;
     unsigned       nkeys;
     unsigned       key_size;
     FILE*          file;
+    HanjaKeyIndex* key_index;
 };
 
 struct _HanjaPair {
@@ -402,6 +424,32 @@ hanja_list_append_n(HanjaList* list, const Hanja* hanja, int n)
     }
 }
 
+/* strtok_r()로 키를 읽은 줄의 나머지를 읽어서 list에 추가한다.
+ * list가 없으면 listkey로 만들고, 만들 수 없으면 false를 리턴한다. */
+static bool
+hanja_list_append_line(HanjaList** list, const char* listkey,
+		       const char* key, char** save)
+{
+    if (*list == NULL) {
+	*list = hanja_list_new(listkey);
+    }
+
+    if (*list == NULL) {
+	return false;
+    }
+
+    char* value   = strtok_r(NULL, ":", save);
+    char* comment = strtok_r(NULL, "\r\n", save);
+
+    if (value != NULL) {
+	Hanja* hanja = hanja_new(key, value, comment);
+	if (hanja != NULL)
+	    hanja_list_append_n(*list, hanja, 1);
+    }
+
+    return true;
+}
+
 static void
 hanja_table_match(const HanjaTable* table,
 		  const char* key, HanjaList** list)
@@ -441,27 +489,279 @@ hanja_table_match(const HanjaTable* table,
 	    char* p = strtok_r(buf, ":", &save);
 	    res = strcmp(p, key);
 	    if (res == 0) {
-                if (*list == NULL) {
-                    *list = hanja_list_new(key);
-                }
+		if (!hanja_list_append_line(list, key, p, &save))
+		    break;
+	    } else if (res > 0) {
+		break;
+	    }
+	}
+    }
+}
+
+/* key의 초성 검색 키를 dest에 쓰고 그 길이를 리턴한다. 키는 0으로 끝난다.
+ * 키를 작게 하기 위해서 현대 한글 초성의 호환 자모(U+3131-U+314E)는
+ * 0x81-0x9e의 1 byte로 쓰고 나머지 글자는 UTF-8 그대로 쓴다. 0x80-0xbf는
+ * UTF-8 글자의 첫 byte가 될 수 없으므로 앞에서부터 읽으면 구분할 수 있고,
+ * 따라서 키의 앞부분이 같으면 초성도 앞부분이 같다.
+ * 키는 key보다 길지 않다. */
+static int
+hanja_choseong_signature(char* dest, int destlen, const char* key)
+{
+    int i, j, n;
+
+    n = hangul_syllables_to_choseongs_utf8(dest, destlen - 1, key, -1);
+
+    for (i = 0, j = 0; i < n; ) {
+	const unsigned char* s = (const unsigned char*)dest + i;
+	if (n - i >= 3 && s[0] == 0xe3 && (s[1] == 0x84 || s[1] == 0x85)) {
+	    unsigned c = 0x3000 | ((s[1] & 0x3f) << 6) | (s[2] & 0x3f);
+	    if (c >= 0x3131 && c <= 0x314e) {
+		dest[j++] = (char)(0x80 + (c - 0x3130));
+		i += 3;
+		continue;
+	    }
+	}
+	dest[j++] = dest[i++];
+    }
+    dest[j] = '\0';
 
-                if (*list == NULL) {
-                    break;
-                }
+    return j;
+}
 
-		char* value   = strtok_r(NULL, ":", &save);
-		char* comment = strtok_r(NULL, "\r\n", &save);
+/* signature의 앞 8 byte를 비교하는 순서가 같도록 big endian 정수로 만든다 */
+static uint64_t
+hanja_choseong_prefix(const char* signature)
+{
+    uint64_t prefix = 0;
+    int i;
 
-		Hanja* hanja = hanja_new(p, value, comment);
+    for (i = 0; i < 8; i++) {
+	prefix <<= 8;
+	if (signature[0] != '\0')
+	    prefix |= (unsigned char)*signature++;
+    }
 
-		hanja_list_append_n(*list, hanja, 1);
-	    } else if (res > 0) {
-		break;
-	    }
+    return prefix;
+}
+
+static int
+compare_choseong_key(const void* a, const void* b)
+{
+    const HanjaChoseongKey* x = a;
+    const HanjaChoseongKey* y = b;
+    int res;
+
+    if (x->prefix != y->prefix)
+	return x->prefix < y->prefix ? -1 : 1;
+
+    /* 앞 8 byte가 같을 때만 나머지를 비교한다 */
+    res = 0;
+    if ((x->prefix & 0xff) != 0)
+	res = strcmp(x->signature + 8, y->signature + 8);
+
+    /* 초성이 같으면 사전의 순서를 따른다 */
+    if (res == 0)
+	res = x->offset < y->offset ? -1 : x->offset > y->offset;
+
+    return res;
+}
+
+/* 초성 검색 키를 정렬한다. 키는 사전의 순서로 만들어지므로 prefix를
+ * 안정적인 radix sort로 정렬하면 초성이 같은 키는 사전의 순서를 유지한다.
+ * prefix가 같고 8 byte보다 긴 키만 나머지를 비교하여 다시 정렬한다. */
+static void
+hanja_choseong_keys_sort(HanjaChoseongKey* keys, unsigned n)
+{
+    unsigned count[8][256];
+    HanjaChoseongKey* src = keys;
+    HanjaChoseongKey* dest;
+    HanjaChoseongKey* tmp;
+    unsigned i, j, b;
+
+    if (n < 2)
+	return;
+
+    tmp = malloc(n * sizeof(keys[0]));
+    if (tmp == NULL) {
+	qsort(keys, n, sizeof(keys[0]), compare_choseong_key);
+	return;
+    }
+
+    memset(count, 0, sizeof(count));
+    for (i = 0; i < n; i++) {
+	for (b = 0; b < 8; b++)
+	    count[b][(keys[i].prefix >> (b * 8)) & 0xff]++;
+    }
+
+    dest = tmp;
+    for (b = 0; b < 8; b++) {
+	unsigned pos[256];
+	unsigned sum = 0;
+
+	/* 모든 키의 byte가 같으면 건너뛴다 */
+	if (count[b][(keys[0].prefix >> (b * 8)) & 0xff] == n)
+	    continue;
+
+	for (i = 0; i < 256; i++) {
+	    pos[i] = sum;
+	    sum += count[b][i];
 	}
+
+	for (i = 0; i < n; i++)
+	    dest[pos[(src[i].prefix >> (b * 8)) & 0xff]++] = src[i];
+
+	dest = src;
+	src = src == keys ? tmp : keys;
+    }
+
+    if (src != keys)
+	memcpy(keys, src, n * sizeof(keys[0]));
+    free(tmp);
+
+    for (i = 0; i < n; i = j) {
+	for (j = i + 1; j < n && keys[j].prefix == keys[i].prefix; j++)
+	    continue;
+	if (j - i > 1 && (keys[i].prefix & 0xff) != 0)
+	    qsort(keys + i, j - i, sizeof(keys[0]), compare_choseong_key);
     }
 }
 
+static void
+hanja_key_index_delete(HanjaKeyIndex* index)
+{
+    if (index == NULL)
+	return;
+
+    free(index->choseong_keys);
+    free(index->strings);
+    free(index);
+}
+
+/* 사전 파일을 처음부터 읽어서 키 인덱스를 만든다. 다른 검색 함수는 읽기
+ * 전에 fseek하므로 파일의 위치는 신경쓰지 않는다. */
+static HanjaKeyIndex*
+hanja_key_index_new(FILE* file)
+{
+    char buf[512];
+    char prev_key[512] = { '\0', };
+    char* save_ptr;
+    char* key;
+    char* p;
+    long offset;
+    size_t strings_size;
+    unsigned n, j;
+    HanjaKeyIndex* index;
+
+    if (file == NULL)
+	return NULL;
+
+    rewind(file);
+
+    /* 같은 키마다 하나씩 만든다. 초성은 키보다 길지 않다. */
+    n = 0;
+    strings_size = 0;
+    while (fgets(buf, sizeof(buf), file) != NULL) {
+	/* skip comments and empty lines */
+	if (buf[0] == '#' || buf[0] == '\r' || buf[0] == '\n' || buf[0] == '\0')
+	    continue;
+
+	save_ptr = NULL;
+	key = strtok_r(buf, ":", &save_ptr);
+
+	if (key == NULL || strlen(key) == 0)
+	    continue;
+
+	if (strcmp(prev_key, key) != 0) {
+	    n++;
+	    strings_size += 2 * (strlen(key) + 1);
+	    strcpy(prev_key, key);
+	}
+    }
+
+    index = calloc(1, sizeof(*index));
+    if (index == NULL)
+	return NULL;
+
+    if (n > 0) {
+	index->choseong_keys = malloc(n * sizeof(index->choseong_keys[0]));
+	index->strings = malloc(strings_size);
+	if (index->choseong_keys == NULL || index->strings == NULL) {
+	    hanja_key_index_delete(index);
+	    return NULL;
+	}
+    }
+
+    rewind(file);
+    prev_key[0] = '\0';
+    p = index->strings;
+    j = 0;
+    offset = ftell(file);
+    while (fgets(buf, sizeof(buf), file) != NULL) {
+	/* skip comments and empty lines */
+	if (buf[0] == '#' || buf[0] == '\r' || buf[0] == '\n' || buf[0] == '\0')
+	    continue;
+
+	save_ptr = NULL;
+	key = strtok_r(buf, ":", &save_ptr);
+
+	if (key == NULL || strlen(key) == 0)
+	    continue;
+
+	if (strcmp(prev_key, key) != 0 && j < n) {
+	    HanjaChoseongKey* entry = &index->choseong_keys[j];
+	    int len = strlen(key);
+
+	    memcpy(p, key, len + 1);
+	    p += len + 1;
+	    entry->signature = p;
+	    entry->offset = offset;
+	    p += hanja_choseong_signature(p, len + 1, key) + 1;
+	    entry->prefix = hanja_choseong_prefix(entry->signature);
+	    j++;
+	    strcpy(prev_key, key);
+	}
+	offset = ftell(file);
+    }
+
+    index->n = j;
+    hanja_choseong_keys_sort(index->choseong_keys, index->n);
+
+    return index;
+}
+
+/* 키 인덱스를 구한다. 없으면 만들어서 table에 넣는다. HanjaTable 은
+ * 다른 검색 함수와 같이 한 쓰레드에서만 쓴다고 가정하므로 잠그지 않는다. */
+static const HanjaKeyIndex*
+hanja_table_get_key_index(const HanjaTable* table)
+{
+    HanjaTable* t = (HanjaTable*)table;
+
+    if (t->key_index == NULL)
+	t->key_index = hanja_key_index_new(t->file);
+
+    return t->key_index;
+}
+
+/* strings 안의 signature에 해당하는 키의 위치를 찾는다. 같은 초성은
+ * 사전의 순서, 즉 strings 안의 순서로 정렬되어 있다. */
+static unsigned
+hanja_key_index_get_offset(const HanjaKeyIndex* index, const char* signature)
+{
+    unsigned low = 0, high = index->n, mid;
+
+    while (low < high) {
+	int res;
+	mid = low + (high - low) / 2;
+	res = strcmp(index->choseong_keys[mid].signature, signature);
+	if (res < 0 || (res == 0 && index->choseong_keys[mid].signature < signature))
+	    low = mid + 1;
+	else
+	    high = mid;
+    }
+
+    return index->choseong_keys[low].offset;
+}
+
 /**
  * @ingroup hanjadictionary
  * @brief 한자 사전 파일을 로딩하는 함수
@@ -561,6 +861,8 @@ hanja_table_load(const char* filename)
     table->nkeys = nkeys;
     table->key_size = key_size;
     table->file = file;
+    /* 초성 인덱스는 처음 검색할 때 만든다 */
+    table->key_index = NULL;
 
     return table;
 }
@@ -575,6 +877,7 @@ hanja_table_delete(HanjaTable *table)
 {
     if (table != NULL) {
 	free(table->keytable);
+	hanja_key_index_delete(table->key_index);
 	fclose(table->file);
 	free(table);
     }
@@ -678,6 +981,197 @@ hanja_table_match_suffix(const HanjaTable* table, const char *key)
     return ret;
 }
 
+/* offset에서 시작하는, 키가 같은 줄을 모두 list에 추가한다 */
+static void
+hanja_table_read_entries(const HanjaTable* table, unsigned offset,
+			 const char* listkey, HanjaList** list)
+{
+    char buf[512];
+    char key[512] = { '\0', };
+
+    fseek(table->file, offset, SEEK_SET);
+
+    while (fgets(buf, sizeof(buf), table->file) != NULL) {
+	char* save = NULL;
+	char* p;
+
+	/* skip comments and empty lines */
+	if (buf[0] == '#' || buf[0] == '\r' || buf[0] == '\n' || buf[0] == '\0')
+	    continue;
+
+	p = strtok_r(buf, ":", &save);
+	if (p == NULL)
+	    break;
+
+	if (key[0] == '\0')
+	    strcpy(key, p);
+	else if (strcmp(p, key) != 0)
+	    break;
+
+	if (!hanja_list_append_line(list, listkey, p, &save))
+	    break;
+    }
+}
+
+/**
+ * @ingroup hanjadictionary
+ * @brief 한자 사전에서 초성이 매치되는 키를 가진 엔트리를 찾는 함수
+ * @param table 한자 사전 object
+ * @param key 찾을 초성, UTF-8 인코딩
+ * @return 찾은 결과를 HanjaList object로 리턴한다. 찾은 것이 없거나 에러가 
+ *         있으면 NULL을 리턴한다.
+ *
+ * 키의 초성이 @a key 의 초성으로 시작하는 엔트리를 검색한다.
+ * 예로 들면 "ㅅㄱ"을 검색하면 "사과", "시계", "삼국사기" 등을 찾는다.
+ * @a key 는 @ref hangul_syllables_to_choseongs_utf8 과 같이 초성만
+ * 뽑아서 비교하므로 "사과"나 "ㅅ과"를 주어도 같은 결과가 된다.
+ *
+ * 처음 검색할 때 사전 파일을 한 번 읽어서 모든 키의 초성을 정렬해 두고,
+ * 그 다음부터는 사전의 크기와 관계없이 찾은 엔트리를 읽는 시간만 걸린다.
+ * 이 인덱스는 hanja_table_match_fuzzy()와 같이 쓴다. 다른 검색 함수와
+ * 같이 한 @a table 을 여러 쓰레드에서 동시에 검색해서는 안된다.
+ * 결과는 초성의 순서로, 초성이 같으면 사전의 순서로 정렬되어 있다.
+ * 리턴된 결과는 다 사용하고 나면 반드시 hanja_list_delete() 함수로 free해야
+ * 한다.
+ */
+HanjaList*
+hanja_table_match_choseong(const HanjaTable* table, const char *key)
+{
+    const HanjaKeyIndex* index;
+    char signature[512];
+    unsigned low, high, mid;
+    int len;
+    HanjaList* ret = NULL;
+
+    if (key == NULL || key[0] == '\0' || table == NULL)
+	return NULL;
+
+    len = hanja_choseong_signature(signature, sizeof(signature), key);
+    if (len == 0)
+	return NULL;
+
+    index = hanja_table_get_key_index(table);
+    if (index == NULL)
+	return NULL;
+
+    /* 초성이 signature와 같거나 큰 첫 키를 찾는다. 앞부분이 같은 키는
+     * 여기서부터 이어져 있다. */
+    low = 0;
+    high = index->n;
+    while (low < high) {
+	mid = low + (high - low) / 2;
+	if (strcmp(index->choseong_keys[mid].signature, signature) < 0)
+	    low = mid + 1;
+	else
+	    high = mid;
+    }
+
+    while (low < index->n &&
+	   strncmp(index->choseong_keys[low].signature, signature, len) == 0) {
+	hanja_table_read_entries(table, index->choseong_keys[low].offset,
+				 key, &ret);
+	low++;
+    }
+
+    return ret;
+}
+
+/**
+ * @ingroup hanjadictionary
+ * @brief 한자 사전에서 자모 단위로 비슷한 키를 가진 엔트리를 찾는 함수
+ * @param table 한자 사전 object
+ * @param key 찾을 키, UTF-8 인코딩
+ * @param max_distance 찾을 키의 최대 편집 거리
+ * @return 찾은 결과를 HanjaList object로 리턴한다. 찾은 것이 없거나 에러가 
+ *         있으면 NULL을 리턴한다.
+ *
+ * 키를 @ref hangul_fuzzy_matcher_new 와 같이 자모로 분해하여 @a key 와의
+ * 편집 거리가 @a max_distance 이하인 엔트리를 검색한다. 예로 들면 "핸국"을
+ * 거리 1로 검색하면 "한국"을 찾는다. 입력할 때 생긴 오타를 고려하여 검색할
+ * 때 사용한다.
+ *
+ * 사전의 키는 정렬되어 있으므로 앞부분이 같은 키는 한 번만 비교하고, 앞부분이
+ * 이미 @a max_distance 를 넘은 키는 비교하지 않는다. 결과는 거리의 순서로,
+ * 거리가 같으면 사전의 순서로 정렬되어 있다. @a key 는 자모로 분해해서 64
+ * 자모까지 쓸 수 있다.
+ * 비교할 키 목록은 hanja_table_match_choseong()의 인덱스와 함께 처음 검색할
+ * 때 만들어진다.
+ * 리턴된 결과는 다 사용하고 나면 반드시 hanja_list_delete() 함수로 free해야
+ * 한다.
+ */
+HanjaList*
+hanja_table_match_fuzzy(const HanjaTable* table, const char *key,
+			int max_distance)
+{
+    const HanjaKeyIndex* index;
+    HangulFuzzyMatcher* matcher;
+    /* 찾은 키의 초성과 거리 */
+    const char** matches = NULL;
+    unsigned char* distances = NULL;
+    const char* p;
+    unsigned i, n, alloc;
+    int len, d;
+    HanjaList* ret = NULL;
+
+    if (key == NULL || key[0] == '\0' || table == NULL || max_distance < 0)
+	return NULL;
+
+    if (max_distance > UCHAR_MAX)
+	max_distance = UCHAR_MAX;
+
+    index = hanja_table_get_key_index(table);
+    if (index == NULL)
+	return NULL;
+
+    matcher = hangul_fuzzy_matcher_new_utf8(key, -1, max_distance);
+    if (matcher == NULL)
+	return NULL;
+
+    n = 0;
+    alloc = 0;
+    p = index->strings;
+    for (i = 0; i < index->n; i++) {
+	len = strlen(p);
+	d = hangul_fuzzy_matcher_match_utf8(matcher, p, len);
+	/* 키 다음은 초성이다 */
+	p += len + 1;
+	if (d >= 0) {
+	    if (n == alloc) {
+		const char** m;
+		unsigned char* dist;
+		alloc = alloc > 0 ? alloc * 2 : 16;
+		m = realloc(matches, sizeof(matches[0]) * alloc);
+		if (m != NULL)
+		    matches = m;
+		dist = realloc(distances, sizeof(distances[0]) * alloc);
+		if (dist != NULL)
+		    distances = dist;
+		if (m == NULL || dist == NULL)
+		    break;
+	    }
+	    matches[n] = p;
+	    distances[n] = d;
+	    n++;
+	}
+	p = strchr(p, '\0') + 1;
+    }
+    hangul_fuzzy_matcher_delete(matcher);
+
+    for (d = 0; d <= max_distance; d++) {
+	for (i = 0; i < n; i++) {
+	    if (distances[i] == d) {
+		unsigned offset = hanja_key_index_get_offset(index, matches[i]);
+		hanja_table_read_entries(table, offset, key, &ret);
+	    }
+	}
+    }
+
+    free(matches);
+    free(distances);
+
+    return ret;
+}
+
 /**
  * @ingroup hanjadictionary
  * @brief @ref HanjaList 가 가지고 있는 아이템의 갯수를 구하는 함수
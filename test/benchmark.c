@@ -0,0 +1,1039 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if ENABLE_EXTERNAL_KEYBOARDS
+#ifdef _WIN32
+#include <direct.h>
+#define mkdir(path, mode) _mkdir(path)
+#define rmdir _rmdir
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* _WIN32 */
+#endif // ENABLE_EXTERNAL_KEYBOARDS
+
+#include "../hangul/hangul.h"
+#include "../hangul/hangulinternals.h"
+
+static double
+get_elapsed(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void
+on_translate_nothing(HangulInputContext* hic, int ascii, ucschar* ch, void* data)
+{
+}
+
+static double
+process_keys(HangulInputContext* hic, const char* keys, int n)
+{
+    clock_t start;
+    int i;
+
+    start = clock();
+    for (i = 0; i < n; i++) {
+	hangul_ic_process(hic, keys[i]);
+    }
+    hangul_ic_flush(hic);
+
+    return get_elapsed(start);
+}
+
+static void
+benchmark_process(const char* keyboard, const char* keys, int n)
+{
+    HangulInputContext* hic;
+    double t1, t2;
+
+    /* translate 콜백이 연결되어 있으면 조합 함수로만 처리한다 */
+    hic = hangul_ic_new(keyboard);
+    hangul_ic_connect_callback(hic, "translate", on_translate_nothing, NULL);
+    t1 = process_keys(hic, keys, n);
+    hangul_ic_delete(hic);
+
+    /* 세벌식 자판은 처리하면서 테이블을 만드므로 한번 먼저 처리한다 */
+    hic = hangul_ic_new(keyboard);
+    hangul_ic_compile(hic);
+    process_keys(hic, keys, n);
+    t2 = process_keys(hic, keys, n);
+    hangul_ic_delete(hic);
+
+    printf("process %-4s %8.2f Mkeys/s, automaton %8.2f Mkeys/s\n",
+	    keyboard, n / t1 / 1e6, n / t2 / 1e6);
+}
+
+static void
+benchmark_romaja(const char* keys, int n)
+{
+    HangulInputContext* hic;
+    ucschar* buf;
+    clock_t start;
+    double t1, t2;
+
+    buf = malloc(sizeof(ucschar) * n);
+    if (buf == NULL)
+	return;
+
+    hic = hangul_ic_new("ro");
+    t1 = process_keys(hic, keys, n);
+    hangul_ic_delete(hic);
+
+    start = clock();
+    hangul_romaja_to_syllables(buf, n, keys, n);
+    t2 = get_elapsed(start);
+
+    printf("process %-4s %8.2f Mkeys/s, string    %8.2f Mkeys/s\n",
+	    "ro", n / t1 / 1e6, n / t2 / 1e6);
+
+    free(buf);
+}
+
+typedef struct {
+    uint32_t key;
+    ucschar code;
+} CombinationItem;
+
+static int
+combination_item_cmp(const void* p1, const void* p2)
+{
+    const CombinationItem* item1 = p1;
+    const CombinationItem* item2 = p2;
+
+    if (item1->key < item2->key)
+	return -1;
+    else if (item1->key > item2->key)
+	return 1;
+    return 0;
+}
+
+static int
+append_jamos(ucschar* jamos, int n, ucschar from, ucschar to)
+{
+    ucschar c;
+    for (c = from; c < to; c++)
+	jamos[n++] = c;
+    return n;
+}
+
+/* 자모로 나눈 음절과 공백, 문장 부호로 말뭉치를 만든다.
+ * old가 true이면 옛한글 자모를 섞어서 한 음절씩 조합하는 경우를 본다. */
+static int
+make_jamo_corpus(ucschar* jamos, int n, bool old)
+{
+    int len = 0;
+
+    while (len + 4 <= n) {
+	ucschar cho, jung, jong;
+	int r = rand() % 8;
+
+	if (r == 0) {
+	    jamos[len++] = ' ';
+	    continue;
+	} else if (r == 1 && rand() % 4 == 0) {
+	    jamos[len++] = rand() % 2 ? '.' : ',';
+	    continue;
+	}
+
+	hangul_syllable_to_jamo(0xac00 + rand() % 11172, &cho, &jung, &jong);
+	if (old && rand() % 4 == 0)
+	    cho = 0xa960 + rand() % 29;
+	jamos[len++] = cho;
+	jamos[len++] = jung;
+	if (jong != 0)
+	    jamos[len++] = jong;
+    }
+
+    return len;
+}
+
+static void
+benchmark_jamos_to_syllables(const char* name, bool old, int n)
+{
+    ucschar* jamos;
+    ucschar* syllables;
+    clock_t start;
+    double t;
+    int len, i, m = 0;
+
+    jamos = malloc(sizeof(ucschar) * n);
+    syllables = malloc(sizeof(ucschar) * n);
+    if (jamos == NULL || syllables == NULL) {
+	free(jamos);
+	free(syllables);
+	return;
+    }
+
+    srand(0);
+    len = make_jamo_corpus(jamos, n, old);
+
+    start = clock();
+    for (i = 0; i < 10; i++) {
+	m = hangul_jamos_to_syllables(syllables, n, jamos, len);
+    }
+    t = get_elapsed(start) / 10;
+
+    printf("compose %-6s %8.2f MB/s, %d -> %d\n",
+	    name, len * sizeof(ucschar) / t / 1e6, len, m);
+
+    free(jamos);
+    free(syllables);
+}
+
+/* 자모 스트링을 4096 글자씩 나누어 HangulComposer로 조합하는 것과
+ * 한번에 조합하는 것을 비교한다. */
+static void
+benchmark_composer(int n)
+{
+    HangulComposer* composer;
+    ucschar* jamos;
+    ucschar* syllables;
+    clock_t start;
+    double t1, t2;
+    int len, i, j, m1 = 0, m2 = 0;
+
+    composer = hangul_composer_new();
+    jamos = malloc(sizeof(ucschar) * n);
+    syllables = malloc(sizeof(ucschar) * n);
+    if (composer == NULL || jamos == NULL || syllables == NULL)
+	goto out;
+
+    srand(0);
+    len = make_jamo_corpus(jamos, n, false);
+
+    start = clock();
+    for (i = 0; i < 10; i++) {
+	m1 = hangul_jamos_to_syllables(syllables, n, jamos, len);
+    }
+    t1 = get_elapsed(start) / 10;
+
+    start = clock();
+    for (i = 0; i < 10; i++) {
+	m2 = 0;
+	for (j = 0; j < len; j += 4096) {
+	    int chunk = len - j < 4096 ? len - j : 4096;
+	    m2 += hangul_composer_compose(composer, syllables + m2, n - m2,
+					  jamos + j, chunk, NULL);
+	}
+	m2 += hangul_composer_flush(composer, syllables + m2, n - m2);
+    }
+    t2 = get_elapsed(start) / 10;
+
+    printf("compose stream %8.2f MB/s -> %8.2f MB/s, %d -> %d, %d\n",
+	    len * sizeof(ucschar) / t1 / 1e6,
+	    len * sizeof(ucschar) / t2 / 1e6, len, m1, m2);
+
+out:
+    hangul_composer_delete(composer);
+    free(jamos);
+    free(syllables);
+}
+
+/* 낱말마다 최대 4 음절. 음절마다 자모로 분해하여 비교하는 것과
+ * hangul_sort_key()로 만든 키를 memcmp()로 비교하는 것을 비교한다. */
+#define SORT_WORD_MAX 4
+#define SORT_KEY_MAX 48
+
+typedef struct {
+    ucschar str[SORT_WORD_MAX];
+    int len;
+} SortWord;
+
+typedef struct {
+    char key[SORT_KEY_MAX];
+    int len;
+} SortKey;
+
+static int
+compare_word(const void* a, const void* b)
+{
+    const SortWord* x = a;
+    const SortWord* y = b;
+    int i;
+
+    for (i = 0; i < x->len && i < y->len; i++) {
+	ucschar xc[3], yc[3];
+	int j;
+	hangul_syllable_to_jamo(x->str[i], &xc[0], &xc[1], &xc[2]);
+	hangul_syllable_to_jamo(y->str[i], &yc[0], &yc[1], &yc[2]);
+	for (j = 0; j < 3; j++) {
+	    if (xc[j] != yc[j])
+		return xc[j] < yc[j] ? -1 : 1;
+	}
+    }
+
+    return x->len - y->len;
+}
+
+static int
+compare_key(const void* a, const void* b)
+{
+    const SortKey* x = a;
+    const SortKey* y = b;
+    int r = memcmp(x->key, y->key, x->len < y->len ? x->len : y->len);
+    return r != 0 ? r : x->len - y->len;
+}
+
+static void
+benchmark_sort_key(int n)
+{
+    SortWord* words;
+    SortKey* keys;
+    clock_t start;
+    double t1, t2;
+    int nwords = n / 10;
+    int i, j;
+
+    words = malloc(sizeof(SortWord) * nwords);
+    keys = malloc(sizeof(SortKey) * nwords);
+    if (words == NULL || keys == NULL)
+	goto out;
+
+    srand(0);
+    for (i = 0; i < nwords; i++) {
+	words[i].len = rand() % SORT_WORD_MAX + 1;
+	for (j = 0; j < words[i].len; j++)
+	    words[i].str[j] = 0xac00 + rand() % 11172;
+    }
+
+    start = clock();
+    for (i = 0; i < nwords; i++) {
+	keys[i].len = hangul_sort_key(keys[i].key, SORT_KEY_MAX,
+				      words[i].str, words[i].len);
+    }
+    qsort(keys, nwords, sizeof(SortKey), compare_key);
+    t2 = get_elapsed(start);
+
+    start = clock();
+    qsort(words, nwords, sizeof(SortWord), compare_word);
+    t1 = get_elapsed(start);
+
+    printf("sort %d words   %8.2f ms   -> %8.2f ms\n",
+	    nwords, t1 * 1e3, t2 * 1e3);
+
+out:
+    free(words);
+    free(keys);
+}
+
+/* 음절 경계를 찾는 함수는 글자마다 앞뒤 글자의 종류를 확인한다.
+ * syllables가 true이면 자모 대신 완성된 음절과 공백으로 된 글을 쓴다. */
+static void
+benchmark_syllable_iterator(const char* name, bool syllables, int n)
+{
+    ucschar* jamos;
+    int* offsets;
+    const ucschar* p;
+    const ucschar* end;
+    clock_t start;
+    double t1, t2, t3;
+    int len, i, m1 = 0, m2 = 0, m3 = 0;
+
+    jamos = malloc(sizeof(ucschar) * n);
+    offsets = malloc(sizeof(int) * n);
+    if (jamos == NULL || offsets == NULL) {
+	free(jamos);
+	free(offsets);
+	return;
+    }
+
+    srand(0);
+    if (syllables) {
+	for (len = 0; len < n; len++) {
+	    if (rand() % 6 == 0)
+		jamos[len] = ' ';
+	    else
+		jamos[len] = 0xac00 + rand() % 11172;
+	}
+    } else {
+	len = make_jamo_corpus(jamos, n, true);
+    }
+    end = jamos + len;
+
+    start = clock();
+    for (i = 0; i < 10; i++) {
+	m1 = 0;
+	for (p = jamos; p < end; p = hangul_syllable_iterator_next(p, end))
+	    m1++;
+    }
+    t1 = get_elapsed(start) / 10;
+
+    start = clock();
+    for (i = 0; i < 10; i++) {
+	m2 = 0;
+	for (p = jamos; p < end; p += hangul_syllable_len(p, end - p))
+	    m2++;
+    }
+    t2 = get_elapsed(start) / 10;
+
+    start = clock();
+    for (i = 0; i < 10; i++) {
+	m3 = hangul_syllable_boundaries(offsets, n, jamos, len);
+    }
+    t3 = get_elapsed(start) / 10;
+
+    printf("boundary %-6s iterator %8.2f, syllable_len %8.2f, "
+	   "boundaries %8.2f Mchars/s, %d -> %d, %d, %d\n",
+	    name, len / t1 / 1e6, len / t2 / 1e6, len / t3 / 1e6,
+	    len, m1, m2, m3);
+
+    free(jamos);
+    free(offsets);
+}
+
+static int
+utf8_encode(char* buf, const ucschar* str, int len)
+{
+    int i, n = 0;
+
+    for (i = 0; i < len; i++) {
+	ucschar c = str[i];
+	if (c < 0x80) {
+	    buf[n++] = c;
+	} else if (c < 0x800) {
+	    buf[n++] = 0xc0 | (c >> 6);
+	    buf[n++] = 0x80 | (c & 0x3f);
+	} else {
+	    buf[n++] = 0xe0 | (c >> 12);
+	    buf[n++] = 0x80 | ((c >> 6) & 0x3f);
+	    buf[n++] = 0x80 | (c & 0x3f);
+	}
+    }
+
+    return n;
+}
+
+static int
+utf8_decode(ucschar* buf, const char* str, int len)
+{
+    const unsigned char* s = (const unsigned char*)str;
+    const unsigned char* end = s + len;
+    int n = 0;
+
+    while (s < end) {
+	if (s[0] < 0x80) {
+	    buf[n++] = s[0];
+	    s += 1;
+	} else if (s[0] < 0xe0) {
+	    buf[n++] = ((s[0] & 0x1f) << 6) | (s[1] & 0x3f);
+	    s += 2;
+	} else {
+	    buf[n++] = ((s[0] & 0x0f) << 12) | ((s[1] & 0x3f) << 6) |
+		       (s[2] & 0x3f);
+	    s += 3;
+	}
+    }
+
+    return n;
+}
+
+/* UTF-8 스트링을 UCS4로 바꾸어 조합한 다음 다시 UTF-8로 바꾸는 것과
+ * hangul_jamos_to_syllables_utf8()로 바로 조합하는 것을 비교한다. */
+static void
+benchmark_jamos_to_syllables_utf8(int n)
+{
+    ucschar* jamos;
+    ucschar* syllables;
+    char* src;
+    char* dest;
+    clock_t start;
+    double t1, t2;
+    int len, srclen, i, m1 = 0, m2 = 0;
+
+    jamos = malloc(sizeof(ucschar) * n);
+    syllables = malloc(sizeof(ucschar) * n);
+    src = malloc(n * 3);
+    dest = malloc(n * 3);
+    if (jamos == NULL || syllables == NULL || src == NULL || dest == NULL)
+	goto out;
+
+    srand(0);
+    len = make_jamo_corpus(jamos, n, false);
+    srclen = utf8_encode(src, jamos, len);
+
+    start = clock();
+    for (i = 0; i < 10; i++) {
+	len = utf8_decode(jamos, src, srclen);
+	len = hangul_jamos_to_syllables(syllables, n, jamos, len);
+	m1 = utf8_encode(dest, syllables, len);
+    }
+    t1 = get_elapsed(start) / 10;
+
+    start = clock();
+    for (i = 0; i < 10; i++) {
+	m2 = hangul_jamos_to_syllables_utf8(dest, n * 3, src, srclen);
+    }
+    t2 = get_elapsed(start) / 10;
+
+    printf("compose utf8 %8.2f MB/s -> %8.2f MB/s, %d -> %d, %d\n",
+	    srclen / t1 / 1e6, srclen / t2 / 1e6, srclen, m1, m2);
+
+out:
+    free(jamos);
+    free(syllables);
+    free(src);
+    free(dest);
+}
+
+static int
+compare_string(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+#define CHOSEONG_QUERIES 100
+#define FUZZY_QUERIES 20
+
+/* 초성 검색어에 매치되는 낱말을 찾는다. 낱말마다 음절을
+ * hangul_syllable_to_jamo()로 분해하여 비교하는 것과
+ * hanja_table_match_choseong()으로 찾는 것을 비교한다. */
+static void
+benchmark_choseong_index(int n)
+{
+    const char* path = "benchmark-choseong.txt";
+    SortWord* words;
+    char** lines;
+    ucschar queries[CHOSEONG_QUERIES][2];
+    HanjaTable* table = NULL;
+    FILE* file;
+    clock_t start;
+    HanjaList* list;
+    double t0, t1, t2, t3;
+    int nwords = n / 5;
+    int i, j, k, m1 = 0, m2 = 0;
+
+    words = malloc(sizeof(SortWord) * nwords);
+    lines = calloc(nwords, sizeof(char*));
+    if (words == NULL || lines == NULL)
+	goto out;
+
+    srand(0);
+    for (i = 0; i < nwords; i++) {
+	words[i].len = rand() % SORT_WORD_MAX + 1;
+	for (j = 0; j < words[i].len; j++)
+	    words[i].str[j] = 0xac00 + rand() % 11172;
+	lines[i] = malloc(SORT_WORD_MAX * 3 + 1);
+	if (lines[i] == NULL)
+	    goto out;
+	lines[i][utf8_encode(lines[i], words[i].str, words[i].len)] = '\0';
+    }
+    qsort(lines, nwords, sizeof(char*), compare_string);
+
+    file = fopen(path, "w");
+    if (file == NULL)
+	goto out;
+    for (i = 0; i < nwords; i++)
+	fprintf(file, "%s:%s:\n", lines[i], lines[i]);
+    fclose(file);
+
+    for (i = 0; i < CHOSEONG_QUERIES; i++) {
+	queries[i][0] = 0x1100 + rand() % 19;
+	queries[i][1] = 0x1100 + rand() % 19;
+    }
+
+    start = clock();
+    table = hanja_table_load(path);
+    t0 = get_elapsed(start);
+
+    /* 초성 인덱스는 처음 검색할 때 만든다 */
+    start = clock();
+    list = hanja_table_match_choseong(table, "ㄱ");
+    t3 = get_elapsed(start);
+    hanja_list_delete(list);
+    remove(path);
+
+    start = clock();
+    for (i = 0; i < CHOSEONG_QUERIES; i++) {
+	for (j = 0; j < nwords; j++) {
+	    for (k = 0; k < 2 && k < words[j].len; k++) {
+		ucschar cho, jung, jong;
+		hangul_syllable_to_jamo(words[j].str[k], &cho, &jung, &jong);
+		if (cho != queries[i][k])
+		    break;
+	    }
+	    if (k == 2)
+		m1++;
+	}
+    }
+    t1 = get_elapsed(start) / CHOSEONG_QUERIES;
+
+    start = clock();
+    for (i = 0; i < CHOSEONG_QUERIES; i++) {
+	char key[8];
+	key[utf8_encode(key, queries[i], 2)] = '\0';
+	list = hanja_table_match_choseong(table, key);
+	m2 += hanja_list_get_size(list);
+	hanja_list_delete(list);
+    }
+    t2 = get_elapsed(start) / CHOSEONG_QUERIES;
+
+    printf("choseong %d words %8.2f us   -> %8.2f us, %d, %d (load %.2f ms, index %.2f ms)\n",
+	    nwords, t1 * 1e6, t2 * 1e6, m1, m2, t0 * 1e3, t3 * 1e3);
+
+out:
+    hanja_table_delete(table);
+    if (lines != NULL) {
+	for (i = 0; i < nwords; i++)
+	    free(lines[i]);
+    }
+    free(lines);
+    free(words);
+}
+
+/* 낱말마다 음절을 hangul_syllable_to_jamo()로 분해하여 편집 거리를 계산하는
+ * 것과 hanja_table_match_fuzzy()로 찾는 것을 비교한다. 검색어는 사전의
+ * 낱말에서 모음 하나를 바꾼 것이다. */
+static void
+benchmark_fuzzy_match(int n)
+{
+    const char* path = "benchmark-fuzzy.txt";
+    SortWord* words;
+    char** lines;
+    SortWord queries[FUZZY_QUERIES];
+    HanjaTable* table = NULL;
+    FILE* file;
+    clock_t start;
+    double t1, t2;
+    int nwords = n / 5;
+    int i, j, k, m1 = 0, m2 = 0;
+
+    words = malloc(sizeof(SortWord) * nwords);
+    lines = calloc(nwords, sizeof(char*));
+    if (words == NULL || lines == NULL)
+	goto out;
+
+    srand(0);
+    for (i = 0; i < nwords; i++) {
+	words[i].len = rand() % SORT_WORD_MAX + 1;
+	for (j = 0; j < words[i].len; j++)
+	    words[i].str[j] = 0xac00 + rand() % 11172;
+	lines[i] = malloc(SORT_WORD_MAX * 3 + 1);
+	if (lines[i] == NULL)
+	    goto out;
+	lines[i][utf8_encode(lines[i], words[i].str, words[i].len)] = '\0';
+    }
+
+    for (i = 0; i < FUZZY_QUERIES; i++) {
+	queries[i] = words[rand() % nwords];
+	k = rand() % queries[i].len;
+	queries[i].str[k] = 0xac00 + ((queries[i].str[k] - 0xac00) + 28) % 11172;
+    }
+
+    qsort(lines, nwords, sizeof(char*), compare_string);
+    file = fopen(path, "w");
+    if (file == NULL)
+	goto out;
+    for (i = 0; i < nwords; i++)
+	fprintf(file, "%s:%s:\n", lines[i], lines[i]);
+    fclose(file);
+
+    table = hanja_table_load(path);
+    /* 키 목록을 미리 만들어 둔다 */
+    hanja_list_delete(hanja_table_match_fuzzy(table, "ㄱ", 0));
+    remove(path);
+
+    start = clock();
+    for (i = 0; i < FUZZY_QUERIES; i++) {
+	ucschar q[SORT_WORD_MAX * 3];
+	int qlen = hangul_syllables_to_jamos(q, countof(q),
+					     queries[i].str, queries[i].len);
+
+	for (j = 0; j < nwords; j++) {
+	    ucschar w[SORT_WORD_MAX * 3];
+	    int row[SORT_WORD_MAX * 3 + 1];
+	    int wlen = 0;
+	    int x, y;
+
+	    for (k = 0; k < words[j].len; k++) {
+		ucschar cho, jung, jong;
+		hangul_syllable_to_jamo(words[j].str[k], &cho, &jung, &jong);
+		w[wlen++] = cho;
+		w[wlen++] = jung;
+		if (jong != 0)
+		    w[wlen++] = jong;
+	    }
+
+	    for (y = 0; y <= wlen; y++)
+		row[y] = y;
+	    for (x = 1; x <= qlen; x++) {
+		int diag = row[0];
+		row[0] = x;
+		for (y = 1; y <= wlen; y++) {
+		    int up = row[y];
+		    int v = diag + (q[x - 1] != w[y - 1]);
+		    if (up + 1 < v)
+			v = up + 1;
+		    if (row[y - 1] + 1 < v)
+			v = row[y - 1] + 1;
+		    row[y] = v;
+		    diag = up;
+		}
+	    }
+	    if (row[wlen] <= 1)
+		m1++;
+	}
+    }
+    t1 = get_elapsed(start) / FUZZY_QUERIES;
+
+    start = clock();
+    for (i = 0; i < FUZZY_QUERIES; i++) {
+	char key[SORT_WORD_MAX * 3 + 1];
+	HanjaList* list;
+	key[utf8_encode(key, queries[i].str, queries[i].len)] = '\0';
+	list = hanja_table_match_fuzzy(table, key, 1);
+	m2 += hanja_list_get_size(list);
+	hanja_list_delete(list);
+    }
+    t2 = get_elapsed(start) / FUZZY_QUERIES;
+
+    printf("fuzzy %d words %11.2f us   -> %8.2f us, %d, %d\n",
+	    nwords, t1 * 1e6, t2 * 1e6, m1, m2);
+
+out:
+    hanja_table_delete(table);
+    if (lines != NULL) {
+	for (i = 0; i < nwords; i++)
+	    free(lines[i]);
+    }
+    free(lines);
+    free(words);
+}
+
+/* 음절마다 hangul_syllable_to_jamo()를 부르는 것과
+ * hangul_syllables_to_jamos()로 한번에 분해하는 것을 비교한다. */
+static void
+benchmark_syllables_to_jamos(int n)
+{
+    ucschar* syllables;
+    ucschar* jamos;
+    clock_t start;
+    double t1, t2;
+    int i, j, m = 0;
+
+    syllables = malloc(sizeof(ucschar) * n);
+    jamos = malloc(sizeof(ucschar) * n * 3);
+    if (syllables == NULL || jamos == NULL) {
+	free(syllables);
+	free(jamos);
+	return;
+    }
+
+    srand(0);
+    for (i = 0; i < n; i++) {
+	if (rand() % 6 == 0)
+	    syllables[i] = ' ';
+	else
+	    syllables[i] = 0xac00 + rand() % 11172;
+    }
+
+    start = clock();
+    for (i = 0; i < 10; i++) {
+	m = 0;
+	for (j = 0; j < n; j++) {
+	    ucschar cho, jung, jong;
+	    if (!hangul_is_syllable(syllables[j])) {
+		jamos[m++] = syllables[j];
+		continue;
+	    }
+	    hangul_syllable_to_jamo(syllables[j], &cho, &jung, &jong);
+	    jamos[m++] = cho;
+	    jamos[m++] = jung;
+	    if (jong != 0)
+		jamos[m++] = jong;
+	}
+    }
+    t1 = get_elapsed(start) / 10;
+
+    start = clock();
+    for (i = 0; i < 10; i++) {
+	m = hangul_syllables_to_jamos(jamos, n * 3, syllables, n);
+    }
+    t2 = get_elapsed(start) / 10;
+
+    printf("decompose %8.2f MB/s -> %8.2f MB/s, %d -> %d\n",
+	    n * sizeof(ucschar) / t1 / 1e6,
+	    n * sizeof(ucschar) / t2 / 1e6, n, m);
+
+    free(syllables);
+    free(jamos);
+}
+
+/* 키마다 hangul_keyboard_map_to_char()를 부르는 것과
+ * hangul_keyboard_map_keys()로 한번에 변환하는 것을 비교한다. */
+static void
+benchmark_map(const char* id, const char* keys, int n)
+{
+    const HangulKeyboard* keyboard;
+    ucschar* buf;
+    unsigned long sum1 = 0, sum2 = 0;
+    clock_t start;
+    double t1, t2;
+    int i;
+
+    keyboard = hangul_keyboard_list_get_keyboard(id);
+    buf = malloc(sizeof(ucschar) * n);
+    if (keyboard == NULL || buf == NULL) {
+	free(buf);
+	return;
+    }
+
+    start = clock();
+    for (i = 0; i < n; i++) {
+	ucschar c = hangul_keyboard_map_to_char(keyboard, 0,
+						(unsigned char)keys[i]);
+	buf[i] = c != 0 ? c : (unsigned char)keys[i];
+    }
+    t1 = get_elapsed(start);
+    for (i = 0; i < n; i++)
+	sum1 += buf[i];
+
+    start = clock();
+    hangul_keyboard_map_keys(keyboard, 0, buf, n, keys, n);
+    t2 = get_elapsed(start);
+    for (i = 0; i < n; i++)
+	sum2 += buf[i];
+
+    printf("map     %-4s per key %8.2f Mkeys/s, bulk      %8.2f Mkeys/s%s\n",
+	    id, n / t1 / 1e6, n / t2 / 1e6,
+	    sum1 == sum2 ? "" : " (MISMATCH)");
+
+    free(buf);
+}
+
+/* 자판의 조합 테이블을 이전처럼 bsearch로 찾는 것과
+ * hangul_keyboard_combine()으로 찾는 것을 비교한다. */
+static void
+benchmark_combine(const char* id, int n)
+{
+    const HangulKeyboard* keyboard;
+    CombinationItem* items;
+    CombinationItem* queries;
+    ucschar jamos[0x100 + 0x20 + 0x50];
+    int njamos, nitems;
+    unsigned long sum1 = 0, sum2 = 0;
+    clock_t start;
+    double t1, t2;
+    int i, j;
+
+    keyboard = hangul_keyboard_list_get_keyboard(id);
+    if (keyboard == NULL)
+	return;
+
+    njamos = append_jamos(jamos, 0, 0x1100, 0x1200);
+    njamos = append_jamos(jamos, njamos, 0xa960, 0xa980);
+    njamos = append_jamos(jamos, njamos, 0xd7b0, 0xd800);
+
+    /* 모든 자모 쌍을 넣어 보아서 조합 테이블을 얻는다 */
+    items = malloc(sizeof(CombinationItem) * njamos * njamos);
+    queries = malloc(sizeof(CombinationItem) * n);
+    if (items == NULL || queries == NULL) {
+	free(items);
+	free(queries);
+	return;
+    }
+
+    nitems = 0;
+    for (i = 0; i < njamos; i++) {
+	for (j = 0; j < njamos; j++) {
+	    ucschar c = hangul_keyboard_combine(keyboard, 0, jamos[i], jamos[j]);
+	    if (c != 0) {
+		items[nitems].key = jamos[i] << 16 | jamos[j];
+		items[nitems].code = c;
+		nitems++;
+	    }
+	}
+    }
+    qsort(items, nitems, sizeof(items[0]), combination_item_cmp);
+
+    /* 절반은 테이블에 있는 쌍, 절반은 임의의 자모 쌍 */
+    srand(0);
+    for (i = 0; i < n; i++) {
+	if (nitems > 0 && rand() % 2 == 0)
+	    queries[i].key = items[rand() % nitems].key;
+	else
+	    queries[i].key = jamos[rand() % njamos] << 16 | jamos[rand() % njamos];
+    }
+
+    start = clock();
+    for (i = 0; i < n; i++) {
+	CombinationItem* res = bsearch(&queries[i], items, nitems,
+				       sizeof(items[0]), combination_item_cmp);
+	if (res != NULL)
+	    sum1 += res->code;
+    }
+    t1 = get_elapsed(start);
+
+    start = clock();
+    for (i = 0; i < n; i++) {
+	sum2 += hangul_keyboard_combine(keyboard, 0,
+		    queries[i].key >> 16, queries[i].key & 0xffff);
+    }
+    t2 = get_elapsed(start);
+
+    printf("combine %-4s %4d items: bsearch %8.2f Mlookups/s, hash %8.2f Mlookups/s%s\n",
+	    id, nitems, n / t1 / 1e6, n / t2 / 1e6,
+	    sum1 == sum2 ? "" : " (MISMATCH)");
+
+    free(items);
+    free(queries);
+}
+
+#if ENABLE_EXTERNAL_KEYBOARDS
+/* 쓰레드를 여러개 사용하는 경우는 clock()이 모든 쓰레드의 시간을
+ * 더하므로 실제로 흐른 시간을 잰다 */
+static double
+get_wall_time()
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 두벌식과 비슷한 크기의 자판 파일을 만든다 */
+static bool
+write_keyboard_file(const char* path, int index_)
+{
+    FILE* file;
+    int i;
+
+    file = fopen(path, "w");
+    if (file == NULL)
+	return false;
+
+    fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(file, "<hangul-keyboard id=\"bench%03d\" type=\"jamo\">\n", index_);
+    fprintf(file, "    <name>Benchmark %d</name>\n", index_);
+    fprintf(file, "    <name xml:lang=\"ko\">벤치마크 %d</name>\n", index_);
+    fprintf(file, "    <map id=\"0\">\n");
+    for (i = 0x21; i < 0x7f; i++) {
+	fprintf(file, "        <item key=\"0x%02x\" value=\"0x%04x\"/>\n",
+		i, 0x1100 + (i + index_) % 0x13);
+    }
+    fprintf(file, "    </map>\n");
+    fprintf(file, "    <combination id=\"0\">\n");
+    for (i = 0; i < 0x40; i++) {
+	fprintf(file, "        <item key=\"0x%04x%04x\" value=\"0x%04x\"/>\n",
+		0x1100 + i % 0x13, 0x1161 + i % 0x15, 0xac00 + i);
+    }
+    fprintf(file, "    </combination>\n");
+    fprintf(file, "</hangul-keyboard>\n");
+
+    fclose(file);
+    return true;
+}
+
+/* 자판 파일이 많은 디렉토리를 만들어 두고, 읽는 쓰레드 수에 따라
+ * hangul_init의 시간이 어떻게 달라지는지 본다. */
+static void
+benchmark_init(int n)
+{
+    static const unsigned threads[] = { 1, 2, 4, 8 };
+    const char* dir = "benchmark-keyboards";
+    char path[256];
+    double start, t1, t2;
+    unsigned count;
+    int i, j;
+
+    mkdir(dir, 0755);
+    for (i = 0; i < n; i++) {
+	snprintf(path, sizeof(path), "%s/keyboard-%03d.xml", dir, i);
+	if (!write_keyboard_file(path, i))
+	    goto done;
+    }
+
+    for (i = 0; i < countof(threads); i++) {
+	start = get_wall_time();
+	hangul_init_with_threads(dir, threads[i]);
+	t1 = get_wall_time() - start;
+	count = hangul_keyboard_list_get_count();
+
+	/* 자판은 처음 선택할 때 모두 읽는다 */
+	start = get_wall_time();
+	for (j = 0; j < count; j++) {
+	    const char* id = hangul_keyboard_list_get_keyboard_id(j);
+	    hangul_keyboard_list_get_keyboard(id);
+	}
+	t2 = get_wall_time() - start;
+	hangul_fini();
+
+	printf("init    %d keyboards %u threads: init %8.2f ms, select all %8.2f ms\n",
+		count, threads[i], t1 * 1e3, t2 * 1e3);
+    }
+
+done:
+    for (i = 0; i < n; i++) {
+	snprintf(path, sizeof(path), "%s/keyboard-%03d.xml", dir, i);
+	remove(path);
+    }
+    rmdir(dir);
+}
+#endif // ENABLE_EXTERNAL_KEYBOARDS
+
+int
+main(int argc, char *argv[])
+{
+    static const char* keyboards[] = { "2", "3f", "3s", "39", "3y", "32" };
+    static const char* combinations[] = { "2", "2y", "ro", "ahn" };
+    static const char letters[] =
+	"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    int n = 1000000;
+    char* keys;
+    int i;
+
+    if (argc > 1) {
+	n = atoi(argv[1]);
+	if (n <= 0)
+	    n = 1000000;
+    }
+
+#if ENABLE_EXTERNAL_KEYBOARDS
+    benchmark_init(300);
+    hangul_init(TEST_LIBHANGUL_KEYBOARD_PATH);
+#endif // ENABLE_EXTERNAL_KEYBOARDS
+
+    keys = malloc(n);
+    if (keys == NULL)
+	return -1;
+
+    srand(0);
+    for (i = 0; i < n; i++) {
+	if (rand() % 6 == 0)
+	    keys[i] = ' ';
+	else
+	    keys[i] = letters[rand() % (countof(letters) - 1)];
+    }
+
+    for (i = 0; i < countof(keyboards); i++) {
+	benchmark_process(keyboards[i], keys, n);
+    }
+    benchmark_romaja(keys, n);
+
+    benchmark_jamos_to_syllables("modern", false, n);
+    benchmark_jamos_to_syllables("old", true, n);
+    benchmark_jamos_to_syllables_utf8(n);
+    benchmark_composer(n);
+    benchmark_sort_key(n);
+    benchmark_choseong_index(n);
+    benchmark_fuzzy_match(n);
+    benchmark_syllables_to_jamos(n);
+    benchmark_syllable_iterator("jamo", false, n);
+    benchmark_syllable_iterator("text", true, n);
+
+    benchmark_map("2", keys, n);
+    benchmark_map("3f", keys, n);
+
+    for (i = 0; i < countof(combinations); i++) {
+	benchmark_combine(combinations[i], n);
+    }
+
+    free(keys);
+
+#if ENABLE_EXTERNAL_KEYBOARDS
+    hangul_fini();
+#endif // ENABLE_EXTERNAL_KEYBOARDS
+
+    return 0;
+}
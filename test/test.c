@@ -1,13 +1,17 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <wchar.h>
+#include <sys/stat.h>
 #include <check.h>
 
 #include "../hangul/hangul.h"
 
 #define countof(x)  ((sizeof(x)) / (sizeof(x[0])))
 
+#include "../hangul/hangulinternals.h"
+
 static HangulInputContext* global_ic = NULL;
 
 /* ic option을 바꾸면서 테스트하는걸 손쉽게 하기 위해서
@@ -416,6 +420,399 @@ START_TEST(test_hangul_ic_non_choseong_combi)
 END_TEST
 }
 
+static bool
+check_same_output(HangulInputContext* ic1, HangulInputContext* ic2)
+{
+    const ucschar* s1;
+    const ucschar* s2;
+
+    s1 = hangul_ic_get_preedit_string(ic1);
+    s2 = hangul_ic_get_preedit_string(ic2);
+    if (wcscmp((const wchar_t*)s1, (const wchar_t*)s2) != 0)
+	return false;
+
+    s1 = hangul_ic_get_commit_string(ic1);
+    s2 = hangul_ic_get_commit_string(ic2);
+    if (wcscmp((const wchar_t*)s1, (const wchar_t*)s2) != 0)
+	return false;
+
+    return true;
+}
+
+/* 조합 오토마타로 처리한 결과가 조합 함수로 처리한 결과와 같은지
+ * 임의의 키 입력으로 확인한다. */
+START_TEST(test_hangul_ic_compile)
+{
+    static const char keys[] = "qwertasdfgzxcvQWERThjklyuiopbnmOP1 .\b";
+    HangulInputContext* ic;
+    HangulInputContext* compiled;
+    int mode;
+    int options;
+    int i;
+
+    for (mode = HANGUL_OUTPUT_SYLLABLE; mode <= HANGUL_OUTPUT_JAMO; mode++) {
+	for (options = 0; options < 8; options++) {
+	    ic = hangul_ic_new("2");
+	    compiled = hangul_ic_new("2");
+
+	    hangul_ic_set_output_mode(ic, mode);
+	    hangul_ic_set_option(ic, HANGUL_IC_OPTION_AUTO_REORDER, options & 1);
+	    hangul_ic_set_option(ic, HANGUL_IC_OPTION_COMBI_ON_DOUBLE_STROKE, options & 2);
+	    hangul_ic_set_option(ic, HANGUL_IC_OPTION_NON_CHOSEONG_COMBI, options & 4);
+	    hangul_ic_set_output_mode(compiled, mode);
+	    hangul_ic_set_option(compiled, HANGUL_IC_OPTION_AUTO_REORDER, options & 1);
+	    hangul_ic_set_option(compiled, HANGUL_IC_OPTION_COMBI_ON_DOUBLE_STROKE, options & 2);
+	    hangul_ic_set_option(compiled, HANGUL_IC_OPTION_NON_CHOSEONG_COMBI, options & 4);
+	    ck_assert(hangul_ic_compile(compiled));
+
+	    srand(mode * 8 + options);
+	    for (i = 0; i < 20000; i++) {
+		int ascii;
+		if (rand() % 16 == 0)
+		    ascii = rand() % 128;
+		else
+		    ascii = keys[rand() % (countof(keys) - 1)];
+
+		ck_assert(hangul_ic_process(ic, ascii) ==
+			  hangul_ic_process(compiled, ascii));
+		ck_assert(check_same_output(ic, compiled));
+
+		if (rand() % 128 == 0) {
+		    ck_assert(wcscmp((const wchar_t*)hangul_ic_flush(ic),
+				     (const wchar_t*)hangul_ic_flush(compiled)) == 0);
+		}
+
+		/* 옵션이 바뀌면 오토마타를 사용하지 않아야 한다 */
+		if (i == 10000) {
+		    hangul_ic_set_option(ic, HANGUL_IC_OPTION_AUTO_REORDER, !(options & 1));
+		    hangul_ic_set_option(compiled, HANGUL_IC_OPTION_AUTO_REORDER, !(options & 1));
+		}
+	    }
+
+	    hangul_ic_delete(ic);
+	    hangul_ic_delete(compiled);
+	}
+    }
+
+    compiled = hangul_ic_new("ro");
+    ck_assert(!hangul_ic_compile(compiled));
+    hangul_ic_delete(compiled);
+}
+END_TEST
+
+static void
+on_translate_nothing(HangulInputContext* ic, int ascii, ucschar* ch, void* data)
+{
+}
+
+/* translate 콜백이 연결되어 있으면 조합 오토마타를 사용하지 않으므로
+ * 조합 함수로만 키를 처리하는 ic를 만들 수 있다. */
+static HangulInputContext*
+new_reference_ic(const char* keyboard)
+{
+    HangulInputContext* ic = hangul_ic_new(keyboard);
+    hangul_ic_connect_callback(ic, "translate", on_translate_nothing, NULL);
+    return ic;
+}
+
+static void
+set_ic_config(HangulInputContext* ic, int options, int mode)
+{
+    hangul_ic_set_output_mode(ic, mode);
+    hangul_ic_set_option(ic, HANGUL_IC_OPTION_AUTO_REORDER, options & 1);
+    hangul_ic_set_option(ic, HANGUL_IC_OPTION_COMBI_ON_DOUBLE_STROKE, options & 2);
+    hangul_ic_set_option(ic, HANGUL_IC_OPTION_NON_CHOSEONG_COMBI, options & 4);
+}
+
+/* 세벌식 자판은 hangul_ic_process()가 옵션마다 오토마타를 골라 사용한다.
+ * 이 파일의 키 입력과 임의의 키 입력에 대해 조합 함수로 처리한 결과와
+ * 같은지 확인한다. */
+START_TEST(test_hangul_ic_automaton_jaso)
+{
+    static const char* keyboards[] = { "3f", "3s", "39", "3y", "32" };
+    static const char* sequences[] = {
+	"m", "v", "W", "kfa", "yr", "hz", "tq", "mrqq", "kf", "fk",
+	"rkW", "qjTm", "akfrh", "rtk", "rkT\b", "rt\bk", "akfr\b", "dnp\b",
+	"qqnpfr\b\b\b\b\b\b", "Qnpfr\b\b\b\b\b", "rrkrrk", "qjttm", "rktt\b",
+	"g", "h", "x", "qd", "Z", "V", "sg", "rkd", "fo", "gKs", "QdhaT",
+	"Qdhatty", "QdhaTy", "rkDDk", "qqdhatty", "qqdhaTy", "ddkdd", "kkkk",
+    };
+    HangulInputContext* ic;
+    HangulInputContext* compiled;
+    const char* p;
+    int k, mode, options;
+    int i;
+
+    for (k = 0; k < countof(keyboards); k++) {
+	for (mode = HANGUL_OUTPUT_SYLLABLE; mode <= HANGUL_OUTPUT_JAMO; mode++) {
+	    for (options = 0; options < 8; options++) {
+		ic = new_reference_ic(keyboards[k]);
+		compiled = hangul_ic_new(keyboards[k]);
+		set_ic_config(ic, options, mode);
+		set_ic_config(compiled, options, mode);
+		ck_assert(hangul_ic_compile(compiled));
+
+		for (i = 0; i < countof(sequences); i++) {
+		    hangul_ic_reset(ic);
+		    hangul_ic_reset(compiled);
+		    for (p = sequences[i]; *p != '\0'; p++) {
+			ck_assert(hangul_ic_process(ic, *p) ==
+				  hangul_ic_process(compiled, *p));
+			ck_assert(check_same_output(ic, compiled));
+		    }
+		    ck_assert(wcscmp((const wchar_t*)hangul_ic_flush(ic),
+				     (const wchar_t*)hangul_ic_flush(compiled)) == 0);
+		}
+
+		srand(k * 16 + mode * 8 + options);
+		for (i = 0; i < 20000; i++) {
+		    int ascii;
+		    if (rand() % 16 == 0)
+			ascii = rand() % 128;
+		    else
+			ascii = ' ' + rand() % 95;
+
+		    ck_assert(hangul_ic_process(ic, ascii) ==
+			      hangul_ic_process(compiled, ascii));
+		    ck_assert(check_same_output(ic, compiled));
+		}
+
+		hangul_ic_delete(ic);
+		hangul_ic_delete(compiled);
+	    }
+	}
+    }
+}
+END_TEST
+
+/* 로마자 자판 ic에 키를 하나씩 넣어서 얻은 스트링.
+ * hangul_romaja_to_syllables()는 '\b'를 backspace로 처리하지 않고 다른 제어
+ * 문자와 같이 그대로 복사하므로, 여기서도 ic를 flush하고 그대로 넣는다. */
+static int
+romaja_by_ic(HangulInputContext* ic, const char* src, ucschar* buf, int buflen)
+{
+    const ucschar* s;
+    int n = 0;
+
+    hangul_ic_reset(ic);
+    for (; *src != '\0'; src++) {
+	bool ret;
+
+	if (*src == '\b') {
+	    for (s = hangul_ic_flush(ic); *s != 0 && n < buflen; s++)
+		buf[n++] = *s;
+	    if (n < buflen)
+		buf[n++] = *src;
+	    continue;
+	}
+
+	ret = hangul_ic_process(ic, *src);
+	for (s = hangul_ic_get_commit_string(ic); *s != 0 && n < buflen; s++)
+	    buf[n++] = *s;
+	if (!ret && n < buflen)
+	    buf[n++] = *src;
+    }
+    for (s = hangul_ic_flush(ic); *s != 0 && n < buflen; s++)
+	buf[n++] = *s;
+
+    return n;
+}
+
+START_TEST(test_hangul_romaja_to_syllables)
+{
+    static const char* sequences[] = {
+	"han", "a", "tt", "gang", "gangi", "nanG", "xx", "xy", "sexy",
+	"hangugeo", "annyeonghaseyo", "seoul", "jjigae", "chhima", "dalgi",
+	"ilgeo", "ggakdugi", "waegeurae", "uiuie", "Seoul 2024, Busan!",
+	"eopseoyo", "bbang", "kkx", "aX", "gA", "ngng", "x",
+	"hhhhhhhhhhhhhhhhhhhhhhhha", "chhhhhhhhhhhhhhhhhhhhhhhhhng",
+	"han\bgu", "\bga\b\bn",
+    };
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzaeiouyw";
+    HangulInputContext* ic;
+    ucschar expected[256];
+    ucschar buf[256];
+    char src[128];
+    int i, j, n;
+
+    ic = hangul_ic_new("ro");
+
+    for (i = 0; i < countof(sequences); i++) {
+	n = romaja_by_ic(ic, sequences[i], expected, countof(expected));
+	ck_assert(hangul_romaja_to_syllables(buf, countof(buf),
+					     sequences[i], -1) == n);
+	ck_assert(memcmp(buf, expected, n * sizeof(ucschar)) == 0);
+	ck_assert(hangul_romaja_to_syllables(NULL, 0, sequences[i], -1) == n);
+    }
+
+    n = hangul_romaja_to_syllables(buf, countof(buf), "seoul", -1);
+    ck_assert(n == 2 && buf[0] == L'서' && buf[1] == L'울');
+    n = hangul_romaja_to_syllables(buf, 1, "seoul", -1);
+    ck_assert(n == 1 && buf[0] == L'서');
+    n = hangul_romaja_to_syllables(buf, countof(buf), "han\bgu", -1);
+    ck_assert(n == 3 && buf[0] == L'한' && buf[1] == '\b' && buf[2] == L'구');
+
+    srand(0);
+    for (i = 0; i < 2000; i++) {
+	int len = rand() % (countof(src) - 1);
+	for (j = 0; j < len; j++) {
+	    int r = rand() % 32;
+	    if (r == 0)
+		src[j] = 1 + rand() % 127;
+	    else if (r < 4)
+		src[j] = 'A' + rand() % 26;
+	    else if (r < 6)
+		src[j] = ' ' + rand() % 32;
+	    else
+		src[j] = letters[rand() % (countof(letters) - 1)];
+	}
+	src[len] = '\0';
+
+	n = romaja_by_ic(ic, src, expected, countof(expected));
+	ck_assert(hangul_romaja_to_syllables(buf, countof(buf), src, len) == n);
+	ck_assert(memcmp(buf, expected, n * sizeof(ucschar)) == 0);
+	ck_assert(hangul_romaja_to_syllables(NULL, 0, src, len) == n);
+    }
+
+    hangul_ic_delete(ic);
+}
+END_TEST
+
+START_TEST(test_hangul_ic_pool)
+{
+    const HangulKeyboard* keyboard2 = hangul_keyboard_list_get_keyboard("2");
+    const HangulKeyboard* keyboard3 = hangul_keyboard_list_get_keyboard("3f");
+    HangulInputContext* ic;
+    HangulInputContext* ic2;
+
+    ic = hangul_ic_new_with_keyboard(keyboard2);
+    ck_assert(check_preedit_with_ic(ic, "rk", L"가"));
+    hangul_ic_delete(ic);
+
+    ic = hangul_ic_pool_acquire(keyboard2);
+    hangul_ic_set_option(ic, HANGUL_IC_OPTION_AUTO_REORDER, true);
+    hangul_ic_set_output_mode(ic, HANGUL_OUTPUT_JAMO);
+    hangul_ic_connect_callback(ic, "translate", on_translate_nothing, NULL);
+    ck_assert(check_preedit_with_ic(ic, "rk", L"\x1100\x1161"));
+    hangul_ic_pool_release(ic);
+
+    /* 반환된 ic는 초기 상태로 다시 사용된다 */
+    ic2 = hangul_ic_pool_acquire(keyboard2);
+    ck_assert(ic2 == ic);
+    ck_assert(hangul_ic_is_empty(ic2));
+    ck_assert(hangul_ic_get_preedit_string(ic2)[0] == 0);
+    ck_assert(!hangul_ic_get_option(ic2, HANGUL_IC_OPTION_AUTO_REORDER));
+    ck_assert(hangul_ic_get_option(ic2, HANGUL_IC_OPTION_NON_CHOSEONG_COMBI));
+    ck_assert(check_preedit_with_ic(ic2, "rk", L"가"));
+
+    /* 같은 자판을 쓰던 ic를 먼저 꺼낸다 */
+    ic = hangul_ic_pool_acquire(keyboard3);
+    hangul_ic_pool_release(ic2);
+    hangul_ic_pool_release(ic);
+    ck_assert(hangul_ic_pool_acquire(keyboard2) == ic2);
+    hangul_ic_pool_release(ic2);
+
+    /* 다른 자판으로 꺼내면 자판이 바뀐다 */
+    ic = hangul_ic_pool_acquire(hangul_keyboard_list_get_keyboard("3s"));
+    ck_assert(check_preedit_with_ic(ic, "mrqq", L"했"));
+    hangul_ic_pool_release(ic);
+
+    hangul_ic_pool_clear();
+}
+END_TEST
+
+typedef struct {
+    ucschar commit[4096];
+    int ncommit;
+    ucschar preedit[64];
+    int npreedit_changed;
+} CallbackLog;
+
+static void
+on_commit_log(HangulInputContext* ic, const ucschar* str, int len, void* data)
+{
+    CallbackLog* log = data;
+    int i;
+
+    for (i = 0; i < len && log->ncommit < countof(log->commit); i++)
+	log->commit[log->ncommit++] = str[i];
+}
+
+static void
+on_preedit_changed_log(HangulInputContext* ic, const ucschar* str, int len, void* data)
+{
+    CallbackLog* log = data;
+
+    ck_assert(len < countof(log->preedit));
+    memcpy(log->preedit, str, len * sizeof(ucschar));
+    log->preedit[len] = 0;
+    log->npreedit_changed++;
+}
+
+/* commit, preedit-changed 콜백으로 받은 결과가 매번 스트링을 확인한
+ * 결과와 같은지 확인한다. */
+START_TEST(test_hangul_ic_output_callbacks)
+{
+    static const char keys[] = "rkfrhdnpqQT \b.";
+    static CallbackLog log;
+    ucschar commit[4096];
+    ucschar preedit[64] = { 0, };
+    HangulInputContext* ic;
+    HangulInputContext* polled;
+    const ucschar* s;
+    int ncommit = 0;
+    int npreedit_changed = 0;
+    int i;
+
+    memset(&log, 0, sizeof(log));
+
+    ic = hangul_ic_new("2");
+    polled = hangul_ic_new("2");
+    hangul_ic_connect_callback(ic, "commit", on_commit_log, &log);
+    hangul_ic_connect_callback(ic, "preedit-changed", on_preedit_changed_log, &log);
+
+    /* 바뀐 내용이 없으면 콜백이 불리지 않는다 */
+    hangul_ic_process(ic, ' ');
+    hangul_ic_process(polled, ' ');
+    ck_assert(log.ncommit == 0 && log.npreedit_changed == 0);
+
+    srand(0);
+    for (i = 0; i < 4000; i++) {
+	int ascii = keys[rand() % (countof(keys) - 1)];
+
+	hangul_ic_process(ic, ascii);
+	hangul_ic_process(polled, ascii);
+
+	for (s = hangul_ic_get_commit_string(polled); *s != 0; s++) {
+	    if (ncommit < countof(commit))
+		commit[ncommit++] = *s;
+	}
+
+	s = hangul_ic_get_preedit_string(polled);
+	if (wcscmp((const wchar_t*)s, (const wchar_t*)preedit) != 0) {
+	    wcscpy((wchar_t*)preedit, (const wchar_t*)s);
+	    npreedit_changed++;
+	}
+
+	ck_assert(npreedit_changed == log.npreedit_changed);
+	ck_assert(wcscmp((const wchar_t*)log.preedit, (const wchar_t*)preedit) == 0);
+    }
+
+    ck_assert(ncommit == log.ncommit);
+    ck_assert(memcmp(commit, log.commit, ncommit * sizeof(ucschar)) == 0);
+
+    /* flush는 preedit만 비운다 */
+    ncommit = log.ncommit;
+    hangul_ic_process(ic, 'r');
+    hangul_ic_flush(ic);
+    ck_assert(log.ncommit == ncommit);
+    ck_assert(log.preedit[0] == 0);
+
+    hangul_ic_delete(ic);
+    hangul_ic_delete(polled);
+}
+END_TEST
+
 START_TEST(test_syllable_iterator)
 {
     ucschar str[] = {
@@ -574,11 +971,896 @@ START_TEST(test_hangul_keyboard)
         hangul_keyboard_list_unregister_keyboard(id) == keyboard
     );
 
+    /* 같은 id의 자판은 마지막에 등록된 것이 선택되고,
+     * 그 자판을 빼면 먼저 등록된 자판이 다시 선택된다. */
+    HangulKeyboard* keyboard2;
+    ck_assert(
+        (keyboard2 = hangul_keyboard_new_from_file(TEST_SOURCE_DIR "/recursive.xml")) != NULL
+    );
+    ck_assert(hangul_keyboard_list_register_keyboard(keyboard) != NULL);
+    ck_assert(hangul_keyboard_list_register_keyboard(keyboard2) != NULL);
+    ck_assert(hangul_keyboard_list_get_keyboard("recursive") == keyboard2);
+    ck_assert(hangul_keyboard_list_get_keyboard("2") != NULL);
+    ck_assert(hangul_keyboard_list_unregister_keyboard("recursive") == keyboard2);
+    ck_assert(hangul_keyboard_list_get_keyboard("recursive") == keyboard);
+    ck_assert(hangul_keyboard_list_unregister_keyboard("recursive") == keyboard);
+    ck_assert(hangul_keyboard_list_get_keyboard("recursive") == NULL);
+    ck_assert(hangul_keyboard_list_unregister_keyboard("recursive") == NULL);
+    ck_assert(hangul_keyboard_list_get_count() == n);
+
+    hangul_keyboard_delete(keyboard2);
+    hangul_keyboard_delete(keyboard);
+}
+END_TEST
+
+START_TEST(test_hangul_keyboard_bundle)
+{
+    const char* path = "hangul-keyboards-test.bin";
+
+    /* test 디렉토리에는 recursive.xml 자판 하나만 있다. */
+    ck_assert(hangul_keyboard_bundle_compile(TEST_SOURCE_DIR, path) == 1);
+
+    FILE* file = fopen(path, "rb");
+    ck_assert(file != NULL);
+    fclose(file);
+    remove(path);
+
+    ck_assert(hangul_keyboard_bundle_compile(TEST_SOURCE_DIR,
+		TEST_SOURCE_DIR "/no-such-dir/hangul-keyboards.bin") < 0);
+}
+END_TEST
+
+static bool
+copy_file(const char* from, const char* to)
+{
+    char buf[4096];
+    size_t n;
+    FILE* in = fopen(from, "rb");
+    FILE* out = fopen(to, "wb");
+    bool ret = in != NULL && out != NULL;
+
+    while (ret && (n = fread(buf, 1, sizeof(buf), in)) > 0)
+	ret = fwrite(buf, 1, n, out) == n;
+
+    if (in != NULL)
+	fclose(in);
+    if (out != NULL && fclose(out) != 0)
+	ret = false;
+    return ret;
+}
+
+/* 번들에서 읽은 자판은 읽기 전용 메모리를 가리키므로, 목록에서 빼면
+ * 고치고 지울 수 있는 복사본을 받아야 한다. */
+START_TEST(test_hangul_keyboard_bundle_unregister)
+{
+    const char* dir = "hangul-keyboards-test";
+    const HangulKeyboard* loaded;
+    HangulKeyboard* keyboard;
+
+    mkdir(dir, 0755);
+    ck_assert(copy_file(TEST_SOURCE_DIR "/shared/shared-a.xml",
+			"hangul-keyboards-test/shared-a.xml"));
+    ck_assert(hangul_keyboard_bundle_compile(dir,
+		"hangul-keyboards-test/hangul-keyboards.bin") == 1);
+
+    hangul_fini();
+    ck_assert(hangul_init(dir) == 0);
+
+    loaded = hangul_keyboard_list_get_keyboard("shared-a");
+    ck_assert(loaded != NULL);
+    keyboard = hangul_keyboard_list_unregister_keyboard("shared-a");
+    ck_assert(keyboard != NULL && keyboard != loaded);
+    ck_assert(hangul_keyboard_list_get_keyboard("shared-a") == NULL);
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+    hangul_keyboard_set_value(keyboard, 'a', 0x1107);
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+    ck_assert(hangul_keyboard_map_to_char(keyboard, 0, 'a') == 0x1107);
+    ck_assert(hangul_keyboard_map_to_char(keyboard, 0, 'r') == 0x1100);
+    ck_assert(hangul_keyboard_combine(keyboard, 0, 0x1100, 0x1100) == 0x1101);
     hangul_keyboard_delete(keyboard);
+
+    remove("hangul-keyboards-test/hangul-keyboards.bin");
+    remove("hangul-keyboards-test/shared-a.xml");
+    remove(dir);
+
+    /* main()에서 읽은 자판 목록으로 되돌린다 */
+    hangul_fini();
+    hangul_init(TEST_LIBHANGUL_KEYBOARD_PATH);
+}
+END_TEST
+
+/* shared 디렉토리의 두 자판은 id만 다르고 배열과 조합이 같으므로 테이블을
+ * 함께 쓴다. 한 자판을 바꾸거나 지워도 다른 자판은 그대로 남아야 한다. */
+START_TEST(test_hangul_keyboard_shared_tables)
+{
+    int i;
+
+    /* 0: a를 먼저 지운다, 1: b를 먼저 지운다, 2: b를 바꾸고 먼저 지운다 */
+    for (i = 0; i < 3; ++i) {
+	const HangulKeyboard* a;
+	const HangulKeyboard* b;
+	HangulKeyboard* first;
+	HangulKeyboard* second;
+
+	hangul_fini();
+	ck_assert(hangul_init(TEST_SOURCE_DIR "/shared") == 0);
+
+	a = hangul_keyboard_list_get_keyboard("shared-a");
+	b = hangul_keyboard_list_get_keyboard("shared-b");
+	ck_assert(a != NULL && b != NULL && a != b);
+	ck_assert(hangul_keyboard_get_table(a, 0) != NULL);
+	ck_assert(hangul_keyboard_get_table(a, 0) ==
+		  hangul_keyboard_get_table(b, 0));
+	ck_assert(hangul_keyboard_get_combination(a, 0) != NULL);
+	ck_assert(hangul_keyboard_get_combination(a, 0) ==
+		  hangul_keyboard_get_combination(b, 0));
+
+	first = hangul_keyboard_list_unregister_keyboard(i == 0 ? "shared-a" : "shared-b");
+	second = hangul_keyboard_list_unregister_keyboard(i == 0 ? "shared-b" : "shared-a");
+	ck_assert(first != NULL && second != NULL);
+
+	if (i == 2) {
+	    /* 공유 테이블은 복사한 후에 바꾼다 */
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+	    hangul_keyboard_set_value(first, 'a', 0x1107);
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+	    ck_assert(hangul_keyboard_get_table(first, 0) !=
+		      hangul_keyboard_get_table(second, 0));
+	    ck_assert(hangul_keyboard_map_to_char(first, 0, 'a') == 0x1107);
+	    ck_assert(hangul_keyboard_map_to_char(second, 0, 'a') == 0x1106);
+	}
+
+	hangul_keyboard_delete(first);
+	ck_assert(hangul_keyboard_map_to_char(second, 0, 'a') == 0x1106);
+	ck_assert(hangul_keyboard_map_to_char(second, 0, 'r') == 0x1100);
+	ck_assert(hangul_keyboard_combine(second, 0, 0x1100, 0x1100) == 0x1101);
+	hangul_keyboard_delete(second);
+    }
+
+    /* main()에서 읽은 자판 목록으로 되돌린다 */
+    hangul_fini();
+    hangul_init(TEST_LIBHANGUL_KEYBOARD_PATH);
+}
+END_TEST
+
+/* hangul_init_with_threads()는 쓰레드 수와 관계없이 hangul_init()과 같은
+ * 순서로 같은 자판을 등록해야 한다. */
+START_TEST(test_hangul_init_with_threads)
+{
+    const char* path = TEST_SOURCE_DIR "/shared:" TEST_SOURCE_DIR;
+    static const unsigned n_threads[] = { 0, 1, 4 };
+    char* ids[16];
+    ucschar values[16][26];
+    unsigned n, i, j, k;
+
+    hangul_fini();
+    ck_assert(hangul_init(path) == 0);
+
+    n = hangul_keyboard_list_get_count();
+    ck_assert(n <= countof(ids));
+    for (i = 0; i < n; ++i) {
+	const HangulKeyboard* keyboard;
+
+	ids[i] = strdup(hangul_keyboard_list_get_keyboard_id(i));
+	keyboard = hangul_keyboard_list_get_keyboard(ids[i]);
+	ck_assert(keyboard != NULL);
+	for (k = 0; k < 26; ++k)
+	    values[i][k] = hangul_keyboard_map_to_char(keyboard, 0, 'a' + k);
+    }
+    ck_assert(hangul_keyboard_list_get_keyboard("shared-a") != NULL);
+    ck_assert(hangul_keyboard_list_get_keyboard("recursive") != NULL);
+
+    for (j = 0; j < countof(n_threads); ++j) {
+	hangul_fini();
+	ck_assert(hangul_init_with_threads(path, n_threads[j]) == 0);
+
+	ck_assert(hangul_keyboard_list_get_count() == n);
+	for (i = 0; i < n; ++i) {
+	    const HangulKeyboard* keyboard;
+
+	    ck_assert(strcmp(hangul_keyboard_list_get_keyboard_id(i), ids[i]) == 0);
+	    keyboard = hangul_keyboard_list_get_keyboard(ids[i]);
+	    ck_assert(keyboard != NULL);
+	    for (k = 0; k < 26; ++k) {
+		ck_assert(hangul_keyboard_map_to_char(keyboard, 0, 'a' + k) ==
+			  values[i][k]);
+	    }
+	}
+    }
+
+    for (i = 0; i < n; ++i)
+	free(ids[i]);
+
+    /* main()에서 읽은 자판 목록으로 되돌린다 */
+    hangul_fini();
+    hangul_init(TEST_LIBHANGUL_KEYBOARD_PATH);
 }
 END_TEST
 #endif /* ENABLE_EXTERNAL_KEYBOARDS */
 
+START_TEST(test_hangul_jamos_to_syllables)
+{
+    ucschar syllables[256];
+    ucschar jamos[1024];
+    ucschar buf[1024];
+    int i, j, k, n, len;
+
+    /* 자모로 나눈 현대 한글 음절은 다시 원래 음절이 되어야 한다 */
+    srand(0);
+    for (i = 0; i < 200; i++) {
+	n = 0;
+	len = 0;
+	for (j = 0; j < 200; j++) {
+	    ucschar c, cho, jung, jong;
+	    if (rand() % 5 == 0) {
+		c = rand() % 2 ? ' ' : L'漢';
+		syllables[n++] = c;
+		jamos[len++] = c;
+		continue;
+	    }
+	    c = 0xac00 + rand() % 11172;
+	    hangul_syllable_to_jamo(c, &cho, &jung, &jong);
+	    syllables[n++] = c;
+	    jamos[len++] = cho;
+	    jamos[len++] = jung;
+	    if (jong != 0)
+		jamos[len++] = jong;
+	}
+	ck_assert(hangul_jamos_to_syllables(buf, countof(buf), jamos, len) == n);
+	ck_assert(memcmp(buf, syllables, n * sizeof(ucschar)) == 0);
+    }
+
+    /* 한번에 조합할 수 없는 자모가 어느 위치에 있더라도 한 음절씩
+     * 조합한 것과 같아야 한다. */
+    static const ucschar tails[][4] = {
+	{ 0x1100, 0x1161, 0x0300, 0 },	    /* 결합 문자는 음절에 붙는다 */
+	{ 0x1100, 0x1161, 0x11a8, 0x11ba }, /* 겹받침 */
+	{ 0x1100, 0x1100, 0x1161, 0 },	    /* 쌍자음 */
+	{ 0x1100, 0x1161, 0x11a7, 0 },	    /* 종성 채움 */
+	{ 0x1100, 0x1161, 0xac00, 0 },	    /* LV 뒤의 음절 */
+    };
+    static const ucschar expected[][4] = {
+	{ 0x1100, 0x1161, 0x0300, 0 },
+	{ 0xac03, 0, 0, 0 },
+	{ 0xae4c, 0, 0, 0 },
+	{ 0xac00, 0, 0, 0 },
+	{ 0xac00, 0xac00, 0, 0 },
+    };
+    for (i = 0; i < countof(tails); i++) {
+	for (k = 0; k < 40; k++) {
+	    len = 0;
+	    for (j = 0; j < k; j++) {
+		jamos[len++] = 0x1100;
+		jamos[len++] = 0x1161;
+	    }
+	    for (j = 0; j < 4 && tails[i][j] != 0; j++)
+		jamos[len++] = tails[i][j];
+	    for (j = 0; j < 40; j++)
+		jamos[len++] = ' ';
+
+	    n = hangul_jamos_to_syllables(buf, countof(buf), jamos, len);
+	    for (j = 0; j < k; j++)
+		ck_assert(buf[j] == 0xac00);
+	    for (j = 0; j < 4 && expected[i][j] != 0; j++)
+		ck_assert(buf[k + j] == expected[i][j]);
+	    ck_assert(n == k + j + 40);
+	}
+    }
+}
+END_TEST
+
+START_TEST(test_hangul_syllables_to_jamos)
+{
+    ucschar src[256];
+    ucschar jamos[1024];
+    ucschar buf[1024];
+    int i, j, k, n, len;
+
+    /* 한 음절씩 나눈 것과 같아야 하고, 다시 조합하면 원래 스트링이 된다 */
+    srand(0);
+    for (i = 0; i < 200; i++) {
+	n = rand() % countof(src);
+	len = 0;
+	for (j = 0; j < n; j++) {
+	    ucschar c, cho, jung, jong;
+	    if (rand() % 5 == 0) {
+		c = rand() % 2 ? ' ' : L'漢';
+		src[j] = c;
+		jamos[len++] = c;
+		continue;
+	    }
+	    c = 0xac00 + rand() % 11172;
+	    hangul_syllable_to_jamo(c, &cho, &jung, &jong);
+	    src[j] = c;
+	    jamos[len++] = cho;
+	    jamos[len++] = jung;
+	    if (jong != 0)
+		jamos[len++] = jong;
+	}
+	ck_assert(hangul_syllables_to_jamos(NULL, 0, src, n) == len);
+	ck_assert(hangul_syllables_to_jamos(buf, countof(buf), src, n) == len);
+	ck_assert(memcmp(buf, jamos, len * sizeof(ucschar)) == 0);
+	ck_assert(hangul_jamos_to_syllables(buf, countof(buf), jamos, len) == n);
+	ck_assert(memcmp(buf, src, n * sizeof(ucschar)) == 0);
+    }
+
+    /* 호환 자모 */
+    static const ucschar syllables[] = { 0xac00, 0xac01, 0xac03, 0xd7a3, 'a',
+					 0x1100, 0 };
+    static const ucschar cjamos[] = { 0x3131, 0x314f, 0x3131, 0x314f, 0x3131,
+				      0x3131, 0x314f, 0x3133, 0x314e, 0x3163,
+				      0x314e, 'a', 0x3131 };
+    n = hangul_syllables_to_cjamos(buf, countof(buf), syllables, -1);
+    ck_assert(n == countof(cjamos));
+    ck_assert(memcmp(buf, cjamos, n * sizeof(ucschar)) == 0);
+    ck_assert(hangul_syllables_to_cjamos(NULL, 0, syllables, -1) == n);
+
+    /* dest가 모자라면 음절 단위로 멈춘다 */
+    static const ucschar gag[] = { 0x1100, 0x1161, 0x11a8 };
+    for (k = 0; k < 40; k++) {
+	src[k] = 0xac01;
+    }
+    for (i = 0; i <= 40 * 3; i++) {
+	n = hangul_syllables_to_jamos(buf, i, src, 40);
+	ck_assert(n == i / 3 * 3);
+	for (j = 0; j < n; j++)
+	    ck_assert(buf[j] == gag[j % 3]);
+    }
+}
+END_TEST
+
+START_TEST(test_hangul_syllable_boundaries)
+{
+    static const ucschar chars[] = {
+	' ', 'a', 0x1100, 0x1112, 0x115f, 0x1160, 0x1161, 0x11a7, 0x11a8,
+	0x11c2, 0xa960, 0xd7b0, 0xd7cb, 0xac00, 0xac01, 0xd7a3, 0x0300,
+	0x302e, 0x3131, 0x4e00
+    };
+    ucschar str[200];
+    int offsets[201];
+    int expected[201];
+    const ucschar* p;
+    int i, j, k, n, len;
+
+    /* hangul_syllable_iterator_next()로 구한 것과 같아야 한다 */
+    srand(0);
+    for (i = 0; i < 1000; i++) {
+	len = rand() % countof(str);
+	for (j = 0; j < len; j++) {
+	    if (i % 2 == 0 && rand() % 4 != 0)
+		str[j] = 0xac00 + rand() % 11172;
+	    else
+		str[j] = chars[rand() % countof(chars)];
+	}
+
+	n = 0;
+	for (p = str; p < str + len; p = hangul_syllable_iterator_next(p, str + len))
+	    expected[n++] = p - str;
+
+	ck_assert(hangul_syllable_boundaries(NULL, 0, str, len) == n);
+	ck_assert(hangul_syllable_boundaries(offsets, countof(offsets),
+					     str, len) == n);
+	ck_assert(memcmp(offsets, expected, n * sizeof(int)) == 0);
+
+	/* 작은 버퍼로 나누어 구해도 같아야 한다 */
+	k = 0;
+	j = 0;
+	while (k < n) {
+	    int m = hangul_syllable_boundaries(offsets, 5, str + j, len - j);
+	    int l;
+	    ck_assert(m > 0);
+	    for (l = 0; l < m; l++)
+		ck_assert(offsets[l] + j == expected[k + l]);
+	    if (m < 5)
+		break;
+	    k += m - 1;
+	    j = expected[k];
+	}
+    }
+
+    /* 0으로 끝나는 스트링 */
+    static const ucschar jamos[] = { 0x1100, 0x1161, 0x11a8, 0xac00, ' ', 0 };
+    static const int jamos_offsets[] = { 0, 3, 4 };
+    n = hangul_syllable_boundaries(offsets, countof(offsets), jamos, -1);
+    ck_assert(n == countof(jamos_offsets));
+    ck_assert(memcmp(offsets, jamos_offsets, sizeof(jamos_offsets)) == 0);
+    ck_assert(hangul_syllable_boundaries(offsets, countof(offsets), jamos, 0) == 0);
+}
+END_TEST
+
+START_TEST(test_hangul_composer)
+{
+    static const ucschar chars[] = {
+	' ', 'a', 0x1100, 0x1101, 0x1102, 0x1109, 0x1112, 0x115f, 0x1160,
+	0x1161, 0x1169, 0x116e, 0x1175, 0x11a8, 0x11ab, 0x11af, 0x11b0,
+	0x11ba, 0x11c2, 0xa960, 0xd7b0, 0xd7cb, 0xac00, 0xac01, 0x302e,
+	0x3131
+    };
+    ucschar str[400];
+    ucschar expected[400];
+    ucschar out[400];
+    HangulComposer* composer;
+    int i, j, k, n, m, len;
+
+    /* 어떻게 나누어 주어도 한번에 조합한 것과 같아야 한다 */
+    composer = hangul_composer_new();
+    srand(0);
+    for (i = 0; i < 1000; i++) {
+	len = rand() % countof(str);
+	for (j = 0; j < len; j++)
+	    str[j] = chars[rand() % countof(chars)];
+
+	/* 조합 결과가 바뀌지 않는 종성이 길게 이어지는 경우 */
+	if (i % 10 == 0 && len > 100) {
+	    str[50] = 0x1102;
+	    str[51] = 0x1161;
+	    str[52] = 0x11ab;
+	    for (j = 53; j < 90; j++)
+		str[j] = 0x11b0;
+	}
+
+	m = hangul_jamos_to_syllables(expected, countof(expected), str, len);
+
+	n = 0;
+	j = 0;
+	while (j < len) {
+	    int chunk = rand() % 20 + 1;
+	    int nread;
+	    if (chunk > len - j)
+		chunk = len - j;
+	    n += hangul_composer_compose(composer, out + n, rand() % 4,
+					 str + j, chunk, &nread);
+	    j += nread;
+	}
+	while ((k = hangul_composer_flush(composer, out + n, 2)) > 0)
+	    n += k;
+
+	ck_assert(n == m);
+	ck_assert(memcmp(out, expected, n * sizeof(ucschar)) == 0);
+    }
+
+    /* 음절이 끝나지 않았으면 보관한다 */
+    static const ucschar jamos[] = { 0x1100, 0x1161, 0x11a8, 0x1102, 0x1161 };
+    hangul_composer_reset(composer);
+    n = hangul_composer_compose(composer, out, countof(out), jamos, 4, &k);
+    ck_assert(k == 4);
+    ck_assert(n == 1 && out[0] == 0xac01);
+    n = hangul_composer_compose(composer, out, countof(out), jamos + 4, 1, &k);
+    ck_assert(k == 1 && n == 0);
+    n = hangul_composer_flush(composer, out, countof(out));
+    ck_assert(n == 1 && out[0] == 0xb098);
+    ck_assert(hangul_composer_flush(composer, out, countof(out)) == 0);
+
+    /* reset하면 보관하던 것을 버린다 */
+    n = hangul_composer_compose(composer, out, countof(out), jamos, 2, NULL);
+    ck_assert(n == 0);
+    hangul_composer_reset(composer);
+    ck_assert(hangul_composer_flush(composer, out, countof(out)) == 0);
+
+    hangul_composer_delete(composer);
+}
+END_TEST
+
+static int
+sort_key_compare(const ucschar* a, int alen, const ucschar* b, int blen)
+{
+    char akey[64];
+    char bkey[64];
+    int akeylen = hangul_sort_key(akey, sizeof(akey), a, alen);
+    int bkeylen = hangul_sort_key(bkey, sizeof(bkey), b, blen);
+    int r = memcmp(akey, bkey, akeylen < bkeylen ? akeylen : bkeylen);
+    return r != 0 ? r : akeylen - bkeylen;
+}
+
+START_TEST(test_hangul_sort_key)
+{
+    ucschar c, cho, jung, jong;
+    ucschar jamos[3];
+    char key[64];
+    int len;
+
+    /* 현대 한글 음절은 코드 순서와 같고, 자모로 써도 같은 키가 된다 */
+    for (c = 0xac00; c < 0xd7a3; c++) {
+	ucschar next = c + 1;
+	ck_assert(sort_key_compare(&c, 1, &next, 1) < 0);
+
+	hangul_syllable_to_jamo(c, &cho, &jung, &jong);
+	jamos[0] = cho;
+	jamos[1] = jung;
+	jamos[2] = jong;
+	ck_assert(sort_key_compare(&c, 1, jamos, jong != 0 ? 3 : 2) == 0);
+    }
+
+    /* 가 < 가나 < 각 < 까 */
+    static const ucschar ga[] = { 0xac00 };
+    static const ucschar gana[] = { 0xac00, 0xb098 };
+    static const ucschar gak[] = { 0xac01 };
+    static const ucschar kka[] = { 0xae4c };
+    ck_assert(sort_key_compare(ga, 1, gana, 2) < 0);
+    ck_assert(sort_key_compare(gana, 2, gak, 1) < 0);
+    ck_assert(sort_key_compare(gak, 1, kka, 1) < 0);
+
+    /* 옛한글: ᄁ = ᄀᄀ, ᄁ < ᅚ(ㄱㄷ) < ᄂ < ᄓ(ㄴㄱ) < ᄃ */
+    static const ucschar gg[] = { 0x1100, 0x1100, 0x1161 };
+    static const ucschar old[][2] = {
+	{ 0x1101, 0x1161 }, { 0x115a, 0x1161 }, { 0x1102, 0x1161 },
+	{ 0x1113, 0x1161 }, { 0x1103, 0x1161 }
+    };
+    ck_assert(sort_key_compare(gg, 3, kka, 1) == 0);
+    for (len = 0; len + 1 < countof(old); len++)
+	ck_assert(sort_key_compare(old[len], 2, old[len + 1], 2) < 0);
+
+    /* 한글이 아닌 글자는 코드 순서로 U+AC00 앞이나 뒤에 온다 */
+    static const ucschar a[] = { 'a' };
+    static const ucschar hanja[] = { 0x4e00 };
+    static const ucschar cjk[] = { 0xf900 };
+    ck_assert(sort_key_compare(a, 1, hanja, 1) < 0);
+    ck_assert(sort_key_compare(hanja, 1, ga, 1) < 0);
+    ck_assert(sort_key_compare(kka, 1, cjk, 1) < 0);
+
+    /* dest가 NULL이면 길이만 구하고, 모자라면 앞부분만 쓴다 */
+    static const ucschar str[] = { 'a', 0xac00, 0x1100, 0x302e, 0 };
+    len = hangul_sort_key(key, sizeof(key), str, -1);
+    ck_assert(len > 0);
+    ck_assert(memchr(key, 0, len) == NULL);
+    ck_assert(hangul_sort_key(NULL, 0, str, -1) == len);
+    memset(key + 32, 'x', 5);
+    ck_assert(hangul_sort_key(key + 32, 5, str, 4) == len);
+    ck_assert(memcmp(key, key + 32, 5) == 0);
+}
+END_TEST
+
+START_TEST(test_hangul_syllables_to_choseongs)
+{
+    /* 사과, ㅅ과, 첫가끝 "가"와 방점, 한자 */
+    static const ucschar str[] = {
+	0xc0ac, 0xacfc, ' ', 0x3145, 0xacfc, ' ',
+	0x1100, 0x1161, 0x11a8, 0x302e, 0x4e00, 0
+    };
+    static const ucschar expected[] = {
+	0x3145, 0x3131, ' ', 0x3145, 0x3131, ' ', 0x3131, 0x4e00
+    };
+    ucschar buf[20];
+    char utf8[60];
+    int n;
+
+    n = hangul_syllables_to_choseongs(buf, countof(buf), str, -1);
+    ck_assert(n == countof(expected));
+    ck_assert(memcmp(buf, expected, sizeof(expected)) == 0);
+    ck_assert(hangul_syllables_to_choseongs(NULL, 0, str, -1) == n);
+    ck_assert(hangul_syllables_to_choseongs(buf, 3, str, -1) == 3);
+
+    n = hangul_syllables_to_choseongs_utf8(utf8, sizeof(utf8),
+					   "사과, ㅅ과, 시계", -1);
+    ck_assert(n == strlen("ㅅㄱ, ㅅㄱ, ㅅㄱ"));
+    ck_assert(memcmp(utf8, "ㅅㄱ, ㅅㄱ, ㅅㄱ", n) == 0);
+
+    /* 글자 중간에서 자르지 않는다 */
+    ck_assert(hangul_syllables_to_choseongs_utf8(utf8, 5, "사과", -1) == 3);
+}
+END_TEST
+
+START_TEST(test_hanja_table_match_choseong)
+{
+    const char* path = "hanja-choseong-test.txt";
+    static const char* const expected[] = {
+	"사과", "사기", "시계", "시계", "삼국사기"
+    };
+    HanjaTable* table;
+    HanjaList* list;
+    FILE* file;
+    int i;
+
+    file = fopen(path, "w");
+    ck_assert(file != NULL);
+    fputs("# 초성 검색\n"
+	  "사:事:일 사\n"
+	  "사과:沙果:사과\n"
+	  "사기:史記:역사\n"
+	  "삼국사기:三國史記:삼국사기\n"
+	  "시계:時計:시계\n"
+	  "시계:視界:시계\n"
+	  "한자:漢字:한자\n", file);
+    fclose(file);
+
+    table = hanja_table_load(path);
+    remove(path);
+    ck_assert(table != NULL);
+
+    /* 초성이 같으면 사전의 순서, 짧은 초성이 앞에 온다 */
+    list = hanja_table_match_choseong(table, "ㅅㄱ");
+    ck_assert(hanja_list_get_size(list) == countof(expected));
+    for (i = 0; i < countof(expected); i++)
+	ck_assert_str_eq(hanja_list_get_nth_key(list, i), expected[i]);
+    ck_assert_str_eq(hanja_list_get_nth_value(list, 3), "視界");
+    hanja_list_delete(list);
+
+    /* 음절이 섞인 검색어도 초성만 비교한다 */
+    list = hanja_table_match_choseong(table, "ㅅ과");
+    ck_assert(hanja_list_get_size(list) == countof(expected));
+    hanja_list_delete(list);
+
+    list = hanja_table_match_choseong(table, "ㅅㄱㅅ");
+    ck_assert(hanja_list_get_size(list) == 1);
+    ck_assert_str_eq(hanja_list_get_nth_value(list, 0), "三國史記");
+    hanja_list_delete(list);
+
+    list = hanja_table_match_choseong(table, "ㅎ");
+    ck_assert(hanja_list_get_size(list) == 1);
+    hanja_list_delete(list);
+
+    ck_assert(hanja_table_match_choseong(table, "ㄴ") == NULL);
+    ck_assert(hanja_table_match_choseong(table, "") == NULL);
+
+    hanja_table_delete(table);
+}
+END_TEST
+
+static int
+ucs_to_utf8(char* buf, const ucschar* str, int len)
+{
+    int i, n = 0;
+
+    for (i = 0; i < len; i++) {
+	ucschar c = str[i];
+	if (c < 0x80) {
+	    buf[n++] = c;
+	} else if (c < 0x800) {
+	    buf[n++] = 0xc0 | (c >> 6);
+	    buf[n++] = 0x80 | (c & 0x3f);
+	} else if (c < 0x10000) {
+	    buf[n++] = 0xe0 | (c >> 12);
+	    buf[n++] = 0x80 | ((c >> 6) & 0x3f);
+	    buf[n++] = 0x80 | (c & 0x3f);
+	} else {
+	    buf[n++] = 0xf0 | (c >> 18);
+	    buf[n++] = 0x80 | ((c >> 12) & 0x3f);
+	    buf[n++] = 0x80 | ((c >> 6) & 0x3f);
+	    buf[n++] = 0x80 | (c & 0x3f);
+	}
+    }
+
+    return n;
+}
+
+START_TEST(test_hangul_jamo_distance)
+{
+    /* 한국, 핸국, 한극, 한국어, 학교 */
+    static const ucschar words[][4] = {
+	{ 0xd55c, 0xad6d, 0 },
+	{ 0xd578, 0xad6d, 0 },
+	{ 0xd55c, 0xadf9, 0 },
+	{ 0xd55c, 0xad6d, 0xc5b4, 0 },
+	{ 0xd559, 0xad50, 0 },
+    };
+    /* 한, 핸, 하, 첫가끝 자모로 쓴 한국 */
+    static const ucschar han[] = { 0xd55c, 0 };
+    static const ucschar haen[] = { 0xd578, 0 };
+    static const ucschar ha[] = { 0xd558, 0 };
+    static const ucschar han_jamo[] = { 0x1112, 0x1161, 0x11ab, 0xad6d, 0 };
+    /* 이미 비교한 낱말과 앞부분이 같은 낱말을 다시 비교한다 */
+    static const int order[] = { 0, 3, 0, 2, 1, 4, 4, 3, 0 };
+    static const int expected[] = { 0, 1, 1, -1, -1 };
+    ucschar a[100], b[100];
+    char utf8[32];
+    HangulFuzzyMatcher* matcher;
+    int i;
+
+    ck_assert(hangul_jamo_distance(han, -1, haen, -1) == 1);
+    ck_assert(hangul_jamo_distance(han, -1, ha, -1) == 1);
+    ck_assert(hangul_jamo_distance(han, -1, han_jamo, 3) == 0);
+    ck_assert(hangul_jamo_distance(han, 0, han, -1) == 3);
+    ck_assert(hangul_jamo_distance(words[0], -1, words[4], -1) == 3);
+
+    /* 64 자모보다 긴 스트링 */
+    for (i = 0; i < 100; i++)
+	a[i] = b[i] = 0xd55c;
+    b[50] = 0xd578;
+    ck_assert(hangul_jamo_distance(a, 100, b, 100) == 1);
+    ck_assert(hangul_jamo_distance(a, 100, b, 99) == 4);
+    ck_assert(hangul_fuzzy_matcher_new(a, 22, 1) == NULL);
+
+    matcher = hangul_fuzzy_matcher_new(words[0], -1, 1);
+    ck_assert(matcher != NULL);
+    for (i = 0; i < countof(order); i++) {
+	int d = hangul_fuzzy_matcher_match(matcher, words[order[i]], -1);
+	ck_assert_int_eq(d, expected[order[i]]);
+    }
+    hangul_fuzzy_matcher_delete(matcher);
+
+    matcher = hangul_fuzzy_matcher_new_utf8("한국", -1, 2);
+    ck_assert(matcher != NULL);
+    ck_assert(hangul_fuzzy_matcher_match_utf8(matcher, "한국어", -1) == 2);
+    ck_assert(hangul_fuzzy_matcher_match_utf8(matcher, "한국", -1) == 0);
+    ck_assert(hangul_fuzzy_matcher_match_utf8(matcher, "핸국어", -1) == -1);
+    ck_assert(hangul_fuzzy_matcher_match_utf8(matcher, "호국", -1) == 2);
+    i = ucs_to_utf8(utf8, han_jamo, 4);
+    ck_assert(hangul_fuzzy_matcher_match_utf8(matcher, utf8, i) == 0);
+    hangul_fuzzy_matcher_delete(matcher);
+}
+END_TEST
+
+START_TEST(test_hanja_table_match_fuzzy)
+{
+    const char* path = "hanja-fuzzy-test.txt";
+    HanjaTable* table;
+    HanjaList* list;
+    FILE* file;
+
+    file = fopen(path, "w");
+    ck_assert(file != NULL);
+    fputs("# 근사 검색\n"
+	  "학교:學校:학교\n"
+	  "한:韓:나라 한\n"
+	  "한국:韓國:나라 이름\n"
+	  "한국:寒國:추운 나라\n"
+	  "한극:寒極:추운 곳\n"
+	  "호국:護國:나라를 지킴\n", file);
+    fclose(file);
+
+    table = hanja_table_load(path);
+    remove(path);
+    ck_assert(table != NULL);
+
+    list = hanja_table_match_fuzzy(table, "핸국", 1);
+    ck_assert(hanja_list_get_size(list) == 2);
+    ck_assert_str_eq(hanja_list_get_nth_key(list, 0), "한국");
+    ck_assert_str_eq(hanja_list_get_nth_value(list, 1), "寒國");
+    hanja_list_delete(list);
+
+    /* 거리가 가까운 것이 앞에 온다 */
+    list = hanja_table_match_fuzzy(table, "한극", 2);
+    ck_assert(hanja_list_get_size(list) == 3);
+    ck_assert_str_eq(hanja_list_get_nth_value(list, 0), "寒極");
+    ck_assert_str_eq(hanja_list_get_nth_value(list, 1), "韓國");
+    ck_assert_str_eq(hanja_list_get_nth_value(list, 2), "寒國");
+    hanja_list_delete(list);
+
+    list = hanja_table_match_fuzzy(table, "한국", 2);
+    ck_assert(hanja_list_get_size(list) == 4);
+    ck_assert_str_eq(hanja_list_get_nth_value(list, 3), "護國");
+    hanja_list_delete(list);
+
+    list = hanja_table_match_fuzzy(table, "한국", 0);
+    ck_assert(hanja_list_get_size(list) == 2);
+    hanja_list_delete(list);
+
+    ck_assert(hanja_table_match_fuzzy(table, "컴퓨터", 2) == NULL);
+    ck_assert(hanja_table_match_fuzzy(table, "", 2) == NULL);
+    ck_assert(hanja_table_match_fuzzy(table, "한국", -1) == NULL);
+
+    hanja_table_delete(table);
+}
+END_TEST
+
+START_TEST(test_hangul_jamos_to_syllables_utf8)
+{
+    static const ucschar chars[] = {
+	' ', 'a', 0x1100, 0x1101, 0x1112, 0x115f, 0x1160, 0x1161, 0x1175,
+	0x11a7, 0x11a8, 0x11c2, 0xa960, 0xd7b0, 0xd7cb, 0xac00, 0xac01,
+	0x0300, 0x302e, 0x3131, 0x4e00, 0x1f600
+    };
+    ucschar str[100];
+    ucschar syllables[100];
+    int offsets[101];
+    char src[400];
+    char expected[400];
+    char buf[400];
+    const ucschar* p;
+    const char* q;
+    int i, j, n, len, srclen;
+
+    /* UCS4 버전으로 변환한 것과 같아야 한다 */
+    srand(0);
+    for (i = 0; i < 1000; i++) {
+	len = rand() % countof(str);
+	for (j = 0; j < len; j++)
+	    str[j] = chars[rand() % countof(chars)];
+
+	srclen = 0;
+	for (j = 0; j < len; j++) {
+	    offsets[j] = srclen;
+	    srclen += ucs_to_utf8(src + srclen, str + j, 1);
+	}
+	offsets[len] = srclen;
+
+	n = hangul_jamos_to_syllables(syllables, countof(syllables), str, len);
+	n = ucs_to_utf8(expected, syllables, n);
+	ck_assert(hangul_jamos_to_syllables_utf8(buf, sizeof(buf),
+						 src, srclen) == n);
+	ck_assert(memcmp(buf, expected, n) == 0);
+
+	/* 음절 경계도 UCS4 버전과 같아야 한다 */
+	p = str;
+	q = src;
+	while (p < str + len) {
+	    ck_assert(q == src + offsets[p - str]);
+	    p = hangul_syllable_iterator_next(p, str + len);
+	    q = hangul_syllable_iterator_next_utf8(q, src + srclen);
+	}
+	ck_assert(q == src + srclen);
+
+	while (p > str) {
+	    p = hangul_syllable_iterator_prev(p, str);
+	    q = hangul_syllable_iterator_prev_utf8(q, src);
+	    ck_assert(q == src + offsets[p - str]);
+	}
+    }
+
+    /* 글자의 중간에서 자르지 않는다 */
+    static const ucschar jamos[] = { 'a', 0x1100, 0x1161, 0x11a8, 0 };
+    srclen = ucs_to_utf8(src, jamos, countof(jamos));
+    ck_assert(hangul_jamos_to_syllables_utf8(buf, 3, src, -1) == 1);
+    ck_assert(hangul_jamos_to_syllables_utf8(buf, 4, src, -1) == 4);
+    ck_assert(memcmp(buf, "a\xea\xb0\x81", 4) == 0);
+
+    /* 올바르지 않은 UTF-8은 그대로 복사한다 */
+    ck_assert(hangul_jamos_to_syllables_utf8(buf, sizeof(buf),
+					     "\xe1\x84\xff", -1) == 3);
+    ck_assert(memcmp(buf, "\xe1\x84\xff", 3) == 0);
+}
+END_TEST
+
+START_TEST(test_hangul_keyboard_map_keys)
+{
+    const HangulKeyboard* keyboard;
+    ucschar expected[64];
+    ucschar buf[64];
+    char src[64];
+    int i, n;
+
+    keyboard = hangul_keyboard_list_get_keyboard("2");
+    ck_assert(keyboard != NULL);
+
+    n = hangul_keyboard_map_keys(keyboard, 0, buf, countof(buf), "rkskek", -1);
+    ck_assert(n == 6);
+    ck_assert(buf[0] == 0x1100 && buf[1] == 0x1161 &&
+	      buf[2] == 0x1102 && buf[3] == 0x1161 &&
+	      buf[4] == 0x1103 && buf[5] == 0x1161);
+
+    n = hangul_keyboard_map_keys(keyboard, 0, buf, 3, "rkskek", -1);
+    ck_assert(n == 3);
+
+    /* 여러 키를 한번에 변환한 결과가 한 키씩 변환한 것과 같아야 한다.
+     * ASCII가 아닌 바이트는 그대로 복사한다. */
+    srand(0);
+    for (i = 0; i < countof(src); i++) {
+	src[i] = 1 + rand() % 255;
+    }
+    src[5] = (char)0xea;
+    src[20] = 'r';
+    for (i = 0; i < countof(src); i++) {
+	ck_assert(hangul_keyboard_map_keys(keyboard, 0,
+		    &expected[i], 1, &src[i], 1) == 1);
+    }
+    n = hangul_keyboard_map_keys(keyboard, 0, buf, countof(buf),
+				 src, countof(src));
+    ck_assert(n == countof(src));
+    ck_assert(memcmp(buf, expected, sizeof(expected)) == 0);
+    ck_assert(buf[5] == 0xea);
+    ck_assert(buf[20] == 0x1100);
+
+    /* 세벌식 자판은 바로 음절로 바꿀 수 있다 */
+    keyboard = hangul_keyboard_list_get_keyboard("3f");
+    ck_assert(keyboard != NULL);
+    n = hangul_keyboard_map_keys(keyboard, 0, expected, countof(expected),
+				 "kfs", -1);
+    n = hangul_jamos_to_syllables(buf, countof(buf), expected, n);
+    ck_assert(n == 1 && buf[0] == L'간');
+}
+END_TEST
+
 START_TEST(test_hangul_jamo_to_cjamo)
 {
     ck_assert(
@@ -593,6 +1875,91 @@ START_TEST(test_hangul_jamo_to_cjamo)
 }
 END_TEST
 
+START_TEST(test_hangul_ctype)
+{
+    ucschar c;
+
+    /* 글자 분류표는 유니코드 범위로 정의한 것과 같아야 한다 */
+    for (c = 0; c < 0x110000; c++) {
+	bool cho  = (c >= 0x1100 && c <= 0x115f) || (c >= 0xa960 && c <= 0xa97c);
+	bool jung = (c >= 0x1160 && c <= 0x11a7) || (c >= 0xd7b0 && c <= 0xd7c6);
+	bool jong = (c >= 0x11a8 && c <= 0x11ff) || (c >= 0xd7cb && c <= 0xd7fb);
+
+	ck_assert(hangul_is_choseong(c) == cho);
+	ck_assert(hangul_is_jungseong(c) == jung);
+	ck_assert(hangul_is_jongseong(c) == jong);
+	ck_assert(hangul_is_jamo(c) == (cho || jung || jong));
+	ck_assert(hangul_is_syllable(c) == (c >= 0xac00 && c <= 0xd7a3));
+	ck_assert(hangul_is_cjamo(c) == (c >= 0x3131 && c <= 0x318e));
+    }
+
+    ck_assert(!hangul_is_choseong(0x10000 + 0x1100));
+    ck_assert(!hangul_is_syllable(0x8000ac00));
+    ck_assert(!hangul_is_jamo(0xffffffff));
+}
+END_TEST
+
+START_TEST(test_hangul_jongseong_tables)
+{
+    ucschar c, jong, cho;
+    int npairs = 0;
+
+    /* 초성과 종성의 변환은 서로 역함수이다 */
+    for (c = 0; c < 0x110000; c++) {
+	ucschar j = hangul_choseong_to_jongseong(c);
+	ucschar l = hangul_jongseong_to_choseong(c);
+
+	if (j != 0) {
+	    ck_assert(hangul_is_choseong(c));
+	    ck_assert(hangul_is_jongseong(j));
+	    ck_assert(hangul_jongseong_to_choseong(j) == c);
+	    npairs++;
+	}
+
+	if (l != 0) {
+	    ck_assert(hangul_is_jongseong(c));
+	    ck_assert(hangul_choseong_to_jongseong(l) == c);
+	}
+
+	if (!hangul_is_jongseong(c)) {
+	    ck_assert(hangul_jongseong_get_diff(0, c) == 0);
+	    ck_assert(hangul_jongseong_get_diff(0x11a8, c) == 0);
+	}
+    }
+    ck_assert(npairs == 70);
+
+    /* 겹받침을 나누면 마지막 자음의 초성이 나온다 */
+    for (c = 0x11a8; c <= 0x11c2; c++) {
+	hangul_jongseong_decompose(c, &jong, &cho);
+	if (jong != 0) {
+	    ck_assert(hangul_jongseong_get_diff(jong, c) == cho);
+	} else {
+	    ck_assert(cho == hangul_jongseong_to_choseong(c));
+	}
+    }
+
+    ck_assert(hangul_choseong_to_jongseong(0x1104) == 0xd7cd);
+    ck_assert(hangul_choseong_to_jongseong(0xa964) == 0x11b0);
+    ck_assert(hangul_choseong_to_jongseong(0x1116) == 0);
+    ck_assert(hangul_jongseong_to_choseong(0xd7f9) == 0x110d);
+    ck_assert(hangul_jongseong_to_choseong(0x11ff) == 0x1114);
+    ck_assert(hangul_jongseong_to_choseong(0x11aa) == 0);
+
+    hangul_jongseong_decompose(0x11aa, &jong, &cho);
+    ck_assert(jong == 0x11a8 && cho == 0x1109);
+    hangul_jongseong_decompose(0x11b0, &jong, &cho);
+    ck_assert(jong == 0x11af && cho == 0x1100);
+    hangul_jongseong_decompose(0x11bc, &jong, &cho);
+    ck_assert(jong == 0 && cho == 0x110b);
+
+    ck_assert(hangul_jongseong_get_diff(0, 0x11b0) == 0xa964);
+    ck_assert(hangul_jongseong_get_diff(0x11af, 0x11b0) == 0x1100);
+    ck_assert(hangul_jongseong_get_diff(0x11af, 0x11d1) == 0xa96f);
+    ck_assert(hangul_jongseong_get_diff(0x11b1, 0xd7d8) == 0x1112);
+    ck_assert(hangul_jongseong_get_diff(0x11b0, 0x11b0) == 0);
+}
+END_TEST
+
 Suite* libhangul_suite()
 {
     Suite* s = suite_create("libhangul");
@@ -606,10 +1973,32 @@ Suite* libhangul_suite()
     tcase_add_test(hangul, test_hangul_ic_auto_reorder);
     tcase_add_test(hangul, test_hangul_ic_combi_on_double_stroke);
     tcase_add_test(hangul, test_hangul_ic_non_choseong_combi);
+    tcase_add_test(hangul, test_hangul_ic_compile);
+    tcase_add_test(hangul, test_hangul_ic_automaton_jaso);
+    tcase_add_test(hangul, test_hangul_romaja_to_syllables);
+    tcase_add_test(hangul, test_hangul_ic_pool);
+    tcase_add_test(hangul, test_hangul_ic_output_callbacks);
     tcase_add_test(hangul, test_syllable_iterator);
+    tcase_add_test(hangul, test_hangul_ctype);
+    tcase_add_test(hangul, test_hangul_jongseong_tables);
 #if ENABLE_EXTERNAL_KEYBOARDS
     tcase_add_test(hangul, test_hangul_keyboard);
+    tcase_add_test(hangul, test_hangul_keyboard_bundle);
+    tcase_add_test(hangul, test_hangul_keyboard_bundle_unregister);
+    tcase_add_test(hangul, test_hangul_keyboard_shared_tables);
+    tcase_add_test(hangul, test_hangul_init_with_threads);
 #endif /* ENABLE_EXTERNAL_KEYBOARDS */
+    tcase_add_test(hangul, test_hangul_jamos_to_syllables);
+    tcase_add_test(hangul, test_hangul_syllables_to_jamos);
+    tcase_add_test(hangul, test_hangul_syllable_boundaries);
+    tcase_add_test(hangul, test_hangul_composer);
+    tcase_add_test(hangul, test_hangul_sort_key);
+    tcase_add_test(hangul, test_hangul_syllables_to_choseongs);
+    tcase_add_test(hangul, test_hanja_table_match_choseong);
+    tcase_add_test(hangul, test_hangul_jamo_distance);
+    tcase_add_test(hangul, test_hanja_table_match_fuzzy);
+    tcase_add_test(hangul, test_hangul_jamos_to_syllables_utf8);
+    tcase_add_test(hangul, test_hangul_keyboard_map_keys);
     tcase_add_test(hangul, test_hangul_jamo_to_cjamo);
     suite_add_tcase(s, hangul);
 
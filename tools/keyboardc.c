@@ -0,0 +1,26 @@
+/* 키보드 디렉토리의 xml 파일들을 hangul_init()이 바로 읽을 수 있는
+ * 바이너리 번들 파일로 만든다.
+ *
+ *   hangul-keyboardc KEYBOARD_DIR KEYBOARD_DIR/hangul-keyboards.bin
+ */
+
+#include <stdio.h>
+
+#include "../hangul/hangul.h"
+
+int
+main(int argc, char *argv[])
+{
+    if (argc != 3) {
+	fprintf(stderr, "usage: %s KEYBOARD_DIR OUTPUT\n", argv[0]);
+	return 1;
+    }
+
+    int n = hangul_keyboard_bundle_compile(argv[1], argv[2]);
+    if (n < 0) {
+	fprintf(stderr, "%s: can't write %s\n", argv[0], argv[2]);
+	return 1;
+    }
+
+    return 0;
+}